@@ -0,0 +1,142 @@
+#include "benchmark/benchmark.h"
+
+#include "data/clientDataSource.h"
+#include "mockPlatform.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Tangram;
+
+MockPlatform platform;
+
+// GeoJSON FeatureCollection of points with the given ids
+std::string pointFeatures(const std::vector<size_t>& _ids, int _version) {
+    std::string json = R"({"type":"FeatureCollection","features":[)";
+
+    for (size_t i = 0; i < _ids.size(); i++) {
+        size_t id = _ids[i];
+        if (i > 0) { json += ','; }
+        json += R"({"type":"Feature","id":)" + std::to_string(id) +
+            R"(,"geometry":{"type":"Point","coordinates":[)" +
+            std::to_string(double(id % 3600) / 10. - 180.) + "," +
+            std::to_string(double(id % 1700) / 10. - 85.) +
+            R"(]},"properties":{"name":"feature )" + std::to_string(id) +
+            R"(","version":)" + std::to_string(_version) + "}}";
+    }
+    json += "]}";
+    return json;
+}
+
+struct ClientDataSourceFixture : public benchmark::Fixture {
+    std::shared_ptr<ClientDataSource> source;
+    std::vector<size_t> updateIds;
+    std::string updates;
+    std::string removed;
+
+    void SetUp(const ::benchmark::State& state) override {
+        size_t numFeatures = state.range(0);
+        size_t numUpdates = state.range(1);
+
+        source = std::make_shared<ClientDataSource>(platform, "overlay", "");
+        source->setCanUpdateFeatures(true);
+
+        // Feature ids must be non-zero to be updatable
+        std::vector<size_t> ids(numFeatures);
+        for (size_t i = 0; i < numFeatures; i++) { ids[i] = i + 1; }
+        source->addData(pointFeatures(ids, 0));
+
+        std::mt19937 rng(0);
+        std::shuffle(ids.begin(), ids.end(), rng);
+        updateIds.assign(ids.begin(), ids.begin() + numUpdates);
+
+        updates = pointFeatures(updateIds, 1);
+        removed = pointFeatures(updateIds, 0);
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        source.reset();
+    }
+};
+
+BENCHMARK_DEFINE_F(ClientDataSourceFixture, UpdateFeaturesBench)(benchmark::State& st) {
+    while (st.KeepRunning()) {
+        source->appendOrUpdateFeatures(updates);
+    }
+    st.SetItemsProcessed(st.iterations() * updateIds.size());
+}
+
+BENCHMARK_DEFINE_F(ClientDataSourceFixture, RemoveFeaturesBench)(benchmark::State& st) {
+    while (st.KeepRunning()) {
+        source->removeFeatures(updateIds.data(), updateIds.size());
+
+        // Restore the removed features for the next iteration
+        st.PauseTiming();
+        source->appendOrUpdateFeatures(removed);
+        st.ResumeTiming();
+    }
+    st.SetItemsProcessed(st.iterations() * updateIds.size());
+}
+
+// Args: features in the overlay, features updated or removed per iteration
+BENCHMARK_REGISTER_F(ClientDataSourceFixture, UpdateFeaturesBench)
+    ->Args({20000, 5000})->Args({200000, 5000});
+BENCHMARK_REGISTER_F(ClientDataSourceFixture, RemoveFeaturesBench)
+    ->Args({20000, 5000})->Args({200000, 5000});
+
+// Load a layer of points from GeoJSON text, from columns or from chunks of text
+void ClientDataSourceIngestBench(benchmark::State& st) {
+    size_t numFeatures = st.range(0);
+    bool columns = st.range(1) == 1;
+    bool chunks = st.range(1) == 2;
+    const size_t chunkSize = 64 * 1024;
+
+    std::vector<size_t> ids(numFeatures);
+    for (size_t i = 0; i < numFeatures; i++) { ids[i] = i + 1; }
+    std::string json = pointFeatures(ids, 0);
+
+    while (st.KeepRunning()) {
+        st.PauseTiming();
+        auto source = std::make_shared<ClientDataSource>(platform, "overlay", "");
+        st.ResumeTiming();
+
+        if (columns) {
+            // Building the columns is part of the work the text path
+            // does in the parser.
+            ClientDataSource::FeatureColumns points;
+            std::vector<std::string> names;
+            std::vector<double> versions;
+            points.coordinates.reserve(2 * numFeatures);
+            names.reserve(numFeatures);
+            for (size_t id : ids) {
+                points.coordinates.push_back(double(id % 3600) / 10. - 180.);
+                points.coordinates.push_back(double(id % 1700) / 10. - 85.);
+                names.push_back("feature " + std::to_string(id));
+                versions.push_back(0);
+            }
+            points.addColumn("name", std::move(names));
+            points.addColumn("version", std::move(versions));
+
+            source->addFeatures(std::move(points));
+        } else if (chunks) {
+            source->beginData();
+            for (size_t pos = 0; pos < json.size(); pos += chunkSize) {
+                source->addDataChunk(json.data() + pos, std::min(chunkSize, json.size() - pos));
+            }
+            source->endData();
+        } else {
+            source->addData(json);
+        }
+
+        st.PauseTiming();
+        source.reset();
+        st.ResumeTiming();
+    }
+    st.SetItemsProcessed(st.iterations() * numFeatures);
+}
+// Args: features, 0 - GeoJSON text, 1 - columns, 2 - GeoJSON chunks
+BENCHMARK(ClientDataSourceIngestBench)->Args({500000, 0})->Args({500000, 1})->Args({500000, 2});
+
+BENCHMARK_MAIN();
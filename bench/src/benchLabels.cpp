@@ -0,0 +1,194 @@
+#include "benchmark/benchmark.h"
+
+#include "data/tileSource.h"
+#include "gl.h"
+#include "labels/labelManager.h"
+#include "log.h"
+#include "map.h"
+#include "marker/marker.h"
+#include "mockPlatform.h"
+#include "scene/scene.h"
+#include "style/style.h"
+#include "tile/tile.h"
+#include "tile/tileBuilder.h"
+#include "tile/tileManager.h"
+#include "tile/tileTask.h"
+#include "util/mapProjection.h"
+#include "view/view.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace Tangram;
+
+const char scene_file[] = "res/scene.yaml";
+const char tile_file[] = "res/tile.mvt";
+
+// Count heap allocations made while placing labels
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t _size) {
+    allocations++;
+    if (void* ptr = std::malloc(_size)) { return ptr; }
+    throw std::bad_alloc();
+}
+void operator delete(void* _ptr) noexcept { std::free(_ptr); }
+void operator delete(void* _ptr, size_t) noexcept { std::free(_ptr); }
+
+std::shared_ptr<Scene> scene;
+std::shared_ptr<TileSource> source;
+std::shared_ptr<TileData> tileData;
+MockPlatform platform;
+
+// The recorded tile is placed at its own position and repeated on the
+// neighbouring tiles to fill the viewport.
+const TileID tile_id{301, 384, 10};
+
+// Camera path relative to the center of the recorded tile:
+// offset in tiles, zoom and rotation. Frames are interpolated linearly
+// between keyframes.
+struct CameraKeyframe {
+    float x, y, zoom, rotation;
+};
+const CameraKeyframe camera_path[] = {
+    {  0.0f,  0.0f, 10.0f, 0.0f },
+    {  0.5f,  0.0f, 10.0f, 0.0f },  // pan
+    {  0.5f,  0.5f, 10.0f, 0.0f },
+    {  0.5f,  0.5f, 10.8f, 0.0f },  // zoom in
+    {  0.0f,  0.0f, 10.8f, 0.0f },
+    {  0.0f,  0.0f, 10.8f, 0.6f },  // rotate
+    {  0.0f,  0.0f, 10.0f, 0.0f },  // zoom out
+};
+const int frames_per_keyframe = 30;
+const int num_keyframes = sizeof(camera_path) / sizeof(camera_path[0]);
+const float frame_time = 1.f / 60.f;
+
+void globalSetup() {
+    static std::atomic<bool> initialized{false};
+    if (initialized.exchange(true)) { return; }
+
+    SceneOptions sceneOptions{platform.resolveUrl(Url(scene_file))};
+    sceneOptions.numTileWorkers = 0;
+    sceneOptions.prefetchTiles = false;
+
+    scene = std::make_shared<Scene>(platform, std::move(sceneOptions));
+    if (!scene->load()) { exit(-1); }
+
+    for (auto& s : scene->tileSources()) {
+        source = s;
+        if (source->generateGeometry()) { break; }
+    }
+
+    auto task = source->createTask(tile_id);
+    auto& t = dynamic_cast<BinaryTileTask&>(*task);
+
+    auto rawTileData = MockPlatform::getBytesFromFile(tile_file);
+    t.rawTileData = ByteBuffer(std::move(rawTileData));
+    tileData = source->parse(*task);
+    if (!tileData) {
+        LOGE("Invalid tile file '%s'", tile_file);
+        exit(-1);
+    }
+}
+
+struct NoopTileTaskQueue : public TileTaskQueue {
+    void enqueue(std::shared_ptr<TileTask> _task) override {}
+};
+
+class LabelPlacementFixture : public benchmark::Fixture {
+public:
+    View view{1920, 1080};
+    NoopTileTaskQueue taskQueue;
+    std::unique_ptr<TileManager> tileManager;
+    std::unique_ptr<LabelManager> labelManager;
+    std::vector<std::shared_ptr<Tile>> tiles;
+    std::vector<std::unique_ptr<Marker>> markers;
+    int frame = 0;
+
+    void SetUp(const ::benchmark::State& state) override {
+        globalSetup();
+
+        TileBuilder tileBuilder(*scene, new StyleContext());
+        tileBuilder.init();
+
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                TileID id{tile_id.x + x, tile_id.y + y, tile_id.z};
+                tiles.push_back(tileBuilder.build(id, *tileData, *source));
+            }
+        }
+
+        tileManager = std::make_unique<TileManager>(platform, taskQueue);
+        labelManager = std::make_unique<LabelManager>();
+        labelManager->setIncrementalPlacement(state.range(0) != 0);
+
+        view.setConstrainToWorldBounds(false);
+        frame = 0;
+    }
+
+    void TearDown(const ::benchmark::State& state) override {
+        labelManager.reset();
+        tileManager.reset();
+        tiles.clear();
+    }
+
+    void updateCamera() {
+        int numFrames = (num_keyframes - 1) * frames_per_keyframe;
+        int f = frame++ % numFrames;
+
+        auto& k0 = camera_path[f / frames_per_keyframe];
+        auto& k1 = camera_path[f / frames_per_keyframe + 1];
+        float t = float(f % frames_per_keyframe) / frames_per_keyframe;
+
+        double tileMeters = MapProjection::metersPerTileAtZoom(tile_id.z);
+        auto center = MapProjection::tileCenter(tile_id);
+
+        view.setPosition(center.x + tileMeters * (k0.x + (k1.x - k0.x) * t),
+                         center.y - tileMeters * (k0.y + (k1.y - k0.y) * t));
+        view.setZoom(k0.zoom + (k1.zoom - k0.zoom) * t);
+        view.setRoll(k0.rotation + (k1.rotation - k0.rotation) * t);
+        view.update();
+
+        for (auto& style : scene->styles()) { style->onBeginUpdate(); }
+        for (auto& tile : tiles) { tile->update(frame_time, view); }
+    }
+};
+
+BENCHMARK_DEFINE_F(LabelPlacementFixture, LabelPlacementBench)(benchmark::State& st) {
+
+    size_t numFrames = 0;
+    size_t numLabels = 0;
+    size_t numCollisionTests = 0;
+    size_t numAllocations = 0;
+
+    while (st.KeepRunning()) {
+        updateCamera();
+
+        size_t allocationsStart = allocations;
+        auto start = std::chrono::high_resolution_clock::now();
+
+        labelManager->updateLabelSet(view.state(), frame_time, *scene, tiles, markers, *tileManager);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        numAllocations += allocations - allocationsStart;
+
+        st.SetIterationTime(std::chrono::duration<double>(end - start).count());
+
+        numFrames++;
+        numLabels += labelManager->stats().labels;
+        numCollisionTests += labelManager->stats().collisionTests;
+    }
+
+    if (numFrames > 0) {
+        st.counters["labels"] = double(numLabels) / numFrames;
+        st.counters["collision_tests"] = double(numCollisionTests) / numFrames;
+        st.counters["allocations"] = double(numAllocations) / numFrames;
+    }
+}
+// Arg: 0 - full placement per frame, 1 - incremental placement
+BENCHMARK_REGISTER_F(LabelPlacementFixture, LabelPlacementBench)->Arg(0)->Arg(1)->UseManualTime();
+
+BENCHMARK_MAIN();
@@ -54,7 +54,7 @@ void globalSetup() {
     auto& t = dynamic_cast<BinaryTileTask&>(*task);
 
     auto rawTileData = MockPlatform::getBytesFromFile(tile_file);
-    t.rawTileData = std::make_shared<std::vector<char>>(rawTileData);
+    t.rawTileData = ByteBuffer(std::move(rawTileData));
     tileData = source->parse(*task);
     if (!tileData) {
         LOGE("Invalid tile file '%s'", tile_file);
@@ -0,0 +1,45 @@
+#include "benchmark/benchmark.h"
+
+#include "util/zlibHelper.h"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace Tangram;
+
+const char tile_file[] = "res/tile.mvt.gz";
+
+class InflateFixture : public benchmark::Fixture {
+public:
+    std::vector<char> compressed;
+    std::vector<char> inflated;
+
+    void SetUp(const ::benchmark::State& state) override {
+        std::ifstream file(tile_file, std::ios::binary);
+        compressed.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (compressed.empty()) { exit(-1); }
+    }
+
+    __attribute__ ((noinline))
+    void run(zlib::Backend _backend) {
+        inflated.clear();
+        if (zlib::inflate(_backend, compressed.data(), compressed.size(), inflated) != 0) {
+            exit(-1);
+        }
+    }
+};
+
+BENCHMARK_DEFINE_F(InflateFixture, Zlib)(benchmark::State& st) {
+    while (st.KeepRunning()) { run(zlib::Backend::zlib); }
+    st.SetBytesProcessed(st.iterations() * inflated.size());
+}
+BENCHMARK_REGISTER_F(InflateFixture, Zlib);
+
+BENCHMARK_DEFINE_F(InflateFixture, Miniz)(benchmark::State& st) {
+    while (st.KeepRunning()) { run(zlib::Backend::miniz); }
+    st.SetBytesProcessed(st.iterations() * inflated.size());
+}
+BENCHMARK_REGISTER_F(InflateFixture, Miniz);
+
+BENCHMARK_MAIN();
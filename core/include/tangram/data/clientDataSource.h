@@ -4,6 +4,10 @@
 #include "util/types.h"
 
 #include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Tangram {
 
@@ -42,6 +46,42 @@ public:
         std::unique_ptr<PolygonBuilderData> data;
     };
 
+    // Feature data in columns for addFeatures(). The coordinates of all
+    // features are stored in one array. Offset arrays have one entry more
+    // than the elements they index, the last entry is the end of the last
+    // element.
+    struct FeatureColumns {
+        enum class Type { points, lines, polygons };
+        Type type = Type::points;
+
+        // Longitude and latitude pairs
+        std::vector<double> coordinates;
+        // Lines and polygons: first point of each line or ring
+        std::vector<uint32_t> ringOffsets;
+        // Polygons: first ring of each polygon
+        std::vector<uint32_t> polygonOffsets;
+        // First point, line or polygon of each feature. When empty, each
+        // feature has one point, line or polygon.
+        std::vector<uint32_t> featureOffsets;
+        // Feature ids, required when features can be updated
+        std::vector<uint64_t> ids;
+
+        struct Column {
+            std::string key;
+            std::vector<double> numbers;
+            std::vector<std::string> strings;
+        };
+        std::vector<Column> columns;
+
+        // Add a property column with one value per feature. NaN values are
+        // not added to the feature properties.
+        void addColumn(std::string _key, std::vector<double> _values);
+        void addColumn(std::string _key, std::vector<std::string> _values);
+
+        // Number of features
+        size_t size() const;
+    };
+
     // http://www.iana.org/assignments/media-types/application/geo+json
     const char* mimeType() const override { return "application/geo+json"; };
 
@@ -49,6 +89,15 @@ public:
     size_t addData(const std::string& _data);
     size_t addData(const char* _data, size_t length);
 
+    // Add a GeoJSON document in chunks as it arrives. The features of a
+    // FeatureCollection are added as soon as their chunk is complete; a
+    // single Feature or geometry is added as a whole once it is complete.
+    // Documents whose root is not an object are rejected. Return the number
+    // of added features.
+    void beginData();
+    size_t addDataChunk(const char* _data, size_t _length);
+    size_t endData();
+
     void addPointFeature(Properties&& properties, LngLat coordinates);
 
     void addPolylineFeature(Properties&& properties, PolylineBuilder&& polyline);
@@ -56,12 +105,23 @@ public:
     void addPolygonFeature(Properties&& properties, PolygonBuilder
         && polygon);
 
+    // Add all features of _columns at once. Returns the number of added features.
+    size_t addFeatures(FeatureColumns&& _columns);
+
     // Remove all feature data.
     void clearFeatures();
 
     // Transform added feature data into tiles.
     void generateTiles();
 
+    void clearData() override;
+
+    using TileSource::generation;
+
+    // Only tiles that overlap features changed since the last
+    // generateTiles() have a newer generation.
+    int64_t generation(const TileID& _tileId) const override;
+
     void loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) override;
     std::shared_ptr<TileTask> createTask(TileID _tileId) override;
 
@@ -79,7 +139,20 @@ protected:
     struct Storage;
     std::unique_ptr<Storage> m_store;
 
-    mutable std::mutex m_mutexStore;
+    struct ChunkParser;
+    std::unique_ptr<ChunkParser> m_chunkParser;
+
+    mutable std::shared_timed_mutex m_mutexStore;
+
+    // Generation of the last change per partition of the tile pyramid,
+    // see generation(TileID). Guarded by m_mutexGeneration so that the
+    // TileManager does not wait for tiles being built under m_mutexStore.
+    std::unordered_map<uint64_t, int64_t> m_partitionGeneration;
+    int64_t m_overviewGeneration = 0;
+    int64_t m_quadrantGeneration[4] = { 0, 0, 0, 0 };
+    int64_t m_fullGeneration = 0;
+    mutable std::mutex m_mutexGeneration;
+
     bool m_hasPendingData = false;
     bool m_generateCentroids = false;
     bool m_canUpdateFeatures = false;
@@ -61,6 +61,11 @@ public:
             if (next) { next->cancelLoadingTile(_task); }
         }
 
+        /* Called when the priority or proxy state of a loading @_task changed */
+        virtual void updateTilePriority(TileTask& _task) {
+            if (next) { next->updateTilePriority(_task); }
+        }
+
         virtual void clear() { if (next) next->clear(); }
 
         void setNext(std::unique_ptr<DataSource> _next) {
@@ -103,6 +108,9 @@ public:
     /* Stops any running I/O tasks pertaining to @_task */
     virtual void cancelLoadingTile(TileTask& _task);
 
+    /* Passes changes of the priority of a loading @_task on to its I/O tasks */
+    virtual void updateTilePriority(TileTask& _task);
+
     /* Parse a <TileTask> with data into a <TileData>, returning an empty TileData on failure */
     virtual std::shared_ptr<TileData> parse(const TileTask& _task) const;
 
@@ -119,6 +127,10 @@ public:
     /* Generation ID of TileSource state (incremented for each update, e.g. on clearData()) */
     int64_t generation() const { return m_generation; }
 
+    /* Generation at which the data for @_tileId changed last. Tiles built from
+     * an older generation need to be reloaded. */
+    virtual int64_t generation(const TileID& _tileId) const { return m_generation; }
+
     const ZoomOptions& zoomOptions() { return m_zoomOptions; }
     int32_t minDisplayZoom() const { return m_zoomOptions.minDisplayZoom; }
     int32_t maxDisplayZoom() const { return m_zoomOptions.maxDisplayZoom; }
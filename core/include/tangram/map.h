@@ -449,6 +449,11 @@ public:
     // Set the radius in logical pixels to use when picking features on the map (default is 0.5).
     void setPickRadius(float _radius);
 
+    // Set the time in milliseconds that uploading tile geometry to the GPU should take per frame
+    // (default is 4). Fewer tiles are uploaded per frame when uploads take longer, the remaining
+    // tiles are uploaded in the following frames.
+    void setMeshUploadTime(float _milliseconds);
+
     // Create a query to select a feature marked as 'interactive'. The query runs on the next frame.
     // Calls _onFeaturePickCallback once the query has completed, and returns the FeaturePickResult
     // with its associated properties or null if no feature was found.
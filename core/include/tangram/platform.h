@@ -15,6 +15,11 @@ namespace Tangram {
 // This is the handle which Platform uses to identify an UrlRequest.
 using UrlRequestHandle = uint64_t;
 
+// Priority of URL requests: Requests with lower values are started first.
+// Requests with a priority of at least url_priority_background only prefetch
+// data and may be interrupted in favor of more urgent requests.
+constexpr double url_priority_background = 1.0;
+
 // Result of a URL request. If the request could not be completed or if the
 // host returned an HTTP status code >= 400, a non-null error string will be
 // present. This error string is only valid in the scope of the UrlCallback
@@ -23,6 +28,10 @@ using UrlRequestHandle = uint64_t;
 struct UrlResponse {
     std::vector<char> content;
     const char* error = nullptr;
+    // HTTP status code when the platform reports it, otherwise 0.
+    int status = 0;
+    // True when the request was aborted because the host did not respond in time.
+    bool timedOut = false;
 };
 
 // Function type for receiving data from a URL request.
@@ -78,12 +87,18 @@ public:
     // Start retrieving data from a URL asynchronously. When the request is
     // finished, the callback _callback will be run with the data or error that
     // was retrieved from the URL _url. The callback may run on a different
-    // thread than the original call to startUrlRequest.
-    UrlRequestHandle startUrlRequest(Url _url, UrlCallback&& _callback);
+    // thread than the original call to startUrlRequest. Implementations may
+    // use _priority to order requests, see url_priority_background.
+    UrlRequestHandle startUrlRequest(Url _url, UrlCallback&& _callback, double _priority = 0);
+
+    // Change the priority of a URL request that is waiting or in progress.
+    void setUrlRequestPriority(UrlRequestHandle _request, double _priority);
 
     // Stop retrieving data from a URL that was previously requested. When a
     // request is canceled its callback will still be run, but the response
     // will have an error string and the data may not be complete.
+    // Requests for a URL that is already being retrieved share the transfer,
+    // which is only stopped when all of its requests are canceled.
     void cancelUrlRequest(UrlRequestHandle _request);
 
     virtual FontSourceHandle systemFont(const std::string& _name, const std::string& _weight, const std::string& _face) const;
@@ -105,6 +120,13 @@ protected:
     // Return true when UrlRequestId has been set (i.e. when request is async and can be canceled)
     virtual bool startUrlRequestImpl(const Url& _url, UrlRequestHandle _request, UrlRequestId& _id) = 0;
 
+    // Implementations that order requests should override this to apply
+    // priority changes. Ignored by default.
+    virtual void setUrlRequestPriorityImpl(UrlRequestId _id, double _priority) {}
+
+    // Priority of the transfer _request, for use in startUrlRequestImpl
+    double urlRequestPriority(UrlRequestHandle _request);
+
     static bool bytesFromFileSystem(const char* _path, std::function<char*(size_t)> _allocator);
 
     std::atomic<bool> m_shutdown{false};
@@ -114,10 +136,28 @@ protected:
     std::mutex m_callbackMutex;
     struct UrlRequestEntry {
         UrlCallback callback;
+        // Handle of the transfer this request waits for
+        UrlRequestHandle transfer;
+        double priority;
+        bool canceled;
+    };
+    std::unordered_map<UrlRequestHandle, UrlRequestEntry> m_urlCallbacks;
+
+    // Platform request that retrieves a URL for one or more UrlRequests.
+    // The platform implementation knows only transfer handles.
+    struct UrlTransfer {
+        std::string url;
         UrlRequestId id;
         bool cancelable;
+        double priority;
+        std::vector<UrlRequestHandle> requests;
     };
-    std::unordered_map<UrlRequestHandle, UrlRequestEntry> m_urlCallbacks;
+    std::unordered_map<UrlRequestHandle, UrlTransfer> m_urlTransfers;
+    // Transfers in flight that new requests can share
+    std::unordered_map<std::string, UrlRequestHandle> m_urlTransferByUrl;
+
+    // Whether any request of _transfer was not canceled, requires m_callbackMutex
+    bool hasPendingRequests(const UrlTransfer& _transfer) const;
     std::atomic_uint_fast64_t m_urlRequestCount = {0};
 };
 
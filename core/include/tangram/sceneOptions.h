@@ -59,6 +59,12 @@ public:
 
     /// 16MB default in-memory DataSource cache
     size_t memoryTileCacheSize = DEFAULT_CACHE_SIZE;
+
+    /// Keep label placements while panning and only place labels that changed
+    bool incrementalLabelPlacement = false;
+
+    /// Resolve label collisions on a helper thread instead of the render thread
+    bool asyncLabelPlacement = false;
 };
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "tile/tileID.h"
+#include "util/byteBuffer.h"
 #include "platform.h" // UrlRequestHandle
 
 #include <atomic>
@@ -115,15 +116,16 @@ public:
         : TileTask(_tileId, _source) {}
 
     virtual bool hasData() const override {
-        return rawTileData && !rawTileData->empty();
+        return !rawTileData.empty();
     }
     // Raw tile data that will be processed by TileSource.
-    std::shared_ptr<std::vector<char>> rawTileData;
+    ByteBuffer rawTileData;
 
     bool dataFromCache = false;
     bool urlRequestStarted = false;
 
     UrlRequestHandle urlRequestHandle = 0;
+    double urlRequestPriority = 0;
 };
 
 struct TileTaskQueue {
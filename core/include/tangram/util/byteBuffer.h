@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Tangram {
+
+// Immutable, reference counted bytes. Copies of a ByteBuffer share the same
+// memory, which is either a vector the buffer took over or memory kept
+// alive by an owner, e.g. a mapped file.
+class ByteBuffer {
+
+public:
+
+    ByteBuffer() {}
+
+    // Take over _bytes without copying
+    explicit ByteBuffer(std::vector<char>&& _bytes) {
+        auto bytes = std::make_shared<const std::vector<char>>(std::move(_bytes));
+        m_data = bytes->data();
+        m_size = bytes->size();
+        m_owner = std::move(bytes);
+    }
+
+    // View _size bytes at _data that remain valid while _owner is alive
+    ByteBuffer(const char* _data, size_t _size, std::shared_ptr<const void> _owner)
+        : m_data(_data), m_size(_size), m_owner(std::move(_owner)) {}
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+    void reset() { *this = ByteBuffer(); }
+
+private:
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    std::shared_ptr<const void> m_owner;
+};
+
+}
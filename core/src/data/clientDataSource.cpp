@@ -4,9 +4,11 @@
 #include "platform.h"
 #include "tile/tileTask.h"
 #include "util/geom.h"
+#include "data/featureStore.h"
 #include "data/propertyItem.h"
 #include "data/tileData.h"
 #include "tile/tile.h"
+#include "util/mapProjection.h"
 #include "view/view.h"
 
 #include "mapbox/geojsonvt.hpp"
@@ -16,7 +18,15 @@
 #include <mapbox/geojson_impl.hpp>
 
 
+#include "glm/common.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <list>
 #include <regex>
+#include <unordered_map>
 
 namespace Tangram {
 
@@ -34,10 +44,119 @@ geojsonvt::Options options() {
     return opt;
 }
 
-struct ClientDataSource::Storage {
+// Features are tiled separately for each tile of this zoom level, so that
+// a change only requires re-tiling the partitions that the changed features
+// overlap. Tiles below this zoom are cut from an overview of all features.
+static const int partition_zoom = 10;
+
+// Changes that overlap more partitions than this invalidate all tiles
+static const int max_changed_partitions = 64;
+
+// Partition indices kept by Storage::getTile(), least recently used are
+// dropped first
+static const size_t max_cached_partitions = 128;
+
+// Minimum number of removed slots to reclaim
+static const size_t min_compact_slots = 1024;
+
+// Range of partitions overlapped by a feature
+struct PartitionBounds {
+    int32_t minX = 1, minY = 1, maxX = 0, maxY = 0;
+
+    bool empty() const { return minX > maxX || minY > maxY; }
+    int64_t count() const { return empty() ? 0 : int64_t(maxX - minX + 1) * (maxY - minY + 1); }
+};
+
+static uint64_t partitionKey(int32_t _x, int32_t _y) {
+    return (uint64_t(uint32_t(_x)) << 32) | uint32_t(_y);
+}
+
+static int quadrantIndex(int32_t _x, int32_t _y, int32_t _z) {
+    return ((_y >> (_z - 1)) << 1) | (_x >> (_z - 1));
+}
+
+// Tile index of a part of the world. Tile workers may cut tiles from
+// different partitions at the same time; the mutex guards the index,
+// which geojson-vt extends while cutting tiles.
+struct Partition {
+    std::mutex mutex;
     std::unique_ptr<geojsonvt::GeoJSONVT> tiles;
-    geometry::feature_collection<double> features;
-    std::vector<Properties> properties;
+};
+
+struct ClientDataSource::Storage {
+    // Tiles at zoom 0
+    Partition world;
+    // Tiles below partition_zoom, per quadrant of the world
+    Partition quadrants[4];
+    // Tiles of partitions with features, created on demand and kept in
+    // least recently used order. Tile workers hold a reference to the
+    // partition they cut from, so that it may be evicted meanwhile.
+    using PartitionList = std::list<std::pair<uint64_t, std::shared_ptr<Partition>>>;
+    PartitionList partitionList;
+    std::unordered_map<uint64_t, PartitionList::iterator> partitions;
+    // Guards the partitions map while the store is shared by tile workers
+    std::mutex partitionsMutex;
+
+    // Features are stored in slots of these arrays
+    GeometryStore geometries;
+    std::vector<uint64_t> ids;
+    // Entries in propertyStore
+    std::vector<uint32_t> properties;
+    std::vector<PartitionBounds> bounds;
+    // Slots of removed features. They keep their place until they are
+    // reclaimed, so that the remaining features keep their order.
+    std::vector<bool> removed;
+    size_t numRemoved = 0;
+
+    PropertyStore propertyStore;
+
+    // Slot for each feature id, maintained when features can be updated.
+    std::unordered_map<uint64_t, size_t> index;
+
+    // Slots of the features overlapping each partition, in slot order, so
+    // that building the index of a partition does not visit all features.
+    // Features overlapping more than max_changed_partitions are only kept
+    // in largeSlots.
+    std::unordered_map<uint64_t, std::vector<uint32_t>> partitionSlots;
+    std::vector<uint32_t> largeSlots;
+
+    // Add a label_placement point at the centroid of polygons when cutting
+    // tiles. Centroids share the properties of their polygon.
+    bool generateCentroids = false;
+
+    // Partitions changed since the last generateTiles()
+    std::vector<uint64_t> changed;
+    bool changedAll = true;
+    // Whether generateTiles() was called
+    bool generated = false;
+
+    // Append _feature or, when _updatable, replace the feature with the same
+    // id. Returns false when an updatable feature has no valid id.
+    bool insert(geometry::feature<double>&& _feature, Properties&& _props, bool _updatable);
+    // Insert all _features, returns the number of inserted features
+    size_t insertAll(geometry::feature_collection<double>& _features, bool _updatable);
+    // Reserve space for _count more features
+    void reserve(size_t _count, bool _updatable);
+    // Mark the partitions in _bounds as changed and drop their tiles,
+    // which refer to the slots of their features
+    void touch(const PartitionBounds& _bounds);
+    // Mark all partitions as changed and drop their tiles
+    void touchAll();
+    // Add or remove _slot in the slot lists of the partitions in its bounds
+    void link(size_t _slot);
+    void unlink(size_t _slot);
+    // Update the bounds of the feature in _slot and mark them as changed
+    void updateBounds(size_t _slot, const geometry::geometry<double>& _geometry);
+    // Remove the feature in _slot, leaving the slot empty
+    void remove(size_t _slot);
+    // Reclaim the slots of removed features when they make up half of the
+    // slots, keeping the order of the other features. Release excess
+    // capacity after many removals.
+    void compact();
+
+    // Cut the tile _tileId, building the index of its partition if needed.
+    // Called with a shared lock on the store.
+    geojsonvt::Tile getTile(const TileID& _tileId);
 };
 
 struct ClientDataSource::PolylineBuilderData : mapbox::geometry::line_string<double> {
@@ -96,6 +215,7 @@ ClientDataSource::ClientDataSource(Platform& _platform, const std::string& _name
 
     m_generateGeometry = true;
     m_store = std::make_unique<Storage>();
+    m_store->generateCentroids = _generateCentroids;
 
     if (!_url.empty()) {
         UrlCallback onUrlFinished = [&, this](UrlResponse&& response) {
@@ -174,26 +294,332 @@ struct prop_visitor {
     }
 };
 
-void ClientDataSource::generateTiles() {
+struct partition_bounds {
+
+    glm::dvec2 min{std::numeric_limits<double>::max()};
+    glm::dvec2 max{std::numeric_limits<double>::lowest()};
+
+    void add(const geometry::point<double>& p) {
+        min = glm::min(min, glm::dvec2(p.x, p.y));
+        max = glm::max(max, glm::dvec2(p.x, p.y));
+    }
+
+    void operator()(const geometry::point<double>& geom) { add(geom); }
+    void operator()(const geometry::line_string<double>& geom) {
+        for (auto& p : geom) { add(p); }
+    }
+    void operator()(const geometry::polygon<double>& geom) {
+        // The outer ring contains the holes
+        if (!geom.empty()) { for (auto& p : geom.front()) { add(p); } }
+    }
+    void operator()(const geometry::multi_point<double>& geom) {
+        for (auto& g : geom) { (*this)(g); }
+    }
+    void operator()(const geometry::multi_line_string<double>& geom) {
+        for (auto& g : geom) { (*this)(g); }
+    }
+    void operator()(const geometry::multi_polygon<double>& geom) {
+        for (auto& g : geom) { (*this)(g); }
+    }
+
+    template <typename T>
+    void operator()(T) {
+        // GeometryCollections get empty bounds and invalidate all tiles
+    }
+
+    PartitionBounds get() const {
+        PartitionBounds bounds;
+        if (min.x > max.x) { return bounds; }
+
+        double metersPerTile = MapProjection::metersPerTileAtZoom(partition_zoom);
+        int32_t numTiles = 1 << partition_zoom;
+        // Tile coordinates are inclusive at the edges: A feature touching
+        // the edge of a partition is also cut into the neighbouring tiles.
+        double margin = 1. / 4096;
+
+        auto toTile = [&](double lon, double lat) {
+            lat = glm::clamp(lat, -MapProjection::MAX_LATITUDE_DEGREES,
+                             MapProjection::MAX_LATITUDE_DEGREES);
+            auto meters = MapProjection::lngLatToProjectedMeters({lon, lat});
+            return glm::dvec2(meters.x + MapProjection::EARTH_HALF_CIRCUMFERENCE_METERS,
+                              MapProjection::EARTH_HALF_CIRCUMFERENCE_METERS - meters.y) / metersPerTile;
+        };
+        auto toIndex = [&](double v) {
+            return glm::clamp(int32_t(std::floor(v)), 0, numTiles - 1);
+        };
+
+        glm::dvec2 nw = toTile(min.x, max.y);
+        glm::dvec2 se = toTile(max.x, min.y);
+
+        bounds.minX = toIndex(nw.x - margin);
+        bounds.minY = toIndex(nw.y - margin);
+        bounds.maxX = toIndex(se.x + margin);
+        bounds.maxY = toIndex(se.y + margin);
+        return bounds;
+    }
+};
+
+// Tiles are dropped right away rather than in generateTiles(), so that tile
+// workers never cut tiles from an index with outdated slots. No tile worker
+// uses the partitions while the store is locked for writing.
+void ClientDataSource::Storage::touch(const PartitionBounds& _bounds) {
+
+    if (_bounds.empty() || _bounds.count() > max_changed_partitions) {
+        touchAll();
+        return;
+    }
+    for (int32_t y = _bounds.minY; y <= _bounds.maxY; y++) {
+        for (int32_t x = _bounds.minX; x <= _bounds.maxX; x++) {
+            uint64_t key = partitionKey(x, y);
+            auto it = partitions.find(key);
+            if (it != partitions.end()) {
+                partitionList.erase(it->second);
+                partitions.erase(it);
+            }
+            quadrants[quadrantIndex(x, y, partition_zoom)].tiles.reset();
+            if (!changedAll) { changed.push_back(key); }
+        }
+    }
+    world.tiles.reset();
+}
+
+void ClientDataSource::Storage::touchAll() {
+    partitions.clear();
+    partitionList.clear();
+    for (auto& quadrant : quadrants) { quadrant.tiles.reset(); }
+    world.tiles.reset();
+
+    changedAll = true;
+    changed.clear();
+}
+
+void ClientDataSource::Storage::link(size_t _slot) {
+    auto& b = bounds[_slot];
+    if (b.empty()) { return; }
+
+    auto insert = [&](std::vector<uint32_t>& _slots) {
+        _slots.insert(std::lower_bound(_slots.begin(), _slots.end(), _slot), _slot);
+    };
+    if (b.count() > max_changed_partitions) {
+        insert(largeSlots);
+        return;
+    }
+    for (int32_t y = b.minY; y <= b.maxY; y++) {
+        for (int32_t x = b.minX; x <= b.maxX; x++) {
+            insert(partitionSlots[partitionKey(x, y)]);
+        }
+    }
+}
+
+void ClientDataSource::Storage::unlink(size_t _slot) {
+    auto& b = bounds[_slot];
+    if (b.empty()) { return; }
+
+    auto erase = [&](std::vector<uint32_t>& _slots) {
+        auto it = std::lower_bound(_slots.begin(), _slots.end(), _slot);
+        if (it != _slots.end() && *it == _slot) { _slots.erase(it); }
+    };
+    if (b.count() > max_changed_partitions) {
+        erase(largeSlots);
+        return;
+    }
+    for (int32_t y = b.minY; y <= b.maxY; y++) {
+        for (int32_t x = b.minX; x <= b.maxX; x++) {
+            auto it = partitionSlots.find(partitionKey(x, y));
+            if (it == partitionSlots.end()) { continue; }
+            erase(it->second);
+            if (it->second.empty()) { partitionSlots.erase(it); }
+        }
+    }
+}
+
+void ClientDataSource::Storage::updateBounds(size_t _slot, const geometry::geometry<double>& _geometry) {
+    if (bounds.size() < ids.size()) { bounds.resize(ids.size()); }
+
+    unlink(_slot);
+
+    partition_bounds visitor;
+    geometry::geometry<double>::visit(_geometry, visitor);
+    bounds[_slot] = visitor.get();
+
+    link(_slot);
+    touch(bounds[_slot]);
+}
 
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+geojsonvt::Tile ClientDataSource::Storage::getTile(const TileID& _tileId) {
+
+    Partition* partition = nullptr;
+    std::shared_ptr<Partition> partitionRef;
+    // Partitions with features in this range, in partition_zoom tiles
+    PartitionBounds area;
+
+    auto overlaps = [&](size_t _slot) {
+        auto& b = bounds[_slot];
+        return !(b.empty() || b.minX > area.maxX || area.minX > b.maxX ||
+                 b.minY > area.maxY || area.minY > b.maxY);
+    };
+
+    if (_tileId.z >= partition_zoom) {
+        int32_t over = _tileId.z - partition_zoom;
+        area.minX = area.maxX = _tileId.x >> over;
+        area.minY = area.maxY = _tileId.y >> over;
+        uint64_t key = partitionKey(area.minX, area.minY);
+
+        std::lock_guard<std::mutex> lock(partitionsMutex);
+
+        auto it = partitions.find(key);
+        if (it != partitions.end()) {
+            partitionList.splice(partitionList.begin(), partitionList, it->second);
+        } else {
+            // Do not keep an index for partitions without features
+            if (partitionSlots.find(key) == partitionSlots.end() &&
+                std::none_of(largeSlots.begin(), largeSlots.end(), overlaps)) {
+                return geojsonvt::Tile();
+            }
+            if (partitionList.size() >= max_cached_partitions) {
+                partitions.erase(partitionList.back().first);
+                partitionList.pop_back();
+            }
+            partitionList.emplace_front(key, std::make_shared<Partition>());
+            it = partitions.emplace(key, partitionList.begin()).first;
+        }
+        partitionRef = it->second->second;
+        partition = partitionRef.get();
+
+    } else if (_tileId.z > 0) {
+        int32_t size = 1 << (partition_zoom - 1);
+        int quadrant = quadrantIndex(_tileId.x, _tileId.y, _tileId.z);
+        area.minX = (quadrant & 1) * size;
+        area.minY = (quadrant >> 1) * size;
+        area.maxX = area.minX + size - 1;
+        area.maxY = area.minY + size - 1;
+        partition = &quadrants[quadrant];
+
+    } else {
+        area.minX = area.minY = 0;
+        area.maxX = area.maxY = (1 << partition_zoom) - 1;
+        partition = &world;
+    }
+
+    std::lock_guard<std::mutex> lock(partition->mutex);
 
-    if (m_generateCentroids) {
-        for (const auto &feat : m_store->features) {
+    if (!partition->tiles) {
+        geometry::feature_collection<double> subset;
+
+        auto addFeature = [&](size_t slot) {
+            auto geom = geometries.get(slot);
+
+            // The tiled features refer to their slot, centroids to the
+            // slot of their polygon.
             geometry::point<double> centroid;
-            const auto& properties = m_store->properties[feat.id.get<uint64_t>()];
-            if (geometry::geometry<double>::visit(feat.geometry, add_centroid{ centroid })) {
-                auto id = m_store->features.size();
-                m_store->features.emplace_back(centroid, id);
-                m_store->properties.push_back(properties);
-                auto& props = m_store->properties.back();
-                props.set("label_placement", 1.0);
+            if (generateCentroids && geometry::geometry<double>::visit(geom, add_centroid{ centroid })) {
+                subset.emplace_back(centroid, ids[slot]);
+                subset.back().indexInArray = 2 * slot + 1;
+            }
+
+            subset.emplace_back(std::move(geom), ids[slot]);
+            subset.back().indexInArray = 2 * slot;
+        };
+
+        if (_tileId.z >= partition_zoom) {
+            // Merge the slots of the partition with the large features,
+            // keeping the slot order
+            static const std::vector<uint32_t> none;
+            auto it = partitionSlots.find(partitionKey(area.minX, area.minY));
+            auto& slots = (it != partitionSlots.end()) ? it->second : none;
+
+            size_t i = 0, j = 0;
+            while (i < slots.size() || j < largeSlots.size()) {
+                if (j == largeSlots.size() || (i < slots.size() && slots[i] < largeSlots[j])) {
+                    addFeature(slots[i++]);
+                } else if (overlaps(largeSlots[j])) {
+                    addFeature(largeSlots[j++]);
+                } else {
+                    j++;
+                }
+            }
+        } else {
+            for (size_t slot = 0; slot < ids.size(); slot++) {
+                if (overlaps(slot)) { addFeature(slot); }
             }
         }
+        partition->tiles = std::make_unique<geojsonvt::GeoJSONVT>(subset, options());
     }
 
-    m_store->tiles = std::make_unique<geojsonvt::GeoJSONVT>(m_store->features, options());
+    return partition->tiles->getTile(_tileId.z, _tileId.x, _tileId.y);
+}
+
+void ClientDataSource::generateTiles() {
+
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
+
+    if (m_store->generated && !m_store->changedAll && m_store->changed.empty()) {
+        return;
+    }
+
+    m_store->generated = true;
     m_generation++;
+
+    // The tiles of changed partitions were dropped when they changed.
+    // Invalidate the loaded tiles cut from them.
+    bool changedQuadrants[4] = { false, false, false, false };
+
+    if (m_store->changedAll) {
+        for (auto& changed : changedQuadrants) { changed = true; }
+    } else {
+        for (auto key : m_store->changed) {
+            int32_t x = int32_t(key >> 32), y = int32_t(key & 0xffffffff);
+            changedQuadrants[quadrantIndex(x, y, partition_zoom)] = true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lockGeneration(m_mutexGeneration);
+
+        if (m_store->changedAll) {
+            m_fullGeneration = m_generation;
+            m_partitionGeneration.clear();
+        } else {
+            for (auto key : m_store->changed) { m_partitionGeneration[key] = m_generation; }
+        }
+        for (int i = 0; i < 4; i++) {
+            if (changedQuadrants[i]) { m_quadrantGeneration[i] = m_generation; }
+        }
+        m_overviewGeneration = m_generation;
+    }
+
+    m_store->changed.clear();
+    m_store->changedAll = false;
+}
+
+void ClientDataSource::clearData() {
+
+    TileSource::clearData();
+
+    std::lock_guard<std::mutex> lock(m_mutexGeneration);
+    m_fullGeneration = m_generation;
+    m_overviewGeneration = m_generation;
+    for (auto& generation : m_quadrantGeneration) { generation = m_generation; }
+    m_partitionGeneration.clear();
+}
+
+int64_t ClientDataSource::generation(const TileID& _tileId) const {
+
+    std::lock_guard<std::mutex> lock(m_mutexGeneration);
+
+    if (_tileId.z == 0) {
+        return m_overviewGeneration;
+    }
+    if (_tileId.z < partition_zoom) {
+        return m_quadrantGeneration[quadrantIndex(_tileId.x, _tileId.y, _tileId.z)];
+    }
+
+    int32_t over = _tileId.z - partition_zoom;
+    auto it = m_partitionGeneration.find(partitionKey(_tileId.x >> over, _tileId.y >> over));
+    if (it != m_partitionGeneration.end()) {
+        return it->second;
+    }
+    return m_fullGeneration;
 }
 
 void ClientDataSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) {
@@ -214,10 +640,19 @@ void ClientDataSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb
 
 void ClientDataSource::clearFeatures() {
 
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
-    m_store->features.clear();
+    m_store->geometries.clear();
+    m_store->ids.clear();
     m_store->properties.clear();
+    m_store->bounds.clear();
+    m_store->removed.clear();
+    m_store->numRemoved = 0;
+    m_store->propertyStore.clear();
+    m_store->index.clear();
+    m_store->partitionSlots.clear();
+    m_store->largeSlots.clear();
+    m_store->touchAll();
 }
 
 size_t ClientDataSource::addData(const std::string& _data)
@@ -225,82 +660,512 @@ size_t ClientDataSource::addData(const std::string& _data)
     return addData(_data.c_str(), _data.size());
 }
 
+// Move the properties of _feature into _props
+static void setProperties(Properties& _props, geojson::feature& _feature) {
+    _props.clear();
+    for (const auto& prop : _feature.properties) {
+        auto key = prop.first;
+        prop_visitor visitor = {_props, key};
+        mapbox::util::apply_visitor(visitor, prop.second);
+    }
+    _feature.properties.clear();
+}
+
+static bool hasValidId(const geojson::feature& _feature) {
+    return _feature.id.is<uint64_t>() && _feature.id.get<uint64_t>() != 0;
+}
+
+void ClientDataSource::Storage::remove(size_t _slot) {
+
+    touch(bounds[_slot]);
+    unlink(_slot);
+    propertyStore.release(properties[_slot]);
+
+    geometries.remove(_slot);
+    bounds[_slot] = {};
+    removed[_slot] = true;
+    numRemoved++;
+}
+
+void ClientDataSource::Storage::compact() {
+
+    if (numRemoved > min_compact_slots && numRemoved * 2 > ids.size()) {
+        size_t size = 0;
+        for (size_t slot = 0; slot < ids.size(); slot++) {
+            if (removed[slot]) { continue; }
+
+            // Features added without id are not indexed and may share an id
+            // with an indexed feature, so only move the entry that points to slot.
+            auto it = index.find(ids[slot]);
+            if (it != index.end() && it->second == slot) {
+                it->second = size;
+            }
+            ids[size] = ids[slot];
+            properties[size] = properties[slot];
+            bounds[size] = bounds[slot];
+            size++;
+        }
+        geometries.eraseSlots(removed);
+        ids.resize(size);
+        properties.resize(size);
+        bounds.resize(size);
+        removed.assign(size, false);
+        numRemoved = 0;
+
+        partitionSlots.clear();
+        largeSlots.clear();
+        for (size_t slot = 0; slot < size; slot++) { link(slot); }
+
+        // Tiles refer to the slots of their features
+        touchAll();
+    }
+
+    if (ids.capacity() > 1024 && ids.size() < ids.capacity() / 4) {
+        geometries.shrinkToFit();
+        ids.shrink_to_fit();
+        properties.shrink_to_fit();
+        bounds.shrink_to_fit();
+        removed.shrink_to_fit();
+    }
+}
+
+bool ClientDataSource::Storage::insert(geometry::feature<double>&& _feature,
+                                      Properties&& _props, bool _updatable) {
+    size_t slot = ids.size();
+    uint64_t id = slot;
+
+    if (_updatable) {
+        if (!hasValidId(_feature)) { return false; }
+
+        // Replace features that were added before with the same id
+        id = _feature.id.get<uint64_t>();
+        auto entry = index.emplace(id, slot);
+        if (!entry.second) { slot = entry.first->second; }
+    }
+
+    uint32_t props = propertyStore.add(std::move(_props));
+
+    if (slot == ids.size()) {
+        ids.push_back(id);
+        properties.push_back(props);
+        removed.push_back(false);
+    } else {
+        touch(bounds[slot]);
+        propertyStore.release(properties[slot]);
+        properties[slot] = props;
+    }
+    geometries.set(slot, _feature.geometry);
+    updateBounds(slot, _feature.geometry);
+
+    return true;
+}
+
+void ClientDataSource::Storage::reserve(size_t _count, bool _updatable) {
+    size_t capacity = ids.size() + _count;
+    if (capacity <= ids.capacity()) { return; }
+
+    if (_updatable) {
+        // reserving some extra features to avoid later huge allocations when we append features
+        capacity += 500;
+    }
+    geometries.reserve(capacity);
+    ids.reserve(capacity);
+    properties.reserve(capacity);
+    bounds.reserve(capacity);
+    removed.reserve(capacity);
+}
+
+size_t ClientDataSource::Storage::insertAll(geometry::feature_collection<double>& _features,
+                                           bool _updatable) {
+    size_t added = 0;
+
+    reserve(_features.size(), _updatable);
+
+    for (auto& feature : _features) {
+        Properties props;
+        setProperties(props, feature);
+
+        if (insert(std::move(feature), std::move(props), _updatable)) {
+            ++added;
+        }
+    }
+    return added;
+}
+
 size_t ClientDataSource::addData(const char* _data, size_t length) {
-    size_t added{};
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
     const auto json = geojson::parse(_data, length);
     auto features = geojsonvt::geojson::visit(json, geojsonvt::ToFeatureCollection{});
 
-    if(m_canUpdateFeatures)
-    {
-        // reserving some extra features to avoid later huge allocations when we append features
-        m_store->features.reserve(features.size() + 500);
-        m_store->properties.reserve(features.size() + 500);
-    }
+    return m_store->insertAll(features, m_canUpdateFeatures);
+}
 
-    for (auto& feature : features) {
-        if(m_canUpdateFeatures)
-        {
-            if(!feature.id.is<uint64_t>() || feature.id.get<uint64_t>() == 0)
-                continue;
+// Splits a GeoJSON document that arrives in chunks into the texts of the
+// features of a FeatureCollection, without parsing the whole document.
+// Other objects, i.e. a single Feature or geometry, are passed on as a
+// whole once they are complete. Documents that are not an object are
+// rejected.
+struct ClientDataSource::ChunkParser {
+
+    enum class State { prefix, features, suffix, invalid };
+    State state = State::prefix;
+
+    // The document up to the features array
+    std::string document;
+    // Text of the current feature
+    std::string element;
+    bool inElement = false;
+
+    // Last string and key of the root object
+    std::string string;
+    std::string key;
+    bool expectValue = false;
+
+    int depth = 0;
+    bool inString = false;
+    bool escape = false;
+
+    // Scan _data and append the texts of completed features to _features
+    void push(const char* _data, size_t _length, std::vector<std::string>& _features);
+};
+
+void ClientDataSource::ChunkParser::push(const char* _data, size_t _length,
+                                         std::vector<std::string>& _features) {
+
+    for (size_t i = 0; i < _length; i++) {
+        char c = _data[i];
+
+        if (state == State::invalid) { return; }
+
+        if (state == State::prefix && depth == 0 && !inString &&
+            c != '{' && !std::isspace(static_cast<unsigned char>(c))) {
+            state = State::invalid;
+            return;
         }
-        else {
-            feature.id = uint64_t(m_store->properties.size());
+
+        if (inString) {
+            if (escape) {
+                escape = false;
+            } else if (c == '\\') {
+                escape = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+            if (inString && depth == 1) { string.push_back(c); }
+
+        } else {
+            switch (c) {
+            case '"':
+                inString = true;
+                if (depth == 1) { string.clear(); }
+                break;
+            case ':':
+                if (depth == 1) {
+                    key = string;
+                    expectValue = true;
+                }
+                break;
+            case ',':
+                if (depth == 1) { expectValue = false; }
+                break;
+            case '{':
+            case '[':
+                if (state == State::prefix && depth == 1 && c == '[' &&
+                    expectValue && key == "features") {
+                    state = State::features;
+                    document.clear();
+                    depth++;
+                    continue;
+                }
+                depth++;
+                if (state == State::features && depth == 3 && c == '{') {
+                    inElement = true;
+                    element.clear();
+                }
+                break;
+            case '}':
+            case ']':
+                depth--;
+                if (state == State::prefix && depth == 0) {
+                    // A single Feature or geometry
+                    document.push_back(c);
+                    _features.push_back(std::move(document));
+                    document.clear();
+                    state = State::suffix;
+                    continue;
+                }
+                if (state == State::features) {
+                    if (inElement && depth == 2) {
+                        element.push_back(c);
+                        _features.push_back(std::move(element));
+                        element.clear();
+                        inElement = false;
+                        continue;
+                    }
+                    if (depth == 1) { state = State::suffix; }
+                }
+                break;
+            default:
+                break;
+            }
         }
 
-        feature.indexInArray = m_store->properties.size();
+        if (state == State::prefix) { document.push_back(c); }
+        if (inElement) { element.push_back(c); }
+    }
+}
 
-        m_store->properties.emplace_back();
+void ClientDataSource::beginData() {
+    m_chunkParser = std::make_unique<ChunkParser>();
+}
 
-        Properties& props = m_store->properties.back();
+size_t ClientDataSource::addDataChunk(const char* _data, size_t _length) {
 
-        for (const auto& prop : feature.properties) {
-            auto key = prop.first;
-            prop_visitor visitor = {props, key};
-            mapbox::util::apply_visitor(visitor, prop.second);
-        }
+    if (!m_chunkParser) { beginData(); }
 
-        feature.properties.clear();
+    std::vector<std::string> texts;
+    bool valid = m_chunkParser->state != ChunkParser::State::invalid;
+    m_chunkParser->push(_data, _length, texts);
 
-        ++added;
+    if (valid && m_chunkParser->state == ChunkParser::State::invalid) {
+        LOGE("GeoJSON data for '%s' is not a FeatureCollection, Feature or geometry object",
+             m_name.c_str());
     }
+    if (texts.empty()) { return 0; }
 
-    m_store->features.insert(m_store->features.end(),
-                             std::make_move_iterator(features.begin()),
-                             std::make_move_iterator(features.end()));
-    return added;
+    // Parse the features before taking the lock
+    geometry::feature_collection<double> features;
+    for (auto& text : texts) {
+        try {
+            const auto json = geojson::parse(text.c_str(), text.size());
+            auto feature = geojsonvt::geojson::visit(json, geojsonvt::ToFeatureCollection{});
+            features.insert(features.end(),
+                            std::make_move_iterator(feature.begin()),
+                            std::make_move_iterator(feature.end()));
+        } catch (const std::exception& e) {
+            LOGE("Invalid GeoJSON in '%s': %s", m_name.c_str(), e.what());
+        }
+        text = std::string();
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
+    return m_store->insertAll(features, m_canUpdateFeatures);
+}
+
+size_t ClientDataSource::endData() {
+
+    if (!m_chunkParser) { return 0; }
+
+    auto parser = std::move(m_chunkParser);
+
+    switch (parser->state) {
+    case ChunkParser::State::prefix:
+    case ChunkParser::State::features:
+        LOGE("Incomplete GeoJSON data for '%s'", m_name.c_str());
+        break;
+    case ChunkParser::State::suffix:
+    case ChunkParser::State::invalid:
+        break;
+    }
+    return 0;
 }
 
 void ClientDataSource::addPointFeature(Properties&& properties, LngLat coordinates) {
 
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
     geometry::point<double> geom {coordinates.longitude, coordinates.latitude};
 
-    size_t id = m_store->features.size();
-    m_store->features.emplace_back(geom, id);
-    m_store->properties.emplace_back(properties);
+    m_store->insert({ geom, uint64_t(0) }, std::move(properties), false);
 }
 
 void ClientDataSource::addPolylineFeature(Properties&& properties, PolylineBuilder&& polyline) {
 
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
-    auto id = m_store->features.size();
     auto geom = std::move(polyline.data);
-    m_store->features.emplace_back(*geom, id);
-    m_store->properties.emplace_back(properties);
+    m_store->insert({ *geom, uint64_t(0) }, std::move(properties), false);
 }
 
 void ClientDataSource::addPolygonFeature(Properties&& properties, PolygonBuilder&& polygon) {
 
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
-    auto id = m_store->features.size();
     auto geom = std::move(polygon.data);
-    m_store->features.emplace_back(*geom, id);
-    m_store->properties.emplace_back(properties);
+    m_store->insert({ *geom, uint64_t(0) }, std::move(properties), false);
+}
+
+void ClientDataSource::FeatureColumns::addColumn(std::string _key, std::vector<double> _values) {
+    columns.push_back({ std::move(_key), std::move(_values), {} });
+}
+
+void ClientDataSource::FeatureColumns::addColumn(std::string _key, std::vector<std::string> _values) {
+    columns.push_back({ std::move(_key), {}, std::move(_values) });
+}
+
+size_t ClientDataSource::FeatureColumns::size() const {
+    if (!featureOffsets.empty()) { return featureOffsets.size() - 1; }
+
+    switch (type) {
+    case Type::points: return coordinates.size() / 2;
+    case Type::lines: return ringOffsets.empty() ? 0 : ringOffsets.size() - 1;
+    case Type::polygons: return polygonOffsets.empty() ? 0 : polygonOffsets.size() - 1;
+    }
+    return 0;
+}
+
+// Offsets must be ascending and within _count elements
+static bool validOffsets(const std::vector<uint32_t>& _offsets, size_t _count) {
+    if (_offsets.empty()) { return false; }
+    for (size_t i = 1; i < _offsets.size(); i++) {
+        if (_offsets[i] < _offsets[i-1]) { return false; }
+    }
+    return _offsets.back() <= _count;
+}
+
+struct column_geometry {
+
+    const ClientDataSource::FeatureColumns& columns;
+
+    geometry::point<double> point(uint32_t _index) const {
+        return { columns.coordinates[2 * _index], columns.coordinates[2 * _index + 1] };
+    }
+
+    template <typename T>
+    T ring(uint32_t _index) const {
+        T result;
+        uint32_t begin = columns.ringOffsets[_index], end = columns.ringOffsets[_index + 1];
+        result.reserve(end - begin);
+        for (uint32_t i = begin; i < end; i++) { result.push_back(point(i)); }
+        return result;
+    }
+
+    geometry::polygon<double> polygon(uint32_t _index) const {
+        geometry::polygon<double> result;
+        uint32_t begin = columns.polygonOffsets[_index], end = columns.polygonOffsets[_index + 1];
+        result.reserve(end - begin);
+        for (uint32_t i = begin; i < end; i++) {
+            result.push_back(ring<geometry::linear_ring<double>>(i));
+        }
+        return result;
+    }
+
+    // Geometry of the parts [_begin, _end) of a feature
+    geometry::geometry<double> get(uint32_t _begin, uint32_t _end) const {
+        using Type = ClientDataSource::FeatureColumns::Type;
+        bool multi = _end - _begin > 1;
+
+        switch (columns.type) {
+        case Type::points:
+            if (!multi) { return point(_begin); }
+            {
+                geometry::multi_point<double> result;
+                for (uint32_t i = _begin; i < _end; i++) { result.push_back(point(i)); }
+                return result;
+            }
+        case Type::lines:
+            if (!multi) { return ring<geometry::line_string<double>>(_begin); }
+            {
+                geometry::multi_line_string<double> result;
+                for (uint32_t i = _begin; i < _end; i++) {
+                    result.push_back(ring<geometry::line_string<double>>(i));
+                }
+                return result;
+            }
+        case Type::polygons:
+            if (!multi) { return polygon(_begin); }
+            {
+                geometry::multi_polygon<double> result;
+                for (uint32_t i = _begin; i < _end; i++) { result.push_back(polygon(i)); }
+                return result;
+            }
+        }
+        return {};
+    }
+};
+
+size_t ClientDataSource::addFeatures(FeatureColumns&& _columns) {
+
+    using Type = FeatureColumns::Type;
+
+    size_t numFeatures = _columns.size();
+    size_t numPoints = _columns.coordinates.size() / 2;
+
+    // Number of points, lines or polygons
+    size_t numParts = numPoints;
+    bool valid = _columns.coordinates.size() % 2 == 0;
+
+    if (_columns.type != Type::points) {
+        valid &= validOffsets(_columns.ringOffsets, numPoints);
+        numParts = _columns.ringOffsets.empty() ? 0 : _columns.ringOffsets.size() - 1;
+    }
+    if (_columns.type == Type::polygons) {
+        valid &= validOffsets(_columns.polygonOffsets, numParts);
+        numParts = _columns.polygonOffsets.empty() ? 0 : _columns.polygonOffsets.size() - 1;
+    }
+    if (!_columns.featureOffsets.empty()) {
+        valid &= validOffsets(_columns.featureOffsets, numParts);
+    }
+    if (!_columns.ids.empty() || m_canUpdateFeatures) {
+        valid &= _columns.ids.size() == numFeatures;
+    }
+    for (auto& column : _columns.columns) {
+        valid &= (column.numbers.size() == numFeatures || column.strings.size() == numFeatures);
+    }
+    if (!valid) {
+        LOGE("Invalid feature columns for '%s'", m_name.c_str());
+        return 0;
+    }
+
+    // Add the properties of each feature in key order
+    std::vector<size_t> order(_columns.columns.size());
+    for (size_t i = 0; i < order.size(); i++) { order[i] = i; }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return Properties::keyComparator(_columns.columns[a].key, _columns.columns[b].key);
+        });
+
+    // Convert the features before taking the lock
+    std::vector<geometry::feature<double>> features;
+    std::vector<Properties> properties;
+    features.reserve(numFeatures);
+    properties.reserve(numFeatures);
+
+    column_geometry builder{ _columns };
+
+    for (size_t i = 0; i < numFeatures; i++) {
+        uint32_t begin = _columns.featureOffsets.empty() ? i : _columns.featureOffsets[i];
+        uint32_t end = _columns.featureOffsets.empty() ? i + 1 : _columns.featureOffsets[i + 1];
+        if (begin == end) { continue; }
+
+        uint64_t id = _columns.ids.empty() ? 0 : _columns.ids[i];
+        features.emplace_back(builder.get(begin, end), id);
+
+        std::vector<Properties::Item> items;
+        items.reserve(order.size());
+        for (size_t c : order) {
+            auto& column = _columns.columns[c];
+            if (!column.strings.empty()) {
+                items.emplace_back(column.key, std::move(column.strings[i]));
+            } else if (!std::isnan(column.numbers[i])) {
+                items.emplace_back(column.key, column.numbers[i]);
+            }
+        }
+        properties.emplace_back();
+        properties.back().setSorted(std::move(items));
+    }
+
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
+
+    m_store->reserve(features.size(), m_canUpdateFeatures);
+
+    size_t added = 0;
+    for (size_t i = 0; i < features.size(); i++) {
+        if (m_store->insert(std::move(features[i]), std::move(properties[i]), m_canUpdateFeatures)) {
+            ++added;
+        }
+    }
+    return added;
 }
 
 struct add_geometry {
@@ -369,12 +1234,14 @@ struct add_geometry {
 
 std::shared_ptr<TileData> ClientDataSource::parse(const TileTask& _task) const {
 
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    // Tile workers only read the features, so they may parse in parallel
+    std::shared_lock<std::shared_timed_mutex> lock(m_mutexStore);
 
     auto data = std::make_shared<TileData>();
 
-    if (!m_store->tiles) { return nullptr; }
-    auto tile = m_store->tiles->getTile(_task.tileId().z, _task.tileId().x, _task.tileId().y);
+    if (!m_store->generated) { return nullptr; }
+
+    auto tile = m_store->getTile(_task.tileId());
 
     data->layers.emplace_back("");  // empty name will skip filtering by 'collection'
     Layer& layer = data->layers.back();
@@ -383,12 +1250,19 @@ std::shared_ptr<TileData> ClientDataSource::parse(const TileTask& _task) const {
         Feature feature(m_id);
 
         if (geometry::geometry<int16_t>::visit(it.geometry, add_geometry{ feature })) {
-            if(it.indexInArray >= m_store->features.size()) {
+            size_t slot = it.indexInArray / 2;
+            if(slot >= m_store->ids.size()) {
                 LOGE("indexOfArray is out of bound!");
             }
+            else if (m_store->removed[slot]) {
+                // Removed since the tiles of this partition were cut
+            }
             else
             {
-                feature.props = m_store->properties[it.indexInArray];
+                feature.props = m_store->propertyStore.get(m_store->properties[slot]);
+                if (it.indexInArray % 2 == 1) {
+                    feature.props.set("label_placement", 1.0);
+                }
                 layer.features.emplace_back(std::move(feature));
             }
         }
@@ -399,62 +1273,28 @@ std::shared_ptr<TileData> ClientDataSource::parse(const TileTask& _task) const {
 
 }
 
-static std::vector<uint64_t> filterIds(mapbox::geojson::feature_collection& features)
-{
-    std::vector<uint64_t> ids;
-
-    for(int i = 0; i < features.size(); i++) {
-        if (!features[i].id.is<uint64_t>() || features[i].id.get<uint64_t>() == 0) {
-            features.erase(features.begin() + i);
-            i--;
-            continue;
-        }
-
-        ids.push_back(features[i].id.get<uint64_t>());
-    }
-
-    return ids;
-}
-
 size_t Tangram::ClientDataSource::removeFeatures(const size_t *idsArray, size_t length) {
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
-    if (!idsArray || !m_canUpdateFeatures || m_store->features.empty() || length == 0)
+    if (!idsArray || !m_canUpdateFeatures || m_store->ids.empty() || length == 0)
         return 0;
 
-    size_t updated = 0;
-    std::vector<size_t> ids{idsArray, idsArray + length};
-    size_t firstRemovedIndex = 0;
-    for (int store_index = 0; store_index < m_store->features.size(); store_index++) {
-        for (auto update_index = 0; update_index < ids.size(); update_index++) {
-            if (m_store->features[store_index].id.get<uint64_t>() == ids[update_index]) {
-                // remember the first removed
-                if(updated == 0) firstRemovedIndex = store_index;
-
-                m_store->properties.erase(m_store->properties.begin() + store_index);
-                m_store->features.erase(m_store->features.begin() + store_index);
-
-                ids.erase(ids.begin() + update_index);
-                ++updated;
-                --store_index;
-                break;
-            }
-        }
-    }
+    size_t removed = 0;
+    for (size_t i = 0; i < length; i++) {
+        auto it = m_store->index.find(idsArray[i]);
+        if (it == m_store->index.end()) { continue; }
 
-    if(updated) {
-        if(m_store->features.capacity() - m_store->features.size() > 1000)
-        {
-            m_store->features.reserve(m_store->features.size() + 500);
-            m_store->properties.reserve(m_store->features.size() + 500);
-        }
+        size_t slot = it->second;
+        m_store->index.erase(it);
+        m_store->remove(slot);
+        ++removed;
+    }
 
-        // update the indexInArray after removing the elements
-        for (size_t i = firstRemovedIndex; i < m_store->features.size(); ++i)
-            m_store->features[i].indexInArray = i;
+    if (removed) {
+        m_store->compact();
     }
 
-    return updated;
+    return removed;
 }
 
 size_t Tangram::ClientDataSource::appendOrUpdateFeatures(const std::string &_data) {
@@ -462,7 +1302,7 @@ size_t Tangram::ClientDataSource::appendOrUpdateFeatures(const std::string &_dat
 }
 
 size_t Tangram::ClientDataSource::appendOrUpdateFeatures(const char* _data, size_t length) {
-    std::lock_guard<std::mutex> lock(m_mutexStore);
+    std::lock_guard<std::shared_timed_mutex> lock(m_mutexStore);
 
     if (!m_canUpdateFeatures)
         return 0;
@@ -470,72 +1310,5 @@ size_t Tangram::ClientDataSource::appendOrUpdateFeatures(const char* _data, size
     const auto json = geojson::parse(_data, length);
     auto features = geojsonvt::geojson::visit(json, geojsonvt::ToFeatureCollection{});
 
-    size_t updated = 0;
-
-    auto ids = filterIds(features);
-    if(ids.empty()) return 0;
-
-    // first try to update features
-    for (int store_index = 0; store_index < m_store->features.size(); store_index++) {
-        for (int update_index = 0; update_index < ids.size(); update_index++) {
-            auto store_feature = m_store->features[store_index];
-
-            if (store_feature.id.get<uint64_t>() == ids[update_index]) {
-                Properties &props = m_store->properties[store_index];
-                props.clear();
-
-                auto &feature = features[update_index];
-                for (const auto &prop: feature.properties) {
-                    auto key = prop.first;
-                    Tangram::prop_visitor visitor = {props, key};
-                    mapbox::util::apply_visitor(visitor, prop.second);
-                }
-                feature.properties.clear();
-                m_store->features[store_index] = std::move(features[update_index]);
-                m_store->features[store_index].indexInArray = store_index;
-
-                ++updated;
-
-                features.erase(features.begin() + update_index);
-                ids.erase(ids.begin() + update_index);
-
-                if (ids.empty())
-                    return updated;
-
-                update_index--;
-            }
-        }
-    }
-
-    if(m_store->features.capacity() < m_store->features.size() + ids.size())
-    {
-        auto new_cap = m_store->features.size() + ids.size() + 500;
-        m_store->features.reserve(new_cap);
-        m_store->properties.reserve(new_cap);
-    }
-
-    // insert the remaining ones
-    for (auto id: ids) {
-        auto it = std::find_if(features.begin(), features.end(),
-                               [id](const mapbox::geojson::feature &x) {
-                                   return x.id.get<uint64_t>() == id;
-                               });
-
-        if (it == features.end()) continue;
-        m_store->properties.emplace_back();
-        Properties &props = m_store->properties.back();
-
-        for (const auto &prop: it->properties) {
-            auto key = prop.first;
-            prop_visitor visitor = {props, key};
-            mapbox::util::apply_visitor(visitor, prop.second);
-        }
-
-        it->properties.clear();
-        it->indexInArray = m_store->features.size();
-        m_store->features.push_back(std::move(*it));
-        ++updated;
-    }
-
-    return updated;
+    return m_store->insertAll(features, true);
 }
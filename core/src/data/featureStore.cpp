@@ -0,0 +1,335 @@
+#include "data/featureStore.h"
+
+#include "data/propertyItem.h"
+#include "util/hash.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Tangram {
+
+using namespace mapbox;
+
+static const double coordinate_scale = 1e7;
+
+// Beyond this the quantized coordinates would overflow int32
+static const double max_coordinate = 214.;
+
+// Minimum number of unused entries to reclaim
+static const size_t min_compact = 1024;
+
+static int32_t quantize(double _v) {
+    return int32_t(std::lround(std::min(std::max(_v, -max_coordinate), max_coordinate) * coordinate_scale));
+}
+
+struct GeometryStore::Encoder {
+
+    GeometryStore& store;
+    Record& record;
+
+    void add(const geometry::point<double>& p) {
+        store.m_x.push_back(quantize(p.x));
+        store.m_y.push_back(quantize(p.y));
+    }
+
+    template <typename T>
+    void addRing(const T& _ring) {
+        store.m_sizes.push_back(_ring.size());
+        for (auto& p : _ring) { add(p); }
+    }
+
+    void addPolygon(const geometry::polygon<double>& _polygon) {
+        store.m_sizes.push_back(_polygon.size());
+        for (auto& ring : _polygon) { addRing(ring); }
+    }
+
+    void operator()(const geometry::point<double>& geom) {
+        record.type = Type::point;
+        add(geom);
+    }
+    void operator()(const geometry::line_string<double>& geom) {
+        record.type = Type::line_string;
+        addRing(geom);
+    }
+    void operator()(const geometry::polygon<double>& geom) {
+        record.type = Type::polygon;
+        addPolygon(geom);
+    }
+    void operator()(const geometry::multi_point<double>& geom) {
+        record.type = Type::multi_point;
+        addRing(geom);
+    }
+    void operator()(const geometry::multi_line_string<double>& geom) {
+        record.type = Type::multi_line_string;
+        store.m_sizes.push_back(geom.size());
+        for (auto& line : geom) { addRing(line); }
+    }
+    void operator()(const geometry::multi_polygon<double>& geom) {
+        record.type = Type::multi_polygon;
+        store.m_sizes.push_back(geom.size());
+        for (auto& polygon : geom) { addPolygon(polygon); }
+    }
+
+    template <typename T>
+    void operator()(const T&) {
+        // GeometryCollections are not tiled
+        record.type = Type::empty;
+    }
+};
+
+struct GeometryStore::Decoder {
+
+    const GeometryStore& store;
+    uint32_t coord;
+    uint32_t size;
+
+    geometry::point<double> point() {
+        geometry::point<double> p{ store.m_x[coord] / coordinate_scale,
+                                   store.m_y[coord] / coordinate_scale };
+        coord++;
+        return p;
+    }
+
+    template <typename T>
+    T ring() {
+        T result;
+        uint32_t numPoints = store.m_sizes[size++];
+        result.reserve(numPoints);
+        for (uint32_t i = 0; i < numPoints; i++) { result.push_back(point()); }
+        return result;
+    }
+
+    geometry::polygon<double> polygon() {
+        geometry::polygon<double> result;
+        uint32_t numRings = store.m_sizes[size++];
+        result.reserve(numRings);
+        for (uint32_t i = 0; i < numRings; i++) {
+            result.push_back(ring<geometry::linear_ring<double>>());
+        }
+        return result;
+    }
+
+    template <typename T, typename F>
+    T parts(F _part) {
+        T result;
+        uint32_t numParts = store.m_sizes[size++];
+        result.reserve(numParts);
+        for (uint32_t i = 0; i < numParts; i++) { result.push_back(_part()); }
+        return result;
+    }
+};
+
+void GeometryStore::set(size_t _slot, const Geometry& _geometry) {
+
+    if (_slot == m_records.size()) {
+        m_records.emplace_back();
+    } else {
+        release(m_records[_slot]);
+    }
+
+    Record& record = m_records[_slot];
+    record.coords = m_x.size();
+    record.sizes = m_sizes.size();
+
+    Geometry::visit(_geometry, Encoder{ *this, record });
+
+    record.numCoords = m_x.size() - record.coords;
+    record.numSizes = m_sizes.size() - record.sizes;
+
+    compact();
+}
+
+GeometryStore::Geometry GeometryStore::get(size_t _slot) const {
+
+    const Record& record = m_records[_slot];
+    Decoder decoder{ *this, record.coords, record.sizes };
+
+    switch (record.type) {
+    case Type::point:
+        return decoder.point();
+    case Type::line_string:
+        return decoder.ring<geometry::line_string<double>>();
+    case Type::polygon:
+        return decoder.polygon();
+    case Type::multi_point:
+        return decoder.ring<geometry::multi_point<double>>();
+    case Type::multi_line_string:
+        return decoder.parts<geometry::multi_line_string<double>>([&]() {
+                return decoder.ring<geometry::line_string<double>>();
+            });
+    case Type::multi_polygon:
+        return decoder.parts<geometry::multi_polygon<double>>([&]() {
+                return decoder.polygon();
+            });
+    case Type::empty:
+        break;
+    }
+    return Geometry{};
+}
+
+void GeometryStore::remove(size_t _slot) {
+
+    release(m_records[_slot]);
+    m_records[_slot] = Record{};
+
+    compact();
+}
+
+void GeometryStore::eraseSlots(const std::vector<bool>& _erase) {
+
+    size_t size = 0;
+    for (size_t slot = 0; slot < m_records.size(); slot++) {
+        if (slot < _erase.size() && _erase[slot]) {
+            release(m_records[slot]);
+            continue;
+        }
+        m_records[size++] = m_records[slot];
+    }
+    m_records.resize(size);
+
+    compact();
+}
+
+void GeometryStore::release(const Record& _record) {
+    m_unusedCoords += _record.numCoords;
+    m_unusedSizes += _record.numSizes;
+}
+
+void GeometryStore::compact() {
+
+    bool unusedCoords = m_unusedCoords > min_compact && m_unusedCoords * 2 > m_x.size();
+    bool unusedSizes = m_unusedSizes > min_compact && m_unusedSizes * 2 > m_sizes.size();
+    if (!unusedCoords && !unusedSizes) { return; }
+
+    std::vector<int32_t> x, y;
+    std::vector<uint32_t> sizes;
+    x.reserve(m_x.size() - m_unusedCoords);
+    y.reserve(m_y.size() - m_unusedCoords);
+    sizes.reserve(m_sizes.size() - m_unusedSizes);
+
+    for (auto& record : m_records) {
+        uint32_t coords = x.size();
+        x.insert(x.end(), m_x.begin() + record.coords, m_x.begin() + record.coords + record.numCoords);
+        y.insert(y.end(), m_y.begin() + record.coords, m_y.begin() + record.coords + record.numCoords);
+        record.coords = coords;
+
+        uint32_t recordSizes = sizes.size();
+        sizes.insert(sizes.end(), m_sizes.begin() + record.sizes,
+                     m_sizes.begin() + record.sizes + record.numSizes);
+        record.sizes = recordSizes;
+    }
+
+    m_x.swap(x);
+    m_y.swap(y);
+    m_sizes.swap(sizes);
+
+    m_unusedCoords = 0;
+    m_unusedSizes = 0;
+}
+
+void GeometryStore::reserve(size_t _slots) {
+    m_records.reserve(_slots);
+}
+
+void GeometryStore::clear() {
+    m_records.clear();
+    m_x.clear();
+    m_y.clear();
+    m_sizes.clear();
+    m_unusedCoords = 0;
+    m_unusedSizes = 0;
+}
+
+void GeometryStore::shrinkToFit() {
+    m_records.shrink_to_fit();
+    m_x.shrink_to_fit();
+    m_y.shrink_to_fit();
+    m_sizes.shrink_to_fit();
+}
+
+size_t GeometryStore::memoryUsage() const {
+    return m_records.capacity() * sizeof(Record) +
+        (m_x.capacity() + m_y.capacity()) * sizeof(int32_t) +
+        m_sizes.capacity() * sizeof(uint32_t);
+}
+
+uint32_t PropertyStore::add(Properties&& _props) {
+
+    size_t h = hash(_props);
+
+    auto range = m_index.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto& entry = m_entries[it->second];
+        if (equal(entry.props, _props)) {
+            entry.refs++;
+            return it->second;
+        }
+    }
+
+    uint32_t id;
+    if (m_free.empty()) {
+        id = m_entries.size();
+        m_entries.emplace_back();
+    } else {
+        id = m_free.back();
+        m_free.pop_back();
+    }
+
+    auto& entry = m_entries[id];
+    entry.props = std::move(_props);
+    entry.hash = h;
+    entry.refs = 1;
+
+    m_index.emplace(h, id);
+
+    return id;
+}
+
+void PropertyStore::release(uint32_t _id) {
+
+    auto& entry = m_entries[_id];
+    if (--entry.refs > 0) { return; }
+
+    auto range = m_index.equal_range(entry.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == _id) {
+            m_index.erase(it);
+            break;
+        }
+    }
+
+    entry.props = Properties();
+    m_free.push_back(_id);
+}
+
+void PropertyStore::clear() {
+    m_entries.clear();
+    m_free.clear();
+    m_index.clear();
+}
+
+size_t PropertyStore::hash(const Properties& _props) {
+    size_t seed = 0;
+    for (auto& item : _props.items()) {
+        hash_combine(seed, item.key);
+        if (item.value.is<double>()) {
+            hash_combine(seed, item.value.get<double>());
+        } else if (item.value.is<std::string>()) {
+            hash_combine(seed, item.value.get<std::string>());
+        }
+    }
+    return seed;
+}
+
+bool PropertyStore::equal(const Properties& _a, const Properties& _b) {
+    auto& a = _a.items();
+    auto& b = _b.items();
+    if (a.size() != b.size()) { return false; }
+
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].key != b[i].key || !(a[i].value == b[i].value)) { return false; }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "data/properties.h"
+
+#include "mapbox/geometry.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Tangram {
+
+// Compact storage for the geometries of client features.
+//
+// Coordinates are quantized to 1e-7 degrees, well below the resolution of
+// the tiles cut from them, and kept in shared arrays instead of one vector
+// per line or ring. Replaced and removed geometries leave unused ranges in
+// the arrays, which are reclaimed once they make up half of the arrays.
+class GeometryStore {
+
+public:
+
+    using Geometry = mapbox::geometry::geometry<double>;
+
+    // Set the geometry of _slot. Appends a slot when _slot is size().
+    void set(size_t _slot, const Geometry& _geometry);
+
+    Geometry get(size_t _slot) const;
+
+    // Drop the geometry of _slot, the slot stays empty
+    void remove(size_t _slot);
+
+    // Drop the slots marked in _erase, keeping the order of the others
+    void eraseSlots(const std::vector<bool>& _erase);
+
+    size_t size() const { return m_records.size(); }
+
+    void reserve(size_t _slots);
+
+    void clear();
+
+    void shrinkToFit();
+
+    size_t memoryUsage() const;
+
+private:
+
+    enum class Type : uint8_t {
+        empty,
+        point,
+        line_string,
+        polygon,
+        multi_point,
+        multi_line_string,
+        multi_polygon,
+    };
+
+    struct Record {
+        Type type = Type::empty;
+        // Range in m_x and m_y
+        uint32_t coords = 0;
+        uint32_t numCoords = 0;
+        // Range in m_sizes: number of points, rings or parts
+        uint32_t sizes = 0;
+        uint32_t numSizes = 0;
+    };
+
+    struct Encoder;
+    struct Decoder;
+
+    void release(const Record& _record);
+
+    void compact();
+
+    std::vector<Record> m_records;
+    std::vector<int32_t> m_x;
+    std::vector<int32_t> m_y;
+    std::vector<uint32_t> m_sizes;
+
+    size_t m_unusedCoords = 0;
+    size_t m_unusedSizes = 0;
+};
+
+// Properties of client features, deduplicated by content. Features with the
+// same properties refer to one shared entry.
+class PropertyStore {
+
+public:
+
+    // Returns the id of the entry for _props, which holds a reference
+    // until release() is called.
+    uint32_t add(Properties&& _props);
+
+    void release(uint32_t _id);
+
+    const Properties& get(uint32_t _id) const { return m_entries[_id].props; }
+
+    // Number of distinct properties
+    size_t size() const { return m_entries.size() - m_free.size(); }
+
+    void clear();
+
+private:
+
+    static size_t hash(const Properties& _props);
+
+    static bool equal(const Properties& _a, const Properties& _b);
+
+    struct Entry {
+        Properties props;
+        size_t hash = 0;
+        uint32_t refs = 0;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_free;
+    std::unordered_multimap<size_t, uint32_t> m_index;
+};
+
+}
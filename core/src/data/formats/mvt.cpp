@@ -327,7 +327,7 @@ std::shared_ptr<TileData> Mvt::parseTile(const TileTask& _task, int32_t _sourceI
 
     auto& task = static_cast<const BinaryTileTask&>(_task);
 
-    protobuf::message item(task.rawTileData->data(), task.rawTileData->size());
+    protobuf::message item(task.rawTileData.data(), task.rawTileData.size());
     ParserContext ctx(_sourceId);
 
     try {
@@ -1,17 +1,35 @@
 #include "data/mbtilesDataSource.h"
 
 #include "util/asyncWorker.h"
+#include "util/mapProjection.h"
+#include "util/rasterize.h"
 #include "util/zlibHelper.h"
 #include "log.h"
 #include "platform.h"
 #include "util/url.h"
 
 #include <SQLiteCpp/Database.h>
+#include <SQLiteCpp/Transaction.h>
 #include "hash-library/md5.cpp"
 
+#include <algorithm>
+#include <chrono>
+
 
 namespace Tangram {
 
+// Number of read-only connections
+static const size_t MAX_READERS = 4;
+
+// Default time to collect stored tiles before writing them
+static const uint32_t DEFAULT_FLUSH_INTERVAL_MS = 1000;
+
+// Write stored tiles early when this many are pending
+static const size_t MAX_WRITE_BATCH = 256;
+
+// Concurrent downloads when seeding a region
+static const size_t MAX_SEED_REQUESTS = 8;
+
 /**
  * The schema.sql used to set up an MBTiles Database.
  *
@@ -99,22 +117,113 @@ CREATE VIEW IF NOT EXISTS grid_data AS
 COMMIT;)SQL_ESC";
 
 struct MBTilesQueries {
-    // SELECT statement from tiles view
-    SQLite::Statement getTileData;
-
     // REPLACE INTO statement in map table
     SQLite::Statement putMap;
 
-    // REPLACE INTO statement in images table
+    // INSERT statement in images table, tiles with the same data share one entry
     SQLite::Statement putImage;
 
     MBTilesQueries(SQLite::Database& _db, bool _cache)
-        : getTileData(_db, "SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?;"),
-          putMap(_db, _cache ? "REPLACE INTO map (zoom_level, tile_column, tile_row, tile_id) VALUES (?, ?, ?, ?);" : ";" ),
-          putImage(_db, _cache ? "REPLACE INTO images (tile_id, tile_data) VALUES (?, ?);" : ";") {}
+        : putMap(_db, _cache ? "REPLACE INTO map (zoom_level, tile_column, tile_row, tile_id) VALUES (?, ?, ?, ?);" : ";" ),
+          putImage(_db, _cache ? "INSERT OR IGNORE INTO images (tile_id, tile_data) VALUES (?, ?);" : ";") {}
+
+};
+
+struct MBTilesReader {
+    SQLite::Database db;
+    // SELECT statement from tiles view
+    SQLite::Statement getTileData;
+    // SELECT statement from map table
+    SQLite::Statement hasTile;
+    // Declared last to stop the thread before closing the connection
+    AsyncWorker worker;
+
+    MBTilesReader(const std::string& _path, const char* _vfs, bool _cache)
+        : db(_path, SQLite::OPEN_READONLY | SQLite::OPEN_NOMUTEX, 0, _vfs),
+          getTileData(db, "SELECT tile_data FROM tiles WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?;"),
+          hasTile(db, _cache ? "SELECT 1 FROM map WHERE zoom_level = ? AND tile_column = ? AND tile_row = ?;" : ";") {}
+};
+
+struct MBTilesDataSource::Lifetime {
+    std::mutex mutex;
+    std::condition_variable idle;
+    bool alive = true;
+    size_t active = 0;
+
+    // Keeps the data source alive for the lifetime of the scope, unless
+    // it is already being destroyed
+    class Scope {
+    public:
+        explicit Scope(Lifetime& _lifetime) : m_lifetime(_lifetime) {
+            std::lock_guard<std::mutex> lock(m_lifetime.mutex);
+            m_entered = m_lifetime.alive;
+            if (m_entered) { m_lifetime.active++; }
+        }
+        ~Scope() {
+            if (!m_entered) { return; }
+            std::lock_guard<std::mutex> lock(m_lifetime.mutex);
+            if (--m_lifetime.active == 0) { m_lifetime.idle.notify_all(); }
+        }
+        explicit operator bool() const { return m_entered; }
+    private:
+        Lifetime& m_lifetime;
+        bool m_entered;
+    };
+
+    // Wait for active scopes to finish and refuse new ones
+    void end() {
+        std::unique_lock<std::mutex> lock(mutex);
+        alive = false;
+        idle.wait(lock, [&]{ return active == 0; });
+    }
+};
+
+struct MBTilesDataSource::Seeding {
+    std::weak_ptr<TileSource> source;
+    SeedCallback callback;
+
+    std::vector<TileID> tiles;
+    size_t next = 0;
+    SeedProgress progress;
+    bool canceled = false;
 
+    std::mutex mutex;
 };
 
+std::vector<TileID> MBTilesDataSource::tilesInRegion(const std::vector<std::vector<LngLat>>& _polygon,
+                                                     int _minZoom, int _maxZoom) {
+    std::vector<TileID> tiles;
+
+    for (int z = _minZoom; z <= _maxZoom; z++) {
+        double metersPerTile = MapProjection::metersPerTileAtZoom(z);
+        int maxTileIndex = 1 << z;
+
+        std::vector<std::vector<glm::dvec2>> polygon;
+        for (auto& ring : _polygon) {
+            polygon.emplace_back();
+            for (auto& lngLat : ring) {
+                LngLat clamped(lngLat.longitude,
+                               glm::clamp(lngLat.latitude, -MapProjection::MAX_LATITUDE_DEGREES,
+                                          MapProjection::MAX_LATITUDE_DEGREES));
+                auto meters = MapProjection::lngLatToProjectedMeters(clamped);
+                polygon.back().emplace_back(
+                    (meters.x + MapProjection::EARTH_HALF_CIRCUMFERENCE_METERS) / metersPerTile,
+                    (MapProjection::EARTH_HALF_CIRCUMFERENCE_METERS - meters.y) / metersPerTile);
+            }
+        }
+
+        size_t first = tiles.size();
+        Rasterize::scanPolygon(polygon, 0, maxTileIndex, [&](int x, int y) {
+                if (x >= 0 && x < maxTileIndex) { tiles.emplace_back(x, y, z); }
+            });
+
+        // Triangles of the polygon share tiles
+        std::sort(tiles.begin() + first, tiles.end());
+        tiles.erase(std::unique(tiles.begin() + first, tiles.end()), tiles.end());
+    }
+    return tiles;
+}
+
 MBTilesDataSource::MBTilesDataSource(Platform& _platform, std::string _name, std::string _path,
                                      std::string _mime, bool _cache, bool _offlineFallback)
     : m_name(_name),
@@ -122,14 +231,214 @@ MBTilesDataSource::MBTilesDataSource(Platform& _platform, std::string _name, std
       m_mime(_mime),
       m_cacheMode(_cache),
       m_offlineMode(_offlineFallback),
+      m_lifetime(std::make_shared<Lifetime>()),
+      m_flushInterval(DEFAULT_FLUSH_INTERVAL_MS),
       m_platform(_platform) {
 
-    m_worker = std::make_unique<AsyncWorker>();
-
     openMBTiles();
+
+    if (m_db && m_cacheMode) {
+        m_writerRunning = true;
+        m_writer = std::thread(&MBTilesDataSource::writeLoop, this);
+    }
 }
 
 MBTilesDataSource::~MBTilesDataSource() {
+
+    // Downloads of the seeded region that complete later are dropped
+    cancelSeeding();
+
+    // Callbacks that arrive later return without using the readers
+    m_lifetime->end();
+
+    // Finish pending reads before the pending writes
+    m_readers.clear();
+
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            m_writerRunning = false;
+        }
+        m_writeCondition.notify_all();
+        m_writer.join();
+    }
+}
+
+void MBTilesDataSource::setFlushInterval(uint32_t _milliseconds) {
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_flushInterval = _milliseconds;
+    }
+    m_writeCondition.notify_all();
+}
+
+void MBTilesDataSource::flush() {
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        m_flushRequested = true;
+    }
+    m_writeCondition.notify_all();
+}
+
+void MBTilesDataSource::readTile(std::shared_ptr<TileTask> _task, std::function<void(bool)> _cb) {
+
+    auto& reader = *m_readers[m_nextReader++ % m_readers.size()];
+
+    reader.worker.enqueue([this, lifetime = m_lifetime, &reader, _task, _cb](){
+        Lifetime::Scope scope(*lifetime);
+        if (!scope) { return; }
+
+        auto& task = static_cast<BinaryTileTask&>(*_task);
+        task.rawTileData.reset();
+
+        if (!getPendingTileData(_task->tileId(), task.rawTileData)) {
+            std::vector<char> data;
+            getTileData(reader, _task->tileId(), data);
+            task.rawTileData = ByteBuffer(std::move(data));
+        }
+        _cb(task.hasData());
+    });
+}
+
+bool MBTilesDataSource::seedRegion(std::shared_ptr<TileSource> _source,
+                                   const std::vector<std::vector<LngLat>>& _polygon,
+                                   int _minZoom, int _maxZoom, SeedCallback _cb) {
+
+    if (!m_db || !m_cacheMode || !next) {
+        LOGE("Cannot seed MBTiles database without cache and next source: %s", m_path.c_str());
+        return false;
+    }
+
+    auto seeding = std::make_shared<Seeding>();
+    seeding->source = _source;
+    seeding->callback = std::move(_cb);
+
+    {
+        std::lock_guard<std::mutex> lock(m_seedingMutex);
+        if (m_seeding) {
+            std::lock_guard<std::mutex> seedingLock(m_seeding->mutex);
+            if (!m_seeding->canceled && !m_seeding->progress.done()) {
+                LOGE("MBTiles database is already being seeded: %s", m_path.c_str());
+                return false;
+            }
+        }
+        m_seeding = seeding;
+    }
+
+    int maxZoom = std::min(_maxZoom, _source->maxZoom());
+    int minZoom = std::max(_minZoom, 0);
+
+    auto& reader = *m_readers[m_nextReader++ % m_readers.size()];
+
+    reader.worker.enqueue([this, lifetime = m_lifetime, &reader, seeding, _polygon, minZoom, maxZoom](){
+        Lifetime::Scope scope(*lifetime);
+        if (!scope) { return; }
+
+        auto tiles = missingTiles(reader, tilesInRegion(_polygon, minZoom, maxZoom));
+
+        SeedProgress progress;
+        {
+            std::lock_guard<std::mutex> lock(seeding->mutex);
+            seeding->tiles = std::move(tiles);
+            seeding->progress.total = seeding->tiles.size();
+            progress = seeding->progress;
+        }
+
+        LOG("Seeding %d tiles of %s", int(progress.total), m_path.c_str());
+
+        if (progress.done()) {
+            if (seeding->callback) { seeding->callback(progress); }
+            return;
+        }
+
+        for (size_t i = 0; i < MAX_SEED_REQUESTS; i++) {
+            seedNext(seeding);
+        }
+    });
+
+    return true;
+}
+
+void MBTilesDataSource::cancelSeeding() {
+    std::lock_guard<std::mutex> lock(m_seedingMutex);
+    if (!m_seeding) { return; }
+
+    std::lock_guard<std::mutex> seedingLock(m_seeding->mutex);
+    m_seeding->canceled = true;
+}
+
+std::vector<TileID> MBTilesDataSource::missingTiles(MBTilesReader& _reader, const std::vector<TileID>& _tiles) {
+
+    std::vector<TileID> missing;
+    auto& stmt = _reader.hasTile;
+
+    for (auto& tileId : _tiles) {
+        bool found = false;
+        try {
+            int y = (1 << tileId.z) - 1 - tileId.y;
+            stmt.bind(1, tileId.z);
+            stmt.bind(2, tileId.x);
+            stmt.bind(3, y);
+            found = stmt.executeStep();
+            stmt.reset();
+
+        } catch (std::exception& e) {
+            LOGE("MBTiles SQLite select map statement failed: %s", e.what());
+            try {
+                stmt.reset();
+            } catch(...) {}
+        }
+        if (!found) { missing.push_back(tileId); }
+    }
+    return missing;
+}
+
+void MBTilesDataSource::seedNext(std::shared_ptr<Seeding> _seeding) {
+
+    TileID tileId(0, 0, 0);
+    {
+        std::lock_guard<std::mutex> lock(_seeding->mutex);
+        if (_seeding->canceled || _seeding->next == _seeding->tiles.size()) { return; }
+        tileId = _seeding->tiles[_seeding->next++];
+    }
+
+    auto source = _seeding->source.lock();
+    if (!source) { return; }
+
+    auto task = std::make_shared<BinaryTileTask>(tileId, source);
+    task->rawSource = next->level;
+
+    TileTaskCb cb{[this, lifetime = m_lifetime, _seeding](std::shared_ptr<TileTask> _task) {
+        Lifetime::Scope scope(*lifetime);
+        if (!scope) { return; }
+
+        bool stored = _task->hasData();
+        if (stored) { enqueueWrite(_task); }
+
+        SeedProgress progress;
+        {
+            std::lock_guard<std::mutex> lock(_seeding->mutex);
+            if (stored) {
+                _seeding->progress.stored++;
+            } else {
+                _seeding->progress.failed++;
+            }
+            progress = _seeding->progress;
+        }
+        if (_seeding->callback) { _seeding->callback(progress); }
+
+        // Start the next download from a reader thread, sources may
+        // call back before loadTileData returns.
+        auto& reader = *m_readers[m_nextReader++ % m_readers.size()];
+        reader.worker.enqueue([this, lifetime, _seeding]() {
+                Lifetime::Scope scope(*lifetime);
+                if (scope) { seedNext(_seeding); }
+            });
+    }};
+
+    if (!next->loadTileData(task, cb)) {
+        cb.func(task);
+    }
 }
 
 bool MBTilesDataSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) {
@@ -147,16 +456,12 @@ bool MBTilesDataSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb
 
     if (_task->rawSource == this->level) {
 
-        m_worker->enqueue([this, _task, _cb](){
+        readTile(_task, [this, _task, _cb](bool _hasData){
             TileID tileId = _task->tileId();
 
-            auto& task = static_cast<BinaryTileTask&>(*_task);
-            task.rawTileData = std::make_shared<std::vector<char>>();
-
-            getTileData(tileId, *task.rawTileData);
-
-            if (task.hasData()) {
-                LOGW("loaded tile: %s, %d", tileId.toString().c_str(), task.rawTileData->size());
+            if (_hasData) {
+                auto& task = static_cast<BinaryTileTask&>(*_task);
+                LOGW("loaded tile: %s, %d", tileId.toString().c_str(), task.rawTileData.size());
 
                 _cb.func(_task);
 
@@ -189,19 +494,18 @@ bool MBTilesDataSource::loadNextSource(std::shared_ptr<TileTask> _task, TileTask
     }
 
     // Intercept TileTaskCb to store result from next source.
-    TileTaskCb cb{[this, _cb](std::shared_ptr<TileTask> _task) {
+    TileTaskCb cb{[this, lifetime = m_lifetime, _cb](std::shared_ptr<TileTask> _task) {
+
+        Lifetime::Scope scope(*lifetime);
+        if (!scope) {
+            _cb.func(_task);
+            return;
+        }
 
         if (_task->hasData()) {
 
             if (m_cacheMode) {
-                m_worker->enqueue([this, _task](){
-
-                        auto& task = static_cast<BinaryTileTask&>(*_task);
-
-                        LOGW("store tile: %s, %d", _task->tileId().toString().c_str(), task.hasData());
-
-                        storeTileData(_task->tileId(), *task.rawTileData);
-                    });
+                enqueueWrite(_task);
             }
 
             _cb.func(_task);
@@ -209,17 +513,12 @@ bool MBTilesDataSource::loadNextSource(std::shared_ptr<TileTask> _task, TileTask
         } else if (m_offlineMode) {
             LOGW("try fallback tile: %s, %d", _task->tileId().toString().c_str());
 
-            m_worker->enqueue([this, _task, _cb](){
+            readTile(_task, [_task, _cb](bool _hasData){
 
                 auto& task = static_cast<BinaryTileTask&>(*_task);
-                task.rawTileData = std::make_shared<std::vector<char>>();
-
-                getTileData(_task->tileId(), *task.rawTileData);
-
-                LOGW("loaded tile: %s, %d", _task->tileId().toString().c_str(), task.rawTileData->size());
+                LOGW("loaded tile: %s, %d", _task->tileId().toString().c_str(), task.rawTileData.size());
 
                 _cb.func(_task);
-
             });
         } else {
             LOGW("missing tile: %s, %d", _task->tileId().toString().c_str());
@@ -263,7 +562,6 @@ void MBTilesDataSource::openMBTiles() {
             LOGE("Cannot cache to 'externally created' MBTiles database");
             // Run in non-caching mode
             m_cacheMode = false;
-            return;
         }
     } else if (m_cacheMode) {
 
@@ -288,12 +586,45 @@ void MBTilesDataSource::openMBTiles() {
     }
 
     try {
+        if (m_cacheMode) {
+            // Let the readers continue while tiles are written
+            m_db->exec("PRAGMA journal_mode=WAL;");
+            m_db->exec("PRAGMA synchronous=NORMAL;");
+        }
         m_queries = std::make_unique<MBTilesQueries>(*m_db, m_cacheMode);
     } catch (std::exception& e) {
         LOGE("Unable to initialize queries: %s", e.what());
         m_db.reset();
         return;
     }
+
+    auto url = Url(m_path);
+    auto path = url.path();
+    const char* vfs = "";
+    if (url.scheme() == "asset") {
+        vfs = "ndk-asset";
+        path.erase(path.begin());
+    }
+    openReaders(path, vfs);
+
+    if (m_readers.empty()) {
+        m_db.reset();
+        return;
+    }
+}
+
+void MBTilesDataSource::openReaders(const std::string& _path, const char* _vfs) {
+
+    size_t numReaders = std::max<size_t>(1, std::min<size_t>(MAX_READERS, std::thread::hardware_concurrency()));
+
+    for (size_t i = 0; i < numReaders; i++) {
+        try {
+            m_readers.push_back(std::make_unique<MBTilesReader>(_path, _vfs, m_cacheMode));
+        } catch (std::exception& e) {
+            LOGE("Unable to open SQLite database reader: %s - %s", m_path.c_str(), e.what());
+            break;
+        }
+    }
 }
 
 /**
@@ -422,9 +753,27 @@ void MBTilesDataSource::initSchema(SQLite::Database& db, std::string _name, std:
     }
 }
 
-bool MBTilesDataSource::getTileData(const TileID& _tileId, std::vector<char>& _data) {
+bool MBTilesDataSource::getPendingTileData(const TileID& _tileId, ByteBuffer& _data) {
+
+    if (!m_cacheMode) { return false; }
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
 
-    auto& stmt = m_queries->getTileData;
+    for (auto* pending : { &m_writeQueue, &m_writeBatch }) {
+        // Newest entries last
+        auto it = std::find_if(pending->rbegin(), pending->rend(),
+                               [&](const PendingWrite& _write) { return _write.tileId == _tileId; });
+        if (it != pending->rend()) {
+            _data = it->data;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MBTilesDataSource::getTileData(MBTilesReader& _reader, const TileID& _tileId, std::vector<char>& _data) {
+
+    auto& stmt = _reader.getTileData;
     try {
         // Google TMS to WMTS
         // https://github.com/mapbox/node-mbtiles/blob/
@@ -471,7 +820,69 @@ bool MBTilesDataSource::getTileData(const TileID& _tileId, std::vector<char>& _d
     return false;
 }
 
-void MBTilesDataSource::storeTileData(const TileID& _tileId, const std::vector<char>& _data) {
+void MBTilesDataSource::enqueueWrite(std::shared_ptr<TileTask> _task) {
+
+    auto& task = static_cast<BinaryTileTask&>(*_task);
+
+    LOGW("store tile: %s, %d", _task->tileId().toString().c_str(), task.hasData());
+
+    size_t pending;
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        if (!m_writerRunning) { return; }
+
+        m_writeQueue.push_back({ _task->tileId(), task.rawTileData });
+        pending = m_writeQueue.size();
+    }
+    // Wake the writer for the first tile of a batch and for full batches
+    if (pending == 1 || pending >= MAX_WRITE_BATCH) {
+        m_writeCondition.notify_all();
+    }
+}
+
+void MBTilesDataSource::writeLoop() {
+
+    std::unique_lock<std::mutex> lock(m_writeMutex);
+
+    while (true) {
+        m_writeCondition.wait(lock, [&]{ return !m_writerRunning || !m_writeQueue.empty(); });
+
+        if (m_writeQueue.empty()) { break; }
+
+        // Collect tiles until the interval passed or the batch is full
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_flushInterval);
+        m_writeCondition.wait_until(lock, deadline, [&]{
+                return !m_writerRunning || m_flushRequested ||
+                    m_writeQueue.size() >= MAX_WRITE_BATCH;
+            });
+
+        m_flushRequested = false;
+        m_writeBatch.swap(m_writeQueue);
+
+        lock.unlock();
+        writeBatch();
+        lock.lock();
+
+        m_writeBatch.clear();
+    }
+}
+
+void MBTilesDataSource::writeBatch() {
+
+    try {
+        SQLite::Transaction transaction(*m_db);
+
+        for (auto& write : m_writeBatch) {
+            storeTileData(write.tileId, write.data);
+        }
+        transaction.commit();
+
+    } catch (std::exception& e) {
+        LOGE("MBTiles SQLite transaction failed: %s", e.what());
+    }
+}
+
+void MBTilesDataSource::storeTileData(const TileID& _tileId, const ByteBuffer& _data) {
     int z = _tileId.z;
     int y = (1 << z) - 1 - _tileId.y;
 
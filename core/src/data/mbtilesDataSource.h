@@ -1,6 +1,14 @@
 #pragma once
 
 #include "data/tileSource.h"
+#include "util/types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace SQLite {
 class Database;
@@ -12,11 +20,22 @@ namespace Tangram {
 class Platform;
 
 struct MBTilesQueries;
-class AsyncWorker;
+struct MBTilesReader;
 
 class MBTilesDataSource : public TileSource::DataSource {
 public:
 
+    struct SeedProgress {
+        // Tiles in the region that were not yet stored
+        size_t total = 0;
+        size_t stored = 0;
+        size_t failed = 0;
+
+        bool done() const { return stored + failed == total; }
+    };
+
+    using SeedCallback = std::function<void(const SeedProgress&)>;
+
     MBTilesDataSource(Platform& _platform, std::string _name, std::string _path, std::string _mime,
                       bool _cache = false, bool _offlineFallback = false);
 
@@ -26,12 +45,52 @@ public:
 
     void clear() override {}
 
+    // Set the time that stored tiles are collected before they are written
+    // in one transaction.
+    void setFlushInterval(uint32_t _milliseconds);
+
+    // Write all stored tiles now
+    void flush();
+
+    // Download all tiles of _source in the zoom range that cover _polygon, given
+    // as outer ring followed by holes, and store them. Tiles that are already
+    // stored are skipped, so that an interrupted download can be resumed by
+    // seeding the same region again. _cb is called on worker threads as tiles
+    // complete. Requires cache mode; only one region is seeded at a time.
+    bool seedRegion(std::shared_ptr<TileSource> _source,
+                    const std::vector<std::vector<LngLat>>& _polygon,
+                    int _minZoom, int _maxZoom, SeedCallback _cb);
+
+    // Stop starting new downloads of the current region
+    void cancelSeeding();
+
+    // Tiles at zoom _minZoom to _maxZoom covering _polygon
+    static std::vector<TileID> tilesInRegion(const std::vector<std::vector<LngLat>>& _polygon,
+                                             int _minZoom, int _maxZoom);
+
 private:
-    bool getTileData(const TileID& _tileId, std::vector<char>& _data);
-    void storeTileData(const TileID& _tileId, const std::vector<char>& _data);
+    bool getTileData(MBTilesReader& _reader, const TileID& _tileId, std::vector<char>& _data);
+    void storeTileData(const TileID& _tileId, const ByteBuffer& _data);
     bool loadNextSource(std::shared_ptr<TileTask> _task, TileTaskCb _cb);
 
+    // Load the tile of _task on one of the readers
+    void readTile(std::shared_ptr<TileTask> _task, std::function<void(bool)> _cb);
+
+    // Find tile data that is not yet written
+    bool getPendingTileData(const TileID& _tileId, ByteBuffer& _data);
+
+    struct Lifetime;
+
+    struct Seeding;
+    std::vector<TileID> missingTiles(MBTilesReader& _reader, const std::vector<TileID>& _tiles);
+    void seedNext(std::shared_ptr<Seeding> _seeding);
+
+    void enqueueWrite(std::shared_ptr<TileTask> _task);
+    void writeLoop();
+    void writeBatch();
+
     void openMBTiles();
+    void openReaders(const std::string& _path, const char* _vfs);
     bool testSchema(SQLite::Database& db);
     void initSchema(SQLite::Database& db, std::string _name, std::string _mimeType);
 
@@ -47,10 +106,36 @@ private:
     // Offline fallback: Try next source (download) first, then fall back to mbtiles
     bool m_offlineMode;
 
-    // Pointer to SQLite DB of MBTiles store
+    // Pointer to SQLite DB of MBTiles store, used for writing
     std::unique_ptr<SQLite::Database> m_db;
     std::unique_ptr<MBTilesQueries> m_queries;
-    std::unique_ptr<AsyncWorker> m_worker;
+
+    // Read-only connections, each with its own worker thread
+    std::vector<std::unique_ptr<MBTilesReader>> m_readers;
+    std::atomic<size_t> m_nextReader{0};
+
+    // Callbacks of the readers and of the next source may run while the
+    // data source is destroyed. They hold a Lifetime::Scope while they use it.
+    std::shared_ptr<Lifetime> m_lifetime;
+
+    struct PendingWrite {
+        TileID tileId;
+        ByteBuffer data;
+    };
+
+    // Tiles to be written by the writer thread. m_writeBatch holds the
+    // tiles of the transaction in progress.
+    std::vector<PendingWrite> m_writeQueue;
+    std::vector<PendingWrite> m_writeBatch;
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCondition;
+    std::thread m_writer;
+    bool m_writerRunning = false;
+    bool m_flushRequested = false;
+    uint32_t m_flushInterval;
+
+    std::shared_ptr<Seeding> m_seeding;
+    std::mutex m_seedingMutex;
 
     // Platform reference
     Platform& m_platform;
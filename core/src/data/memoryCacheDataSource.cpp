@@ -16,7 +16,7 @@ struct RawCache {
     std::mutex m_mutex;
 
     // LRU in-memory cache for raw tile data
-    using CacheEntry = std::pair<TileID, std::shared_ptr<std::vector<char>>>;
+    using CacheEntry = std::pair<TileID, ByteBuffer>;
     using CacheList = std::list<CacheEntry>;
     using CacheMap = std::unordered_map<TileID, typename CacheList::iterator>;
 
@@ -44,7 +44,7 @@ struct RawCache {
 
         return false;
     }
-    void put(const TileID& tileID, std::shared_ptr<std::vector<char>> rawDataRef) {
+    void put(const TileID& tileID, ByteBuffer rawDataRef) {
 
         if (m_maxUsage <= 0) { return; }
 
@@ -54,7 +54,7 @@ struct RawCache {
         m_cacheList.push_front({id, rawDataRef});
         m_cacheMap[id] = m_cacheList.begin();
 
-        m_usage += rawDataRef->size();
+        m_usage += rawDataRef.size();
 
         while (m_usage > m_maxUsage) {
             if (m_cacheList.empty()) {
@@ -67,7 +67,7 @@ struct RawCache {
             //        double(m_cacheUsage) / (1024*1024));
 
             auto& entry = m_cacheList.back();
-            m_usage -= entry.second->size();
+            m_usage -= entry.second.size();
 
             m_cacheMap.erase(entry.first);
             m_cacheList.pop_back();
@@ -97,7 +97,7 @@ bool MemoryCacheDataSource::cacheGet(BinaryTileTask& _task) {
     return m_cache->get(_task);
 }
 
-void MemoryCacheDataSource::cachePut(const TileID& _tileID, std::shared_ptr<std::vector<char>> _rawDataRef) {
+void MemoryCacheDataSource::cachePut(const TileID& _tileID, ByteBuffer _rawDataRef) {
     m_cache->put(_tileID, _rawDataRef);
 }
 
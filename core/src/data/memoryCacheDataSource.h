@@ -22,7 +22,7 @@ public:
 private:
     bool cacheGet(BinaryTileTask& _task);
 
-    void cachePut(const TileID& _tileID, std::shared_ptr<std::vector<char>> _rawDataRef);
+    void cachePut(const TileID& _tileID, ByteBuffer _rawDataRef);
 
     std::unique_ptr<RawCache> m_cache;
 
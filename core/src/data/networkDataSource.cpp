@@ -3,12 +3,48 @@
 #include "log.h"
 #include "platform.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Tangram {
 
+// Skip priority updates smaller than this
+static const double min_priority_change = 0.005;
+
+static const uint32_t default_min_requests = 2;
+static const uint32_t default_max_requests = 32;
+static const double initial_requests = 6;
+
+// Latency above this multiple of the base latency means requests are queued
+static const double max_latency_factor = 2.0;
+
+// Weight of new samples in moving averages
+static const double average_weight = 0.1;
+
 NetworkDataSource::NetworkDataSource(Platform& _platform, std::string url, UrlOptions options) :
     m_platform(_platform),
     m_urlTemplate(std::move(url)),
-    m_options(std::move(options)) {}
+    m_options(std::move(options)),
+    m_limit(initial_requests),
+    m_minLimit(default_min_requests),
+    m_maxLimit(default_max_requests),
+    m_rateStart(Clock::now()) {}
+
+void NetworkDataSource::setConcurrencyLimits(uint32_t _min, uint32_t _max) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_minLimit = std::max(_min, 1u);
+    m_maxLimit = std::max(_max, _min);
+    m_limit = std::min(std::max(m_limit, m_minLimit), m_maxLimit);
+}
+
+NetworkDataSource::Stats NetworkDataSource::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats = m_stats;
+    stats.limit = uint32_t(m_limit);
+    stats.active = m_activeRequests;
+    stats.pending = m_pending.size();
+    return stats;
+}
 
 std::string NetworkDataSource::tileCoordinatesToQuadKey(const TileID &tile) {
     std::string quadKey;
@@ -71,6 +107,16 @@ std::string NetworkDataSource::buildUrlForTile(const TileID& tile, const std::st
     return url;
 }
 
+double NetworkDataSource::requestPriority(const TileTask& _task) {
+    // Map distance priorities to [0, 1), preserving their order
+    double distance = std::log1p(std::max(_task.getPriority(), 0.0));
+    double priority = distance / (1.0 + distance);
+
+    if (_task.isProxy()) { priority += url_priority_background; }
+
+    return priority;
+}
+
 bool NetworkDataSource::loadTileData(std::shared_ptr<TileTask> task, TileTaskCb callback) {
 
     if (task->rawSource != this->level) {
@@ -78,14 +124,38 @@ bool NetworkDataSource::loadTileData(std::shared_ptr<TileTask> task, TileTaskCb
         return false;
     }
 
-    auto tileId = task->tileId();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_activeRequests >= uint32_t(m_limit)) {
+            // Started by onRequestFinished, in order of priority
+            m_pending.push_back({ std::move(task), std::move(callback) });
+            return true;
+        }
+        m_activeRequests++;
+    }
 
-    Url url(buildUrlForTile(tileId, m_urlTemplate, m_options, m_urlSubdomainIndex));
+    startRequest(std::move(task), std::move(callback));
 
-    if (!m_options.subdomains.empty()) {
-        m_urlSubdomainIndex = (m_urlSubdomainIndex + 1) % m_options.subdomains.size();
+    return true;
+}
+
+void NetworkDataSource::startRequest(std::shared_ptr<TileTask> task, TileTaskCb callback) {
+
+    auto tileId = task->tileId();
+
+    int subdomainIndex = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        subdomainIndex = m_urlSubdomainIndex;
+        if (!m_options.subdomains.empty()) {
+            m_urlSubdomainIndex = (m_urlSubdomainIndex + 1) % m_options.subdomains.size();
+        }
     }
 
+    Url url(buildUrlForTile(tileId, m_urlTemplate, m_options, subdomainIndex));
+
+    auto start = Clock::now();
+
     LOGTInit(">>> %s", task->tileId().toString().c_str());
     UrlCallback onRequestFinish = [=](UrlResponse&& response) mutable {
         auto source = task->source();
@@ -95,6 +165,9 @@ bool NetworkDataSource::loadTileData(std::shared_ptr<TileTask> task, TileTaskCb
         }
         LOGT("<<< %s -- canceled:%d", task->tileId().toString().c_str(), task->isCanceled());
 
+        auto& dlTask = static_cast<BinaryTileTask&>(*task);
+        onRequestFinished(response, start, dlTask);
+
         if (task->isCanceled()) {
             return;
         }
@@ -103,26 +176,150 @@ bool NetworkDataSource::loadTileData(std::shared_ptr<TileTask> task, TileTaskCb
             LOGD("URL request '%s': %s", url.string().c_str(), response.error);
 
         } else if (!response.content.empty()) {
-            auto& dlTask = static_cast<BinaryTileTask&>(*task);
-            dlTask.rawTileData = std::make_shared<std::vector<char>>(std::move(response.content));
+            dlTask.rawTileData = ByteBuffer(std::move(response.content));
         }
         callback.func(std::move(task));
     };
 
     auto& dlTask = static_cast<BinaryTileTask&>(*task);
-    dlTask.urlRequestHandle = m_platform.startUrlRequest(url, std::move(onRequestFinish));
-    dlTask.urlRequestStarted = true;
+    double priority = requestPriority(*task);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dlTask.urlRequestPriority = priority;
+        dlTask.urlRequestStarted = true;
+        dlTask.urlRequestHandle = 0;
+    }
 
-    return true;
+    auto handle = m_platform.startUrlRequest(url, std::move(onRequestFinish), priority);
+
+    bool canceled = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dlTask.urlRequestHandle = handle;
+        // cancelLoadingTile could not abort the request without its handle
+        canceled = !dlTask.urlRequestStarted;
+    }
+    if (canceled) { m_platform.cancelUrlRequest(handle); }
+}
+
+void NetworkDataSource::onRequestFinished(const UrlResponse& _response, Clock::time_point _start,
+                                          const BinaryTileTask& _task) {
+
+    std::vector<PendingTask> start;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_activeRequests--;
+
+        auto now = Clock::now();
+
+        // cancelLoadingTile unsets urlRequestStarted before the task is canceled
+        bool canceled = _task.isCanceled() || !_task.urlRequestStarted;
+
+        if (!canceled) {
+            double latencyMs = std::chrono::duration<double, std::milli>(now - _start).count();
+
+            // Servers ask to slow down with 429 and 503 or stop responding in time.
+            // Other errors without status, e.g. an unreachable host, are failures.
+            bool overloaded = _response.error &&
+                (_response.status == 429 || _response.status == 503 || _response.timedOut);
+
+            if (overloaded) {
+                m_stats.throttled++;
+                // Decrease once for all requests that were in flight at the last decrease
+                if (_start > m_lastDecrease) {
+                    m_limit = std::max(m_limit * 0.5, m_minLimit);
+                    m_lastDecrease = now;
+                    LOGD("Reduce concurrent requests for '%s' to %d", m_urlTemplate.c_str(), int(m_limit));
+                }
+            } else if (_response.error) {
+                m_stats.failed++;
+
+            } else {
+                m_stats.completed++;
+                m_stats.latencyMs += (latencyMs - m_stats.latencyMs) * average_weight;
+
+                // Let the base latency recover slowly, e.g. after changing networks
+                if (m_baseLatencyMs == 0 || latencyMs < m_baseLatencyMs) {
+                    m_baseLatencyMs = latencyMs;
+                } else {
+                    m_baseLatencyMs += (latencyMs - m_baseLatencyMs) * average_weight * 0.1;
+                }
+
+                // Grow only while requests are waiting and responses are not delayed
+                bool saturated = !m_pending.empty() || m_activeRequests + 1 >= uint32_t(m_limit);
+                if (saturated && latencyMs < m_baseLatencyMs * max_latency_factor) {
+                    m_limit = std::min(m_limit + 1.0 / m_limit, m_maxLimit);
+                }
+
+                m_rateBytes += _response.content.size();
+            }
+        }
+
+        // Update the download rate about once per second
+        double elapsed = std::chrono::duration<double>(now - m_rateStart).count();
+        if (elapsed >= 1.0) {
+            m_stats.bytesPerSecond += (m_rateBytes / elapsed - m_stats.bytesPerSecond) * 0.5;
+            m_rateBytes = 0;
+            m_rateStart = now;
+        }
+
+        while (!m_pending.empty() && m_activeRequests < uint32_t(m_limit)) {
+            // Most urgent first, priorities change while tasks wait
+            auto next = std::min_element(m_pending.begin(), m_pending.end(),
+                                         [](auto& a, auto& b) {
+                                             return requestPriority(*a.task) < requestPriority(*b.task);
+                                         });
+            start.push_back(std::move(*next));
+            m_pending.erase(next);
+            m_activeRequests++;
+        }
+    }
+
+    for (auto& pending : start) {
+        startRequest(std::move(pending.task), std::move(pending.callback));
+    }
 }
 
 void NetworkDataSource::cancelLoadingTile(TileTask& task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_pending.begin(), m_pending.end(),
+                               [&](auto& pending) { return pending.task.get() == &task; });
+        if (it != m_pending.end()) {
+            m_pending.erase(it);
+            return;
+        }
+    }
+
     auto& dlTask = static_cast<BinaryTileTask&>(task);
-    if (dlTask.urlRequestStarted) {
+    UrlRequestHandle handle = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!dlTask.urlRequestStarted) { return; }
+
         dlTask.urlRequestStarted = false;
+        // Without a handle the request is still starting: startRequest cancels it
+        handle = dlTask.urlRequestHandle;
+    }
+
+    if (handle != 0) {
+        m_platform.cancelUrlRequest(handle);
+    }
+}
+
+void NetworkDataSource::updateTilePriority(TileTask& task) {
+    auto& dlTask = static_cast<BinaryTileTask&>(task);
+    double priority = requestPriority(task);
+    UrlRequestHandle handle = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!dlTask.urlRequestStarted || dlTask.urlRequestHandle == 0) { return; }
+        if (std::abs(priority - dlTask.urlRequestPriority) < min_priority_change) { return; }
 
-        m_platform.cancelUrlRequest(dlTask.urlRequestHandle);
+        dlTask.urlRequestPriority = priority;
+        handle = dlTask.urlRequestHandle;
     }
+    m_platform.setUrlRequestPriority(handle, priority);
 }
 
 }
@@ -2,6 +2,9 @@
 
 #include "data/tileSource.h"
 
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <unordered_map>
 
 namespace Tangram {
@@ -16,12 +19,33 @@ public:
         bool isTms = false;
     };
 
+    // Download statistics of this source
+    struct Stats {
+        // Current limit of concurrent requests
+        uint32_t limit = 0;
+        uint32_t active = 0;
+        uint32_t pending = 0;
+        uint64_t completed = 0;
+        uint64_t failed = 0;
+        // Responses that asked to slow down (429, 503) or timed out
+        uint64_t throttled = 0;
+        // Moving averages of request latency and download rate
+        double latencyMs = 0;
+        double bytesPerSecond = 0;
+    };
+
     NetworkDataSource(Platform& _platform, std::string url, UrlOptions options);
 
     bool loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) override;
 
     void cancelLoadingTile(TileTask& _task) override;
 
+    void updateTilePriority(TileTask& _task) override;
+
+    /// Returns the URL request priority for _task: Visible tiles come first,
+    /// ordered by TileTask::getPriority, proxy tiles are background requests.
+    static double requestPriority(const TileTask& _task);
+
     static std::string tileCoordinatesToQuadKey(const TileID& tile);
 
     /// Returns true if the URL either contains 'x', 'y', and 'z' placeholders or contains a 'q' placeholder.
@@ -33,8 +57,27 @@ public:
 
     const std::string& getUrlTemplate() const { return m_urlTemplate;}
 
+    // Bounds for the adaptive number of concurrent requests
+    void setConcurrencyLimits(uint32_t _min, uint32_t _max);
+
+    Stats getStats() const;
+
 private:
 
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingTask {
+        std::shared_ptr<TileTask> task;
+        TileTaskCb callback;
+    };
+
+    void startRequest(std::shared_ptr<TileTask> _task, TileTaskCb _callback);
+
+    // Adapt the concurrency limit to a finished request of _task and start
+    // pending requests that now fit in
+    void onRequestFinished(const UrlResponse& _response, Clock::time_point _start,
+                           const BinaryTileTask& _task);
+
     Platform& m_platform;
 
     std::string m_urlTemplate;
@@ -42,6 +85,27 @@ private:
     UrlOptions m_options;
 
     int m_urlSubdomainIndex = 0;
+
+    // Additive increase, multiplicative decrease of the concurrent
+    // requests: The limit grows by one per limit requests that complete
+    // without queueing delay and halves when the server is overloaded.
+    double m_limit;
+    double m_minLimit;
+    double m_maxLimit;
+    // Requests started before are not taken into account for decreasing
+    Clock::time_point m_lastDecrease;
+    // Smallest recent latency, the latency without queueing
+    double m_baseLatencyMs = 0;
+
+    uint32_t m_activeRequests = 0;
+    std::deque<PendingTask> m_pending;
+
+    Stats m_stats;
+    Clock::time_point m_rateStart;
+    uint64_t m_rateBytes = 0;
+
+    // Also guards the URL request state of the BinaryTileTasks
+    mutable std::mutex m_mutex;
 };
 
 }
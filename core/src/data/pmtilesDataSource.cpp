@@ -0,0 +1,325 @@
+#include "data/pmtilesDataSource.h"
+
+#include "util/asyncWorker.h"
+#include "util/url.h"
+#include "util/zlibHelper.h"
+#include "log.h"
+#include "platform.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Tangram {
+
+static const size_t HEADER_LENGTH = 127;
+
+// Leaf directories can be nested this deep below the root directory
+static const int MAX_DIRECTORY_DEPTH = 3;
+
+// Decoded leaf directories to keep
+static const size_t MAX_LEAF_DIRECTORIES = 256;
+
+static uint64_t readUint64(const char* _data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | uint8_t(_data[i]);
+    }
+    return value;
+}
+
+static bool readVarint(const char*& _pos, const char* _end, uint64_t& _value) {
+    _value = 0;
+    for (int shift = 0; shift < 64 && _pos < _end; shift += 7) {
+        uint8_t byte = *_pos++;
+        _value |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) { return true; }
+    }
+    return false;
+}
+
+PMTilesDataSource::PMTilesDataSource(std::string _name, std::string _path)
+    : m_name(_name),
+      m_path(_path) {
+
+    m_worker = std::make_unique<AsyncWorker>();
+
+    if (!open()) { close(); }
+}
+
+PMTilesDataSource::~PMTilesDataSource() {
+    // Stop reading before the archive is unmapped
+    m_worker.reset();
+    close();
+}
+
+uint64_t PMTilesDataSource::hilbertTileId(const TileID& _tileId) {
+
+    // Tiles of all lower zoom levels come first
+    uint64_t id = ((uint64_t(1) << (2 * _tileId.z)) - 1) / 3;
+
+    uint64_t x = _tileId.x;
+    uint64_t y = _tileId.y;
+
+    for (uint64_t s = (uint64_t(1) << _tileId.z) >> 1; s > 0; s >>= 1) {
+        uint64_t rx = (x & s) ? 1 : 0;
+        uint64_t ry = (y & s) ? 1 : 0;
+        id += s * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return id;
+}
+
+bool PMTilesDataSource::open() {
+
+    auto url = Url(m_path);
+    auto path = url.path();
+
+#if defined(_WIN32)
+    auto buffer = std::make_shared<std::vector<char>>();
+    Platform::bytesFromFileSystem(path.c_str(), [&](size_t _size) {
+            buffer->resize(_size);
+            return buffer->data();
+        });
+    m_data = buffer->data();
+    m_size = buffer->size();
+    m_archive = buffer;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOGE("Unable to open PMTiles archive: %s", m_path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            // Tiles are read in no particular order
+            madvise(data, st.st_size, MADV_RANDOM);
+            m_data = static_cast<const char*>(data);
+            m_size = st.st_size;
+            m_archive = std::shared_ptr<const void>(data, [size = m_size](const void* _data) {
+                    munmap(const_cast<void*>(_data), size);
+                });
+        }
+    }
+    ::close(fd);
+#endif
+
+    if (!m_data || m_size < HEADER_LENGTH) {
+        LOGE("Unable to read PMTiles archive: %s", m_path.c_str());
+        return false;
+    }
+
+    if (memcmp(m_data, "PMTiles", 7) != 0 || m_data[7] != 3) {
+        LOGE("Unsupported PMTiles archive, expected version 3: %s", m_path.c_str());
+        return false;
+    }
+
+    uint64_t rootOffset = readUint64(m_data + 8);
+    uint64_t rootLength = readUint64(m_data + 16);
+    m_header.leafDirectoryOffset = readUint64(m_data + 40);
+    m_header.tileDataOffset = readUint64(m_data + 56);
+    m_header.internalCompression = Compression(m_data[97]);
+    m_header.tileCompression = Compression(m_data[98]);
+    m_header.minZoom = m_data[100];
+    m_header.maxZoom = m_data[101];
+
+    if (m_header.tileCompression > Compression::gzip) {
+        LOGE("Unsupported PMTiles tile compression %d: %s", int(m_header.tileCompression), m_path.c_str());
+        return false;
+    }
+
+    if (!readDirectory(rootOffset, rootLength, m_rootDirectory)) {
+        LOGE("Invalid PMTiles root directory: %s", m_path.c_str());
+        return false;
+    }
+
+    LOG("PMTiles archive opened: %s, %d root entries", path.c_str(), int(m_rootDirectory.size()));
+    return true;
+}
+
+void PMTilesDataSource::close() {
+    m_data = nullptr;
+    m_size = 0;
+    m_archive.reset();
+}
+
+bool PMTilesDataSource::readDirectory(uint64_t _offset, uint64_t _length, Directory& _directory) const {
+
+    if (_offset > m_size || _length > m_size - _offset) { return false; }
+
+    const char* data = m_data + _offset;
+    std::vector<char> inflated;
+
+    switch (m_header.internalCompression) {
+    case Compression::unknown:
+    case Compression::none:
+        break;
+    case Compression::gzip:
+        if (zlib::inflate(data, _length, inflated) != 0) { return false; }
+        data = inflated.data();
+        _length = inflated.size();
+        break;
+    default:
+        LOGE("Unsupported PMTiles directory compression %d", int(m_header.internalCompression));
+        return false;
+    }
+
+    const char* pos = data;
+    const char* end = data + _length;
+
+    uint64_t numEntries;
+    if (!readVarint(pos, end, numEntries) || numEntries > _length) { return false; }
+
+    _directory.resize(numEntries);
+
+    // Columns of tile id deltas, run lengths, lengths and offsets
+    uint64_t value, tileId = 0;
+    for (auto& entry : _directory) {
+        if (!readVarint(pos, end, value)) { return false; }
+        tileId += value;
+        entry.tileId = tileId;
+    }
+    for (auto& entry : _directory) {
+        if (!readVarint(pos, end, value)) { return false; }
+        entry.runLength = value;
+    }
+    for (auto& entry : _directory) {
+        if (!readVarint(pos, end, value)) { return false; }
+        entry.length = value;
+    }
+    for (size_t i = 0; i < _directory.size(); i++) {
+        if (!readVarint(pos, end, value)) { return false; }
+        // Zero marks data that directly follows the previous entry
+        if (value == 0 && i > 0) {
+            _directory[i].offset = _directory[i-1].offset + _directory[i-1].length;
+        } else {
+            _directory[i].offset = value - 1;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const PMTilesDataSource::Directory> PMTilesDataSource::leafDirectory(uint64_t _offset, uint64_t _length) {
+    {
+        std::lock_guard<std::mutex> lock(m_leafMutex);
+        auto it = m_leafDirectories.find(_offset);
+        if (it != m_leafDirectories.end()) {
+            m_leafList.splice(m_leafList.begin(), m_leafList, it->second);
+            return it->second->directory;
+        }
+    }
+
+    auto directory = std::make_shared<Directory>();
+    if (!readDirectory(_offset, _length, *directory)) {
+        LOGE("Invalid PMTiles leaf directory at %lld: %s", (long long)_offset, m_path.c_str());
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_leafMutex);
+    // Decoded by another thread in the meantime
+    auto it = m_leafDirectories.find(_offset);
+    if (it != m_leafDirectories.end()) { return it->second->directory; }
+
+    if (m_leafList.size() >= MAX_LEAF_DIRECTORIES) {
+        m_leafDirectories.erase(m_leafList.back().offset);
+        m_leafList.pop_back();
+    }
+    m_leafList.push_front({_offset, directory});
+    m_leafDirectories.emplace(_offset, m_leafList.begin());
+
+    return directory;
+}
+
+bool PMTilesDataSource::getTileData(const TileID& _tileId, ByteBuffer& _data) {
+
+    if (_tileId.z < m_header.minZoom || _tileId.z > m_header.maxZoom) { return false; }
+
+    uint64_t tileId = hilbertTileId(_tileId);
+
+    const Directory* directory = &m_rootDirectory;
+    std::shared_ptr<const Directory> leaf;
+
+    for (int depth = 0; depth <= MAX_DIRECTORY_DEPTH; depth++) {
+
+        // Last entry starting at or before tileId
+        auto it = std::upper_bound(directory->begin(), directory->end(), tileId,
+                                   [](uint64_t _id, const Entry& _entry) { return _id < _entry.tileId; });
+        if (it == directory->begin()) { return false; }
+        --it;
+
+        if (it->runLength == 0) {
+            leaf = leafDirectory(m_header.leafDirectoryOffset + it->offset, it->length);
+            if (!leaf) { return false; }
+            directory = leaf.get();
+            continue;
+        }
+
+        if (tileId - it->tileId >= it->runLength) { return false; }
+
+        uint64_t offset = m_header.tileDataOffset + it->offset;
+        if (offset > m_size || it->length > m_size - offset) {
+            LOGW("Invalid PMTiles tile range: %s", _tileId.toString().c_str());
+            return false;
+        }
+
+        const char* data = m_data + offset;
+        if (m_header.tileCompression == Compression::gzip) {
+            std::vector<char> inflated;
+            if (zlib::inflate(data, it->length, inflated) != 0) {
+                LOGW("Invalid gzip compression: %s", _tileId.toString().c_str());
+                return false;
+            }
+            _data = ByteBuffer(std::move(inflated));
+        } else {
+            _data = ByteBuffer(data, it->length, m_archive);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool PMTilesDataSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) {
+
+    if (!isOpen() || _task->rawSource != this->level) {
+        if (!next) { return false; }
+        if (_task->rawSource == this->level) { _task->rawSource = next->level; }
+        return next->loadTileData(_task, _cb);
+    }
+
+    m_worker->enqueue([this, _task, _cb](){
+        auto& task = static_cast<BinaryTileTask&>(*_task);
+        task.rawTileData.reset();
+
+        getTileData(_task->tileId(), task.rawTileData);
+
+        if (!task.hasData() && next) {
+            // Don't try this source again
+            _task->rawSource = next->level;
+
+            if (next->loadTileData(_task, _cb)) { return; }
+        }
+        // Missing tiles are empty, e.g. sparse ocean tiles
+        _cb.func(_task);
+    });
+
+    return true;
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "data/tileSource.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Tangram {
+
+class AsyncWorker;
+
+// Reads tiles from a local PMTiles v3 archive.
+// https://github.com/protomaps/PMTiles/blob/main/spec/v3/spec.md
+//
+// The archive is memory-mapped. The root directory is decoded when the
+// archive is opened, leaf directories when they are first used. Tiles
+// without compression are passed on as views into the mapping.
+class PMTilesDataSource : public TileSource::DataSource {
+public:
+
+    PMTilesDataSource(std::string _name, std::string _path);
+
+    ~PMTilesDataSource();
+
+    bool loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) override;
+
+    void clear() override { if (next) next->clear(); }
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    // Position of _tileId on the Hilbert curves of all zoom levels
+    static uint64_t hilbertTileId(const TileID& _tileId);
+
+private:
+
+    struct Entry {
+        uint64_t tileId;
+        uint64_t offset;
+        uint32_t length;
+        // Number of consecutive tiles with the same data, 0 for leaf directories
+        uint32_t runLength;
+    };
+    using Directory = std::vector<Entry>;
+
+    enum class Compression : uint8_t {
+        unknown = 0,
+        none = 1,
+        gzip = 2,
+        brotli = 3,
+        zstd = 4,
+    };
+
+    bool open();
+    void close();
+
+    bool readDirectory(uint64_t _offset, uint64_t _length, Directory& _directory) const;
+    std::shared_ptr<const Directory> leafDirectory(uint64_t _offset, uint64_t _length);
+
+    bool getTileData(const TileID& _tileId, ByteBuffer& _data);
+
+    std::string m_name;
+    std::string m_path;
+
+    // The mapped archive, or a buffer where files cannot be mapped. Tile
+    // data views keep it alive.
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    std::shared_ptr<const void> m_archive;
+
+    struct {
+        uint64_t leafDirectoryOffset = 0;
+        uint64_t tileDataOffset = 0;
+        Compression internalCompression = Compression::unknown;
+        Compression tileCompression = Compression::unknown;
+        uint8_t minZoom = 0;
+        uint8_t maxZoom = 0;
+    } m_header;
+
+    Directory m_rootDirectory;
+
+    struct LeafEntry {
+        uint64_t offset;
+        std::shared_ptr<const Directory> directory;
+    };
+    using LeafList = std::list<LeafEntry>;
+
+    // Decoded leaf directories, most recently used first
+    LeafList m_leafList;
+    std::unordered_map<uint64_t, LeafList::iterator> m_leafDirectories;
+    std::mutex m_leafMutex;
+
+    std::unique_ptr<AsyncWorker> m_worker;
+};
+
+}
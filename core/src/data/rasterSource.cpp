@@ -7,8 +7,14 @@
 #include "util/mapProjection.h"
 #include "log.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace Tangram {
 
+// Parent tiles up to this many zoom levels above a missing tile are upscaled
+static const int MAX_DERIVE_PARENT_LEVELS = 3;
+
 class RasterTileTask : public BinaryTileTask {
 public:
 
@@ -17,6 +23,12 @@ public:
     std::unique_ptr<Texture> texture;
     std::unique_ptr<Raster> raster;
 
+    // Cached neighbour tiles to derive the texture from when the tile is missing
+    std::vector<std::pair<TileID, ByteBuffer>> derivationTiles;
+    bool deriveTexture = false;
+    // The derived texture stands in for the tile until it is loaded
+    bool standIn = false;
+
     RasterTileTask(TileID& _tileId, std::shared_ptr<TileSource> _source, bool _subTask)
         : BinaryTileTask(_tileId, _source),
           subTask(_subTask) {}
@@ -27,7 +39,7 @@ public:
     }
 
     bool hasData() const override {
-        return bool(rawTileData) || bool(texture) || bool(raster);
+        return !rawTileData.empty() || bool(texture) || bool(raster) || deriveTexture;
     }
 
     bool isReady() const override {
@@ -44,7 +56,15 @@ public:
 
         if (!texture && !raster) {
             // Decode texture data
-            texture = source->createTexture(m_tileId, *rawTileData);
+            texture = source->createTexture(m_tileId, rawTileData);
+            if (!texture && deriveTexture) {
+                texture = source->deriveTexture(m_tileId, derivationTiles);
+            }
+            if (!texture && standIn) {
+                // Keep a cache entry for the tile, so that it is loaded
+                texture = source->createEmptyTexture();
+            }
+            derivationTiles.clear();
             if (!texture) {
                 raster = std::make_unique<Raster>(m_tileId, source->emptyTexture());
             }
@@ -66,7 +86,7 @@ public:
         if (raster) {
             rasters.emplace_back(raster->tileID, raster->texture);
         } else {
-            auto tex = source->cacheTexture(m_tileId, std::move(texture));
+            auto tex = source->cacheTexture(m_tileId, std::move(texture), rawTileData, standIn);
             rasters.emplace_back(m_tileId, tex);
         }
     }
@@ -93,11 +113,18 @@ RasterSource::RasterSource(const std::string& _name, std::unique_ptr<DataSource>
       m_texOptions(_options) {
 
     m_textures = std::make_shared<Cache>();
-    m_emptyTexture = std::make_shared<Texture>(m_texOptions);
+    m_texturePool = std::make_shared<TexturePool>();
+    m_emptyTexture = createEmptyTexture();
+}
+
+std::unique_ptr<Texture> RasterSource::createEmptyTexture() {
+    auto texture = std::make_unique<Texture>(m_texOptions);
 
     GLubyte pixel[4] = { 0, 0, 0, 0 };
-    auto bpp = _options.bytesPerPixel();
-    m_emptyTexture->setPixelData(1, 1, bpp, pixel, bpp);
+    auto bpp = m_texOptions.bytesPerPixel();
+    texture->setPixelData(1, 1, bpp, pixel, bpp);
+
+    return texture;
 }
 
 void RasterSource::generateGeometry(bool _generateGeometry) {
@@ -121,13 +148,19 @@ void RasterSource::generateGeometry(bool _generateGeometry) {
     }
 }
 
-std::unique_ptr<Texture> RasterSource::createTexture(TileID _tile, const std::vector<char>& _rawTileData) {
+std::unique_ptr<Texture> RasterSource::createTexture(TileID _tile, const ByteBuffer& _rawTileData) {
     if (_rawTileData.empty()) { return nullptr; }
 
     auto data = reinterpret_cast<const uint8_t*>(_rawTileData.data());
     auto length = _rawTileData.size();
 
-    return std::make_unique<Texture>(data, length, m_texOptions);
+    // Decoded into a pooled pixel buffer. When the tile is evicted from the cache,
+    // the texture hands its GL texture back to the pool for the next tile.
+    auto texture = std::make_unique<Texture>(m_texOptions);
+    texture->setPool(m_texturePool);
+    texture->loadImageFromMemory(data, length);
+
+    return texture;
 }
 
 void RasterSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) {
@@ -136,7 +169,12 @@ void RasterSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb)
     TileTaskCb cb{[this, _cb](std::shared_ptr<TileTask> _task) {
         if (!_task->hasData()) {
             auto& task = static_cast<RasterTileTask&>(*_task);
-            task.raster = std::make_unique<Raster>(task.tileId(), m_emptyTexture);
+            if (!task.derivationTiles.empty()) {
+                // Build the texture from cached neighbours on a worker
+                task.deriveTexture = true;
+            } else {
+                task.raster = std::make_unique<Raster>(task.tileId(), m_emptyTexture);
+            }
         }
         _cb.func(_task);
     }};
@@ -173,21 +211,47 @@ std::shared_ptr<RasterTileTask> RasterSource::createRasterTask(TileID _tileId, b
     // First try existing textures cache
     TileID id(_tileId.x, _tileId.y, _tileId.z);
 
+    bool derived = false;
+
     auto texIt = m_textures->find(id);
     if (texIt != m_textures->end()) {
-        auto texture = texIt->second.lock();
+        auto texture = texIt->second.texture.lock();
 
-        if (texture) {
+        // Derived textures are not reused, the tile is loaded again
+        if (texture && !texIt->second.derived) {
             LOGD("%d - reuse %s", m_textures->size(), id.toString().c_str());
 
             task->raster = std::make_unique<Raster>(id, texture);
             // No more loading needed.
             task->startedLoading();
+            return task;
         }
+        derived = bool(texture);
+    }
+
+    task->derivationTiles = findDerivationTiles(id);
+
+    // Show a texture derived from cached neighbours right away. The tile is
+    // loaded when its generation says that it is outdated. Raster tiles of
+    // other sources are only derived when they fail to load.
+    if (!subTask && !derived && !task->derivationTiles.empty()) {
+        task->deriveTexture = true;
+        task->standIn = true;
+        task->startedLoading();
     }
+
     return task;
 }
 
+int64_t RasterSource::generation(const TileID& _tileId) const {
+    auto it = m_textures->find(TileID(_tileId.x, _tileId.y, _tileId.z));
+    if (it != m_textures->end() && it->second.standIn && !it->second.texture.expired()) {
+        // Load tiles that show a stand-in texture
+        return m_generation + 1;
+    }
+    return m_generation;
+}
+
 std::shared_ptr<TileTask> RasterSource::createTask(TileID _tileId) {
     auto task = createRasterTask(_tileId, false);
 
@@ -196,12 +260,19 @@ std::shared_ptr<TileTask> RasterSource::createTask(TileID _tileId) {
     return task;
 }
 
-std::shared_ptr<Texture> RasterSource::cacheTexture(const TileID& _tileId, std::unique_ptr<Texture> _texture) {
+std::shared_ptr<Texture> RasterSource::cacheTexture(const TileID& _tileId, std::unique_ptr<Texture> _texture,
+                                                   ByteBuffer _data, bool _standIn) {
     TileID id(_tileId.x, _tileId.y, _tileId.z);
 
+    bool derived = _data.empty();
+
     auto& textureEntry = (*m_textures)[id];
-    auto texture = textureEntry.lock();
-    if (texture) {
+    auto texture = textureEntry.texture.lock();
+    // A loaded texture replaces a derived one
+    if (texture && (derived || !textureEntry.derived)) {
+        // The tile failed to load: Keep showing the derived texture
+        if (!_standIn) { textureEntry.standIn = false; }
+
         LOGD("%d - drop duplicate %s", m_textures->size(), id.toString().c_str());
         // The same texture has been loaded in the meantime: Reuse it and drop _texture..
         return texture;
@@ -210,16 +281,150 @@ std::shared_ptr<Texture> RasterSource::cacheTexture(const TileID& _tileId, std::
     texture = std::shared_ptr<Texture>(_texture.release(),
                                        [c = std::weak_ptr<Cache>(m_textures), id](auto* t) {
                                            if (auto cache = c.lock()) {
-                                               cache->erase(id);
-                                               LOGD("%d - remove %s", cache->size(), id.toString().c_str());
+                                               // Unless the entry was replaced by a loaded texture
+                                               auto it = cache->find(id);
+                                               if (it != cache->end() && it->second.texture.expired()) {
+                                                   cache->erase(it);
+                                                   LOGD("%d - remove %s", cache->size(), id.toString().c_str());
+                                               }
                                            }
                                            delete t;
                                        });
     // Add to cache
-    textureEntry = texture;
+    textureEntry.texture = texture;
+    textureEntry.data = std::move(_data);
+    textureEntry.derived = derived;
+    textureEntry.standIn = derived && _standIn;
     LOGD("%d - added %s", m_textures->size(), id.toString().c_str());
 
     return texture;
 }
 
+std::vector<std::pair<TileID, ByteBuffer>> RasterSource::findDerivationTiles(const TileID& _tileId) const {
+
+    std::vector<std::pair<TileID, ByteBuffer>> tiles;
+
+    auto cached = [&](const TileID& _id) -> const ByteBuffer* {
+        auto it = m_textures->find(_id);
+        if (it == m_textures->end() || it->second.data.empty() ||
+            it->second.texture.expired()) {
+            return nullptr;
+        }
+        return &it->second.data;
+    };
+
+    // Children give the sharper texture, but only when all four are there
+    for (int i = 0; i < 4; i++) {
+        TileID child((_tileId.x << 1) + (i & 1), (_tileId.y << 1) + (i >> 1), _tileId.z + 1);
+        auto data = cached(child);
+        if (!data) { break; }
+        tiles.emplace_back(child, *data);
+    }
+    if (tiles.size() == 4) { return tiles; }
+    tiles.clear();
+
+    for (int level = 1; level <= MAX_DERIVE_PARENT_LEVELS && level <= _tileId.z; level++) {
+        TileID parent(_tileId.x >> level, _tileId.y >> level, _tileId.z - level);
+        if (auto data = cached(parent)) {
+            tiles.emplace_back(parent, *data);
+            break;
+        }
+    }
+    return tiles;
+}
+
+std::unique_ptr<Texture> RasterSource::deriveTexture(const TileID& _tileId,
+                                                     const std::vector<std::pair<TileID, ByteBuffer>>& _tiles) {
+    if (_tiles.empty()) { return nullptr; }
+
+    std::vector<std::unique_ptr<Texture>> sources;
+    for (auto& tile : _tiles) {
+        sources.push_back(createTexture(tile.first, tile.second));
+        if (!sources.back() || !sources.back()->bufferData()) { return nullptr; }
+    }
+
+    int width = sources[0]->width();
+    int height = sources[0]->height();
+    int bpp = m_texOptions.bytesPerPixel();
+
+    for (auto& source : sources) {
+        if (source->width() != width || source->height() != height) { return nullptr; }
+    }
+
+    std::vector<GLubyte> pixels(size_t(width) * height * bpp);
+
+    // Texture rows start at the bottom of the tile, see Texture::loadImageFromMemory
+    if (_tiles.size() == 4) {
+        if (width % 2 != 0 || height % 2 != 0) { return nullptr; }
+
+        // Average 2x2 blocks of each child into its quadrant
+        int halfWidth = width / 2, halfHeight = height / 2;
+        for (size_t i = 0; i < sources.size(); i++) {
+            auto& id = _tiles[i].first;
+            int offsetX = (id.x & 1) * halfWidth;
+            int offsetY = (1 - (id.y & 1)) * halfHeight;
+            const GLubyte* src = sources[i]->bufferData();
+
+            for (int y = 0; y < halfHeight; y++) {
+                const GLubyte* row0 = src + size_t(2 * y) * width * bpp;
+                const GLubyte* row1 = row0 + size_t(width) * bpp;
+                GLubyte* dst = pixels.data() + (size_t(offsetY + y) * width + offsetX) * bpp;
+
+                for (int x = 0; x < halfWidth; x++) {
+                    for (int c = 0; c < bpp; c++) {
+                        int sum = row0[(2 * x) * bpp + c] + row0[(2 * x + 1) * bpp + c] +
+                                  row1[(2 * x) * bpp + c] + row1[(2 * x + 1) * bpp + c];
+                        dst[x * bpp + c] = GLubyte((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+    } else {
+        // Bilinear upscale of the region of the parent covering this tile
+        auto& id = _tiles[0].first;
+        int levels = _tileId.z - id.z;
+        int scale = 1 << levels;
+        int dx = _tileId.x - (id.x << levels);
+        int dy = _tileId.y - (id.y << levels);
+
+        float regionX = float(dx * width) / scale;
+        float regionY = float((scale - 1 - dy) * height) / scale;
+        const GLubyte* src = sources[0]->bufferData();
+
+        for (int y = 0; y < height; y++) {
+            float sy = regionY + (y + 0.5f) / scale - 0.5f;
+            int y0 = std::max(0, std::min(height - 1, int(std::floor(sy))));
+            int y1 = std::min(height - 1, y0 + 1);
+            float fy = std::max(0.f, std::min(1.f, sy - y0));
+
+            for (int x = 0; x < width; x++) {
+                float sx = regionX + (x + 0.5f) / scale - 0.5f;
+                int x0 = std::max(0, std::min(width - 1, int(std::floor(sx))));
+                int x1 = std::min(width - 1, x0 + 1);
+                float fx = std::max(0.f, std::min(1.f, sx - x0));
+
+                const GLubyte* p00 = src + (size_t(y0) * width + x0) * bpp;
+                const GLubyte* p01 = src + (size_t(y0) * width + x1) * bpp;
+                const GLubyte* p10 = src + (size_t(y1) * width + x0) * bpp;
+                const GLubyte* p11 = src + (size_t(y1) * width + x1) * bpp;
+                GLubyte* dst = pixels.data() + (size_t(y) * width + x) * bpp;
+
+                for (int c = 0; c < bpp; c++) {
+                    float top = p00[c] + (p01[c] - p00[c]) * fx;
+                    float bottom = p10[c] + (p11[c] - p10[c]) * fx;
+                    dst[c] = GLubyte(top + (bottom - top) * fy + 0.5f);
+                }
+            }
+        }
+    }
+
+    auto texture = std::make_unique<Texture>(m_texOptions);
+    texture->setPool(m_texturePool);
+    if (!texture->setPixelData(width, height, bpp, pixels.data(), pixels.size())) { return nullptr; }
+
+    LOGD("Derived raster tile %s from %d tiles", _tileId.toString().c_str(), int(_tiles.size()));
+
+    return texture;
+}
+
 }
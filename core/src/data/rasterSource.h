@@ -8,6 +8,7 @@
 #include <functional>
 #include <map>
 #include <mutex>
+#include <vector>
 
 namespace Tangram {
 
@@ -15,11 +16,24 @@ class RasterTileTask;
 
 class RasterSource : public TileSource {
 
-    using Cache = std::map<TileID, std::weak_ptr<Texture>>;
+    struct CacheEntry {
+        std::weak_ptr<Texture> texture;
+        // Encoded tile data to derive textures of missing parent or child
+        // tiles, empty for derived textures
+        ByteBuffer data;
+        // Derived textures only stand in for the tile until it is loaded
+        bool derived = false;
+        // Derived before the tile was loaded, the tile still needs loading
+        bool standIn = false;
+    };
+    using Cache = std::map<TileID, CacheEntry>;
     std::shared_ptr<Cache> m_textures;
 
     TextureOptions m_texOptions;
 
+    // GL textures of evicted tiles, reused for new tiles of the same size
+    std::shared_ptr<TexturePool> m_texturePool;
+
     std::shared_ptr<Texture> m_emptyTexture;
 
     friend class RasterTileTask;
@@ -33,9 +47,25 @@ protected:
 
     void addRasterTask(TileTask& _tileTask);
 
-    std::unique_ptr<Texture> createTexture(TileID _tile, const std::vector<char>& _rawTileData);
+    std::unique_ptr<Texture> createTexture(TileID _tile, const ByteBuffer& _rawTileData);
+
+    // Caches _texture of _tileId with its encoded _data. Without data the texture is
+    // derived: It is replaced by the texture of the tile when that is loaded. A
+    // _standIn texture was derived before loading the tile, which is loaded next.
+    std::shared_ptr<Texture> cacheTexture(const TileID& _tileId, std::unique_ptr<Texture> _texture,
+                                          ByteBuffer _data = {}, bool _standIn = false);
+
+    // 1x1 transparent texture
+    std::unique_ptr<Texture> createEmptyTexture();
 
-    std::shared_ptr<Texture> cacheTexture(const TileID& _tileId, std::unique_ptr<Texture> _texture);
+    // Encoded data of cached tiles from which a texture for _tileId can be
+    // derived: the nearest parent or, preferably, all four children
+    std::vector<std::pair<TileID, ByteBuffer>> findDerivationTiles(const TileID& _tileId) const;
+
+    // Upscales the covering region of a parent tile or downsamples four child
+    // tiles into a texture for _tileId. Called on tile workers.
+    std::unique_ptr<Texture> deriveTexture(const TileID& _tileId,
+                                           const std::vector<std::pair<TileID, ByteBuffer>>& _tiles);
 
     std::shared_ptr<Texture> emptyTexture() { return m_emptyTexture; }
 
@@ -51,6 +81,11 @@ public:
 
     std::shared_ptr<TileTask> createTask(TileID _tile) override;
 
+    using TileSource::generation;
+
+    // Tiles that show a texture derived from cached neighbours are outdated
+    int64_t generation(const TileID& _tileId) const override;
+
     bool isRaster() const override { return true; }
 
     void generateGeometry(bool _generateGeometry) override;
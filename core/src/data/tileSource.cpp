@@ -91,6 +91,8 @@ void TileSource::loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) {
     }
 
     for (auto& subTask : _task->subTasks()) {
+        subTask->setPriority(_task->getPriority());
+        subTask->setProxyState(_task->isProxy());
         subTask->source()->loadTileData(subTask, _cb);
     }
 }
@@ -114,6 +116,17 @@ void TileSource::cancelLoadingTile(TileTask& _task) {
     }
 }
 
+void TileSource::updateTilePriority(TileTask& _task) {
+
+    if (m_sources) { m_sources->updateTilePriority(_task); }
+
+    for (auto& subTask : _task.subTasks()) {
+        subTask->setPriority(_task.getPriority());
+        subTask->setProxyState(_task.isProxy());
+        subTask->source()->updateTilePriority(*subTask);
+    }
+}
+
 void TileSource::addRasterSource(std::shared_ptr<TileSource> _rasterSource) {
     if (!_rasterSource) {
         LOGE("No raster source");
@@ -41,7 +41,7 @@ public:
 
     size_t numberOfVertices() const { return m_vertices.size(); }
 
-    void upload(RenderState& rs) override;
+    bool upload(RenderState& rs) override;
 
     bool isReady() { return m_isUploaded; }
 
@@ -60,9 +60,9 @@ private:
 };
 
 template<class T>
-void DynamicQuadMesh<T>::upload(RenderState& rs) {
+bool DynamicQuadMesh<T>::upload(RenderState& rs) {
 
-    if (m_nVertices == 0 || m_isUploaded) { return; }
+    if (m_nVertices == 0 || m_isUploaded) { return true; }
 
     // Generate vertex buffer, if needed
     if (m_glVertexBuffer == 0) {
@@ -72,6 +72,8 @@ void DynamicQuadMesh<T>::upload(RenderState& rs) {
     MeshBase::subDataUpload(rs, reinterpret_cast<GLbyte*>(m_vertices.data()));
 
     m_isUploaded = true;
+
+    return true;
 }
 
 template<class T>
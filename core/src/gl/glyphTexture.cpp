@@ -3,11 +3,14 @@
 #include "gl/renderState.h"
 #include "log.h"
 
+#include <cstring>
+
 namespace Tangram {
 
 GlyphTexture::GlyphTexture() : Texture(textureOptions()) {
 
-    m_buffer.reset(reinterpret_cast<GLubyte*>(std::calloc(size * size, sizeof(GLubyte))));
+    m_buffer.reset(reinterpret_cast<GLubyte*>(PixelBuffer::allocate(size * size)));
+    if (m_buffer) { std::memset(m_buffer.get(), 0, size * size); }
     m_disposeBuffer = false;
     resize(size, size);
 }
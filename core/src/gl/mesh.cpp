@@ -6,6 +6,9 @@
 #include "platform.h"
 #include "log.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace Tangram {
 
 
@@ -18,6 +21,7 @@ MeshBase::MeshBase() {
     m_nIndices = 0;
     m_dirtyOffset = 0;
     m_dirtySize = 0;
+    m_uploadOffset = 0;
 
     m_dirty = false;
     m_isUploaded = false;
@@ -107,40 +111,98 @@ void MeshBase::subDataUpload(RenderState& rs, GLbyte* _data) {
     m_dirty = false;
 }
 
-void MeshBase::upload(RenderState& rs) {
+bool MeshBase::upload(RenderState& rs) {
+
+    // Nothing to upload
+    if (m_isUploaded || !m_isCompiled) { return true; }
+
+    size_t remaining = bufferSize() - m_uploadOffset;
+
+    size_t bytes = rs.reserveUpload(remaining);
+
+    // Continue in the next frame when the budget of this one is used up
+    if (bytes == 0 && remaining > 0) { return false; }
+
+    // The budget adapts to the time of the upload calls
+    auto start = std::chrono::steady_clock::now();
+    bool uploaded = uploadBytes(rs, bytes);
+    rs.addUploadDuration(std::chrono::steady_clock::now() - start);
+
+    return uploaded;
+}
+
+bool MeshBase::uploadBytes(RenderState& rs, size_t _bytes) {
 
-    // Generate vertex buffer, if needed
+    // Generate buffers, if needed
     if (m_glVertexBuffer == 0) {
         GL::genBuffers(1, &m_glVertexBuffer);
     }
+    if (m_glIndexData && m_glIndexBuffer == 0) {
+        GL::genBuffers(1, &m_glIndexBuffer);
+    }
 
-    // Buffer vertex data
-    int vertexBytes = m_nVertices * m_vertexLayout->getStride();
+    m_rs = &rs;
 
-    rs.vertexBuffer(m_glVertexBuffer);
-    GL::bufferData(GL_ARRAY_BUFFER, vertexBytes, m_glVertexData, m_hint);
+    size_t vertexBytes = m_nVertices * m_vertexLayout->getStride();
+    size_t indexBytes = m_nIndices * sizeof(GLushort);
 
-    delete[] m_glVertexData;
-    m_glVertexData = nullptr;
+    if (m_uploadOffset == 0 && _bytes == vertexBytes + indexBytes) {
+        // Buffer all data at once
+        rs.vertexBuffer(m_glVertexBuffer);
+        GL::bufferData(GL_ARRAY_BUFFER, vertexBytes, m_glVertexData, m_hint);
 
-    if (m_glIndexData) {
+        if (m_glIndexData) {
+            rs.indexBuffer(m_glIndexBuffer);
+            GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, m_glIndexData, m_hint);
+        }
+        m_uploadOffset = vertexBytes + indexBytes;
 
-        if (m_glIndexBuffer == 0) {
-            GL::genBuffers(1, &m_glIndexBuffer);
+    } else {
+        if (m_uploadOffset == 0) {
+            // Allocate buffer storage to be filled over the next frames
+            rs.vertexBuffer(m_glVertexBuffer);
+            GL::bufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, m_hint);
+
+            if (m_glIndexData) {
+                rs.indexBuffer(m_glIndexBuffer);
+                GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, nullptr, m_hint);
+            }
         }
 
-        // Buffer element index data
-        rs.indexBuffer(m_glIndexBuffer);
+        // Vertices and indices are uploaded as one sequence of bytes
+        size_t end = m_uploadOffset + _bytes;
 
-        GL::bufferData(GL_ELEMENT_ARRAY_BUFFER, m_nIndices * sizeof(GLushort), m_glIndexData, m_hint);
+        if (m_uploadOffset < vertexBytes) {
+            size_t chunkEnd = std::min(end, vertexBytes);
 
-        delete[] m_glIndexData;
-        m_glIndexData = nullptr;
+            rs.vertexBuffer(m_glVertexBuffer);
+            GL::bufferSubData(GL_ARRAY_BUFFER, m_uploadOffset, chunkEnd - m_uploadOffset,
+                              m_glVertexData + m_uploadOffset);
+
+            m_uploadOffset = chunkEnd;
+        }
+        if (m_uploadOffset < end) {
+            size_t offset = m_uploadOffset - vertexBytes;
+
+            rs.indexBuffer(m_glIndexBuffer);
+            GL::bufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, end - m_uploadOffset,
+                              reinterpret_cast<GLbyte*>(m_glIndexData) + offset);
+
+            m_uploadOffset = end;
+        }
+
+        if (m_uploadOffset < vertexBytes + indexBytes) { return false; }
     }
 
-    m_rs = &rs;
+    delete[] m_glVertexData;
+    m_glVertexData = nullptr;
+
+    delete[] m_glIndexData;
+    m_glIndexData = nullptr;
 
     m_isUploaded = true;
+
+    return true;
 }
 
 bool MeshBase::draw(RenderState& rs, ShaderProgram& _shader, bool _useVao) {
@@ -154,9 +216,9 @@ bool MeshBase::draw(RenderState& rs, ShaderProgram& _shader, bool _useVao) {
         return false;
     }
 
-    // Ensure that geometry is buffered into GPU
+    // Ensure that geometry is buffered into GPU, regardless of the upload budget
     if (!m_isUploaded) {
-        upload(rs);
+        uploadBytes(rs, bufferSize() - m_uploadOffset);
     } else if (m_dirty) {
         subDataUpload(rs);
     }
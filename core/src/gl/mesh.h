@@ -55,10 +55,12 @@ public:
     void dispose(RenderState& rs);
 
     /*
-     * Copies all added vertices and indices into OpenGL buffer objects; After
-     * geometry is uploaded, no more vertices or indices can be added
+     * Copies all added vertices and indices into OpenGL buffer objects, in
+     * chunks that fit into the upload budget of the RenderState; Returns true
+     * when all geometry is uploaded. After geometry is uploaded, no more
+     * vertices or indices can be added
      */
-    virtual void upload(RenderState& rs);
+    virtual bool upload(RenderState& rs);
 
     /*
      * Sub data upload of the mesh, returns true if this results in a buffer binding
@@ -101,6 +103,9 @@ protected:
     bool m_isCompiled;
     bool m_dirty;
 
+    // Bytes of vertex and index data uploaded so far
+    size_t m_uploadOffset;
+
     RenderState* m_rs = nullptr;
 
     GLsizei m_dirtySize;
@@ -110,6 +115,8 @@ protected:
                           const std::vector<uint16_t>& _indices, size_t _offset);
 
     void setDirty(GLintptr _byteOffset, GLsizei _byteSize);
+
+    bool uploadBytes(RenderState& rs, size_t _bytes);
 };
 
 template<class T>
@@ -151,6 +158,10 @@ public:
         return MeshBase::draw(rs, shader, useVao);
     }
 
+    bool upload(RenderState& rs) override {
+        return MeshBase::upload(rs);
+    }
+
     void compile(const std::vector<MeshData<T>>& _meshes);
 
     void compile(const MeshData<T>& _mesh);
@@ -4,9 +4,11 @@
 #include "gl/glError.h"
 #include "gl/hardware.h"
 #include "gl/texture.h"
+#include "gl/texturePool.h"
 #include "log.h"
 #include "platform.h"
 
+#include <algorithm>
 #include <limits>
 
 namespace Tangram {
@@ -79,6 +81,17 @@ void RenderState::queueTextureDeletion(GLuint texture) {
     m_textureDeletionList.push_back(texture);
 }
 
+void RenderState::addTexturePool(TexturePool& _pool) {
+    std::lock_guard<std::mutex> guard(m_texturePoolMutex);
+    m_texturePools.push_back(&_pool);
+}
+
+void RenderState::removeTexturePool(TexturePool& _pool) {
+    std::lock_guard<std::mutex> guard(m_texturePoolMutex);
+    m_texturePools.erase(std::remove(m_texturePools.begin(), m_texturePools.end(), &_pool),
+                         m_texturePools.end());
+}
+
 void RenderState::queueVAODeletion(size_t count, GLuint* vao) {
     std::lock_guard<std::mutex> guard(m_deletionListMutex);
     m_VAODeletionList.insert(m_VAODeletionList.end(), vao, vao + count);
@@ -89,6 +102,59 @@ void RenderState::queueBufferDeletion(size_t count, GLuint* buffers) {
     m_bufferDeletionList.insert(m_bufferDeletionList.end(), buffers, buffers + count);
 }
 
+void RenderState::beginFrame() {
+    m_uploadAvailable = m_uploadBudget;
+    m_uploaded = 0;
+    m_uploadDeferred = false;
+    m_uploadDuration = std::chrono::steady_clock::duration::zero();
+}
+
+bool RenderState::endFrame() {
+    std::chrono::duration<float> duration = m_uploadDuration;
+
+    if (m_uploaded > 0 && duration.count() > m_targetUploadDuration) {
+        m_uploadBudget = std::max(m_uploadBudget / 2, m_uploadBudgetMin);
+    } else if (m_uploadDeferred && duration.count() < m_targetUploadDuration) {
+        m_uploadBudget = std::min(m_uploadBudget + m_uploadBudget / 4, m_uploadBudgetMax);
+    }
+
+    bool pending = m_uploaded > 0 || m_uploadDeferred;
+
+    m_uploadAvailable = std::numeric_limits<size_t>::max();
+    m_uploaded = 0;
+    m_uploadDeferred = false;
+    m_uploadDuration = std::chrono::steady_clock::duration::zero();
+
+    return pending;
+}
+
+size_t RenderState::reserveUpload(size_t _bytes) {
+    size_t bytes = std::min(_bytes, m_uploadAvailable);
+
+    m_uploadAvailable -= bytes;
+    m_uploaded += bytes;
+
+    if (bytes < _bytes) { m_uploadDeferred = true; }
+
+    return bytes;
+}
+
+void RenderState::addUploadDuration(std::chrono::steady_clock::duration _duration) {
+    m_uploadDuration += _duration;
+}
+
+void RenderState::setUploadTargetDuration(float _targetUploadDuration) {
+    m_targetUploadDuration = _targetUploadDuration;
+}
+
+void RenderState::setUploadBudget(size_t _minBytes, size_t _maxBytes, float _targetUploadDuration) {
+    m_uploadBudgetMin = _minBytes;
+    m_uploadBudgetMax = std::max(_minBytes, _maxBytes);
+    m_targetUploadDuration = _targetUploadDuration;
+
+    m_uploadBudget = std::min(std::max(m_uploadBudget, m_uploadBudgetMin), m_uploadBudgetMax);
+}
+
 GLuint RenderState::getTextureUnit(GLuint _unit) {
     return GL_TEXTURE0 + _unit;
 }
@@ -158,6 +224,14 @@ void RenderState::invalidateHandles() {
         m_programDeletionList.clear();
         m_shaderDeletionList.clear();
     }
+
+    // Neither are the textures kept for reuse
+    {
+        std::lock_guard<std::mutex> guard(m_texturePoolMutex);
+        for (auto* pool : m_texturePools) {
+            pool->invalidate(*this);
+        }
+    }
 }
 
 void RenderState::cacheDefaultFramebuffer() {
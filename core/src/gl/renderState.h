@@ -2,6 +2,8 @@
 
 #include "gl.h"
 #include <array>
+#include <chrono>
+#include <limits>
 #include <string>
 #include <mutex>
 #include <vector>
@@ -12,6 +14,7 @@ namespace Tangram {
 class Disposer;
 class Scene;
 class Texture;
+class TexturePool;
 
 class RenderState {
 
@@ -119,6 +122,11 @@ public:
 
     void queueProgramDeletion(GLuint program);
 
+    // Pools keeping textures of this context, they are cleared by invalidateHandles()
+    void addTexturePool(TexturePool& _pool);
+
+    void removeTexturePool(TexturePool& _pool);
+
     std::array<GLuint, MAX_ATTRIBUTES> attributeBindings = { { 0 } };
 
     std::unordered_map<std::string, GLuint> fragmentShaders;
@@ -126,6 +134,33 @@ public:
 
     float frameTime() { return m_frameTime; }
 
+    // Starts the mesh upload budget of a new frame, see reserveUpload().
+    void beginFrame();
+
+    // Adapts the upload budget to the time the uploads of the frame took, see
+    // addUploadDuration(): The budget is halved when the uploads took longer than
+    // the target duration and grows by a quarter when uploads were deferred and
+    // took less time. Rendering time does not count, so that slow frames do not
+    // hold back uploads. Returns true when the frame uploaded or deferred data,
+    // i.e. when a following frame is needed to continue uploads or to replace
+    // proxies of uploaded tiles.
+    bool endFrame();
+
+    // Reserves up to _bytes of the upload budget of the current frame and returns
+    // the number of bytes reserved. The budget is unlimited outside of frames.
+    size_t reserveUpload(size_t _bytes);
+
+    // Adds the time spent in GL calls uploading reserved bytes
+    void addUploadDuration(std::chrono::steady_clock::duration _duration);
+
+    // Sets the bounds of the upload budget and the upload duration per frame in
+    // seconds it is adapted to.
+    void setUploadBudget(size_t _minBytes, size_t _maxBytes, float _targetUploadDuration);
+
+    void setUploadTargetDuration(float _targetUploadDuration);
+
+    size_t uploadBudget() const { return m_uploadBudget; }
+
     friend class Scene;
 
 protected:
@@ -135,6 +170,17 @@ private:
 
     float m_frameTime = 0.f;
 
+    size_t m_uploadBudget = 2 * 1024 * 1024;
+    size_t m_uploadBudgetMin = 256 * 1024;
+    size_t m_uploadBudgetMax = 32 * 1024 * 1024;
+    float m_targetUploadDuration = 0.004f;
+
+    // Remaining budget of the current frame
+    size_t m_uploadAvailable = std::numeric_limits<size_t>::max();
+    size_t m_uploaded = 0;
+    bool m_uploadDeferred = false;
+    std::chrono::steady_clock::duration m_uploadDuration{0};
+
     std::mutex m_deletionListMutex;
     std::vector<GLuint> m_VAODeletionList;
     std::vector<GLuint> m_bufferDeletionList;
@@ -143,6 +189,9 @@ private:
     std::vector<GLuint> m_shaderDeletionList;
     std::vector<GLuint> m_framebufferDeletionList;
 
+    std::mutex m_texturePoolMutex;
+    std::vector<TexturePool*> m_texturePools;
+
     uint32_t m_nextTextureUnit = 0;
 
     GLuint m_quadIndexBuffer = 0;
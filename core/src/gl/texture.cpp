@@ -24,7 +24,11 @@ Texture::Texture(const uint8_t* data, size_t length, TextureOptions options)
 
 Texture::~Texture() {
     if (m_rs) {
-        m_rs->queueTextureDeletion(m_glHandle);
+        if (m_pool && !m_shouldResize) {
+            m_pool->release(*m_rs, m_glHandle, m_width, m_height);
+        } else {
+            m_rs->queueTextureDeletion(m_glHandle);
+        }
     }
 }
 
@@ -41,9 +45,16 @@ bool Texture::loadImageFromMemory(const uint8_t* data, size_t length) {
 
     LOGTInit();
 
-    m_buffer.reset(stbi_load_from_memory(data, static_cast<int>(length),
-                                         &width, &height, &channelsInFile,
-                                         channelsRequested));
+    // Only the decoded image is taken from the pixel buffer pool
+    if (stbi_info_from_memory(data, static_cast<int>(length), &width, &height, &channelsInFile)) {
+        PixelBuffer::DecodeScope scope(size_t(width) * height * channelsRequested);
+
+        m_buffer.reset(stbi_load_from_memory(data, static_cast<int>(length),
+                                             &width, &height, &channelsInFile,
+                                             channelsRequested));
+    } else {
+        m_buffer.reset();
+    }
 
     if (!m_buffer) {
         LOGE("Could not load image data: %dx%d bpp:%d/%d",
@@ -78,7 +89,7 @@ bool Texture::setPixelData(int _width, int _height, int _bytesPerPixel,
     }
 
     if (!m_buffer) {
-        m_buffer.reset(reinterpret_cast<GLubyte*>(std::malloc(_length)));
+        m_buffer.reset(reinterpret_cast<GLubyte*>(PixelBuffer::allocate(_length)));
     }
 
     if (!m_buffer) {
@@ -126,6 +137,13 @@ bool Texture::upload(RenderState& _rs, GLuint _textureUnit) {
         if (m_disposeBuffer) { m_buffer.reset(); }
         return false;
     }
+
+    bool recycled = false;
+    if (m_glHandle == 0 && m_pool && m_buffer) {
+        m_glHandle = m_pool->take(_rs, m_width, m_height);
+        recycled = (m_glHandle != 0);
+    }
+
     if (m_glHandle == 0) {
         generate(_rs, _textureUnit);
     } else {
@@ -133,8 +151,15 @@ bool Texture::upload(RenderState& _rs, GLuint _textureUnit) {
     }
 
     auto format = static_cast<GLenum>(m_options.pixelFormat);
-    GL::texImage2D(GL_TEXTURE_2D, 0, format, m_width, m_height, 0, format,
-                   GL_UNSIGNED_BYTE, m_buffer.get());
+    if (recycled) {
+        // Recycled textures already have storage of this size and format
+        m_rs = &_rs;
+        GL::texSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, format,
+                          GL_UNSIGNED_BYTE, m_buffer.get());
+    } else {
+        GL::texImage2D(GL_TEXTURE_2D, 0, format, m_width, m_height, 0, format,
+                       GL_UNSIGNED_BYTE, m_buffer.get());
+    }
 
     if (m_buffer && m_options.generateMipmaps) {
         GL::generateMipmap(GL_TEXTURE_2D);
@@ -1,9 +1,9 @@
 #pragma once
 
 #include "gl.h"
+#include "gl/texturePool.h"
 #include "scene/spriteAtlas.h"
 
-#include <cstdlib>
 #include <vector>
 #include <memory>
 #include <string>
@@ -91,6 +91,9 @@ public:
     // Size of texture data in bytes
     size_t bufferSize() const { return m_bufferSize; }
 
+    // Pixel data, until it is disposed after upload
+    const GLubyte* bufferData() const { return m_buffer.get(); }
+
     float displayScale() const { return m_options.displayScale; }
 
     const auto& spriteAtlas() const { return m_spriteAtlas; }
@@ -99,6 +102,10 @@ public:
     // Resize the texture
     void resize(int width, int height);
 
+    // Take the GL texture from _pool when uploading and return it there when
+    // the texture is deleted
+    void setPool(std::shared_ptr<TexturePool> _pool) { m_pool = std::move(_pool); }
+
 protected:
 
     // Bytes per pixel for current PixelFormat options
@@ -117,8 +124,8 @@ protected:
 
     TextureOptions m_options;
 
-    struct malloc_deleter { void operator()(GLubyte* x) { std::free(x); } };
-    using TextureData = std::unique_ptr<GLubyte, malloc_deleter>;
+    struct buffer_deleter { void operator()(GLubyte* x) { PixelBuffer::release(x); } };
+    using TextureData = std::unique_ptr<GLubyte, buffer_deleter>;
     TextureData m_buffer = nullptr;
 
     size_t m_bufferSize = 0;
@@ -134,6 +141,8 @@ protected:
 
     RenderState* m_rs = nullptr;
 
+    std::shared_ptr<TexturePool> m_pool;
+
 private:
 
     std::unique_ptr<SpriteAtlas> m_spriteAtlas;
@@ -0,0 +1,239 @@
+#include "gl/texturePool.h"
+
+#include "gl/renderState.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+namespace Tangram {
+
+namespace PixelBuffer {
+
+// Precedes each block to find its size on release
+struct alignas(std::max_align_t) Header {
+    size_t size;
+    // Decoder memory, freed on release
+    bool scratch;
+};
+
+struct Blocks : std::unordered_map<size_t, std::vector<Header*>> {
+    ~Blocks() {
+        for (auto& size : *this) {
+            for (auto* block : size.second) { std::free(block); }
+        }
+    }
+};
+
+static std::mutex s_mutex;
+static Blocks s_blocks;
+static size_t s_pooledSize = 0;
+static size_t s_capacity = 16 * 1024 * 1024;
+
+// Size of the image decoded on this thread
+static thread_local size_t t_imageSize = 0;
+
+// Decoders may allocate a few bytes more for the image, e.g. the JPEG decoder
+static const size_t max_image_padding = 16;
+
+static bool isImageSize(size_t _size) {
+    return t_imageSize > 0 && _size >= t_imageSize && _size <= t_imageSize + max_image_padding;
+}
+
+static void* data(Header* _header) { return _header + 1; }
+
+static Header* header(void* _buffer) { return static_cast<Header*>(_buffer) - 1; }
+
+static void* allocateBlock(size_t _size, bool _scratch) {
+    auto block = static_cast<Header*>(std::malloc(sizeof(Header) + _size));
+    if (!block) { return nullptr; }
+
+    block->size = _size;
+    block->scratch = _scratch;
+    return data(block);
+}
+
+void* allocate(size_t _size) {
+    if (_size >= min_pooled_size) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        auto it = s_blocks.find(_size);
+        if (it != s_blocks.end() && !it->second.empty()) {
+            Header* block = it->second.back();
+            it->second.pop_back();
+            s_pooledSize -= _size;
+            return data(block);
+        }
+    }
+    return allocateBlock(_size, false);
+}
+
+void* decoderAllocate(size_t _size) {
+    if (isImageSize(_size)) { return allocate(_size); }
+
+    return allocateBlock(_size, true);
+}
+
+void* decoderReallocate(void* _buffer, size_t _size) {
+    if (!_buffer) { return decoderAllocate(_size); }
+
+    Header* block = header(_buffer);
+    if (block->size == _size) { return _buffer; }
+
+    if (!isImageSize(_size) && (block->scratch || block->size < min_pooled_size)) {
+        // Let the allocator grow scratch memory in place
+        block = static_cast<Header*>(std::realloc(block, sizeof(Header) + _size));
+        if (!block) { return nullptr; }
+
+        block->size = _size;
+        block->scratch = true;
+        return data(block);
+    }
+
+    void* buffer = decoderAllocate(_size);
+    if (!buffer) { return nullptr; }
+
+    std::memcpy(buffer, _buffer, std::min(block->size, _size));
+    release(_buffer);
+
+    return buffer;
+}
+
+DecodeScope::DecodeScope(size_t _imageSize) : m_previous(t_imageSize) {
+    t_imageSize = _imageSize;
+}
+
+DecodeScope::~DecodeScope() {
+    t_imageSize = m_previous;
+}
+
+void release(void* _buffer) {
+    if (!_buffer) { return; }
+
+    Header* block = header(_buffer);
+    if (!block->scratch && block->size >= min_pooled_size) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_pooledSize + block->size <= s_capacity) {
+            s_blocks[block->size].push_back(block);
+            s_pooledSize += block->size;
+            return;
+        }
+    }
+    std::free(block);
+}
+
+void setCapacity(size_t _bytes) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_capacity = _bytes;
+
+    for (auto it = s_blocks.begin(); it != s_blocks.end() && s_pooledSize > s_capacity;) {
+        auto& blocks = it->second;
+        while (!blocks.empty() && s_pooledSize > s_capacity) {
+            s_pooledSize -= blocks.back()->size;
+            std::free(blocks.back());
+            blocks.pop_back();
+        }
+        if (blocks.empty()) {
+            it = s_blocks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t pooledSize() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_pooledSize;
+}
+
+}
+
+TexturePool::~TexturePool() {
+    for (auto* rs : m_renderStates) {
+        rs->removeTexturePool(*this);
+    }
+    clear();
+}
+
+GLuint TexturePool::take(RenderState& _rs, int _width, int _height) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_textures.find(Size(_width, _height));
+    if (it == m_textures.end()) { return 0; }
+
+    auto& entries = it->second;
+    for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+        if (entry->rs != &_rs) { continue; }
+
+        GLuint handle = entry->handle;
+        entries.erase(std::next(entry).base());
+        m_count--;
+        return handle;
+    }
+    return 0;
+}
+
+void TexturePool::release(RenderState& _rs, GLuint _handle, int _width, int _height) {
+    if (_handle == 0) { return; }
+
+    bool registered = true;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (std::find(m_renderStates.begin(), m_renderStates.end(), &_rs) == m_renderStates.end()) {
+            m_renderStates.push_back(&_rs);
+            registered = false;
+        }
+    }
+    // Before the texture is kept, so that it is dropped on context loss
+    if (!registered) { _rs.addTexturePool(*this); }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_count < m_maxTextures) {
+            m_textures[Size(_width, _height)].push_back({ &_rs, _handle });
+            m_count++;
+            return;
+        }
+    }
+    _rs.queueTextureDeletion(_handle);
+}
+
+void TexturePool::clear() {
+    decltype(m_textures) textures;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::swap(textures, m_textures);
+        m_count = 0;
+    }
+    for (auto& size : textures) {
+        for (auto& entry : size.second) {
+            entry.rs->queueTextureDeletion(entry.handle);
+        }
+    }
+}
+
+void TexturePool::invalidate(RenderState& _rs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto it = m_textures.begin(); it != m_textures.end();) {
+        auto& entries = it->second;
+        auto end = std::remove_if(entries.begin(), entries.end(),
+                                  [&](auto& entry) { return entry.rs == &_rs; });
+        m_count -= std::distance(end, entries.end());
+        entries.erase(end, entries.end());
+
+        if (entries.empty()) {
+            it = m_textures.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t TexturePool::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+}
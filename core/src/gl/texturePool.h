@@ -0,0 +1,101 @@
+#pragma once
+
+#include "gl.h"
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Tangram {
+
+class RenderState;
+
+// Allocator for texture pixel data. Released blocks of image size are kept
+// and handed out again for the next image of the same size, so that decoding
+// a stream of equally sized raster tiles does not go through malloc and free
+// for every tile. Blocks can be allocated and released from any thread.
+namespace PixelBuffer {
+
+// Blocks below this size are not kept
+constexpr size_t min_pooled_size = 16 * 1024;
+
+void* allocate(size_t _size);
+
+void release(void* _buffer);
+
+// Allocation functions of the image decoder. Only blocks of the size of the
+// image decoded on the calling thread are taken from the pool. Other blocks
+// are scratch memory of the decoder: they grow in place and are freed on
+// release, so they never take the place of image buffers in the pool.
+void* decoderAllocate(size_t _size);
+
+void* decoderReallocate(void* _buffer, size_t _size);
+
+// Sets the size in bytes of the image decoded on this thread for its lifetime
+class DecodeScope {
+public:
+    explicit DecodeScope(size_t _imageSize);
+    ~DecodeScope();
+private:
+    size_t m_previous;
+};
+
+// Sets the number of bytes kept in released blocks
+void setCapacity(size_t _bytes);
+
+// Number of bytes currently kept in released blocks
+size_t pooledSize();
+
+}
+
+// GL textures released by the textures of one source, kept for reuse by
+// textures of the same size. Reused textures keep their storage, so that new
+// pixel data can be uploaded with glTexSubImage2D. All textures sharing a pool
+// must have the same TextureOptions, as the texture parameters are only set
+// once when the texture is generated.
+class TexturePool {
+
+public:
+
+    explicit TexturePool(size_t _maxTextures = 64) : m_maxTextures(_maxTextures) {}
+
+    ~TexturePool();
+
+    // Returns a released texture of the given size for _rs, or 0 when none is
+    // available. Must be called on the GL thread.
+    GLuint take(RenderState& _rs, int _width, int _height);
+
+    // Keeps _handle for reuse or queues it for deletion when the pool is full.
+    // Can be called from any thread.
+    void release(RenderState& _rs, GLuint _handle, int _width, int _height);
+
+    // Queues all kept textures for deletion
+    void clear();
+
+    // Drops the textures of _rs without deleting them, after GL context loss
+    void invalidate(RenderState& _rs);
+
+    size_t size() const;
+
+private:
+
+    struct Entry {
+        RenderState* rs;
+        GLuint handle;
+    };
+
+    using Size = std::pair<int, int>;
+
+    std::map<Size, std::vector<Entry>> m_textures;
+    size_t m_count = 0;
+    size_t m_maxTextures;
+
+    // RenderStates this pool is registered with
+    std::vector<RenderState*> m_renderStates;
+
+    mutable std::mutex m_mutex;
+};
+
+}
@@ -3,14 +3,44 @@
 #include "labels/curvedLabel.h"
 #include "labels/labelSet.h"
 #include "labels/obbBuffer.h"
+#include "labels/repeatGroup.h"
+#include "util/asyncWorker.h"
 #include "util/geom.h"
 #include "view/view.h" // ViewState
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtx/norm.hpp"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace Tangram {
 
+// Minimum number of labels of a tile to split it into partitions
+static const size_t parallel_min_labels = 2048;
+
+static const unsigned int max_partitions = 4;
+
+// Helper threads shared by the colliders of all tile workers. Only one
+// collider at a time uses them, others process their tile sequentially,
+// so that at most max_partitions - 1 threads are added to the tile workers.
+struct ColliderPool {
+    std::mutex busy;
+    std::vector<std::unique_ptr<AsyncWorker>> workers;
+
+    ColliderPool() {
+        for (unsigned int i = 1; i < max_partitions; i++) {
+            workers.push_back(std::make_unique<AsyncWorker>());
+        }
+    }
+
+    static ColliderPool& instance() {
+        static ColliderPool pool;
+        return pool;
+    }
+};
+
 void LabelCollider::addLabels(std::vector<std::unique_ptr<Label>>& _labels) {
 
     for (auto& label : _labels) {
@@ -27,7 +57,7 @@ size_t LabelCollider::filterRepeatGroups(size_t startPos, size_t curPos) {
 
     for (size_t pos = startPos; pos <= curPos; pos = endPos + 1) {
         size_t repeatGroup = m_labels[pos].label->options().repeatGroup;
-        float  threshold2 = pow(m_labels[pos].label->options().repeatDistance, 2);
+        float repeatDistance = m_labels[pos].label->options().repeatDistance;
 
         // Find end of the current repeatGroup
         endPos = pos;
@@ -38,17 +68,19 @@ size_t LabelCollider::filterRepeatGroups(size_t startPos, size_t curPos) {
             }
         }
 
-        for (size_t i = pos; i < endPos; i++) {
-            Label* l1 = m_labels[i].label;
-            if (l1->isOccluded()) { continue; }
+        if (repeatDistance > 0.f) {
+            // Labels are in priority order: a label is occluded when a
+            // visible label before it is within repeatDistance.
+            RepeatGroup group(repeatDistance);
 
-            for (size_t j = i+1; j <= endPos; j++) {
-                Label* l2 = m_labels[j].label;
-                if (l2->isOccluded()) { continue; }
+            for (size_t i = pos; i <= endPos; i++) {
+                Label* l = m_labels[i].label;
+                if (l->isOccluded()) { continue; }
 
-                float d2 = distance2(l1->screenCenter(), l2->screenCenter());
-                if (d2 < threshold2) {
-                    l2->occlude();
+                if (group.within(l->screenCenter(), repeatDistance)) {
+                    l->occlude();
+                } else {
+                    group.insert(l->screenCenter());
                 }
             }
         }
@@ -106,30 +138,7 @@ void LabelCollider::process(TileID _tileID, float _tileInverseScale, float _tile
         _tileSize, // screenTileSize
     };
 
-    m_obbs.clear();
-    m_transforms.clear();
-
-    for (auto it = m_labels.begin(); it != m_labels.end(); ) {
-        auto& entry = *it;
-        auto* label = entry.label;
-        ScreenTransform transform { m_transforms, entry.transform };
-        if (label->updateScreenTransform(mvp, viewState, nullptr, transform)) {
-
-            OBBBuffer obbs { m_obbs, entry.obbs };
-
-            label->obbs(transform, obbs);
-
-            auto aabb = m_obbs[entry.obbs.start].getExtent();
-            for (int i = entry.obbs.start+1; i < entry.obbs.end(); i++) {
-                aabb = unionAABB(aabb, m_obbs[i].getExtent());
-            }
-
-            m_aabbs.push_back(aabb);
-            it++;
-        } else {
-            it = m_labels.erase(it);
-        }
-    }
+    updateScreenTransforms(mvp, viewState);
 
     if (m_labels.empty()) { return; }
 
@@ -199,6 +208,18 @@ void LabelCollider::process(TileID _tileID, float _tileInverseScale, float _tile
     //    when reaching a collision pair with lower priority
     // This allows to remove repeated labels before they occlude other candidates
 
+    // Test the OBBs of colliding AABBs up front when the tile is dense
+    if (m_numPartitions > 1) {
+        m_pairIntersections.resize(m_isect2d.pairs.size());
+
+        parallelFor(m_isect2d.pairs.size(), [&](size_t _begin, size_t _end) {
+            for (size_t i = _begin; i < _end; i++) {
+                auto& pair = m_isect2d.pairs[i];
+                m_pairIntersections[i] = intersects(m_labels[pair.first], m_labels[pair.second]);
+            }
+        });
+    }
+
     size_t repeatGroup = 0;
     size_t lastFilteredLabelIndex = 0;
 
@@ -236,19 +257,10 @@ void LabelCollider::process(TileID _tileID, float _tileInverseScale, float _tile
             continue;
         }
 
-        bool intersection = false;
-        for (int i = e1.obbs.start; i < e1.obbs.end(); i++) {
-            for (int j = e2.obbs.start; j < e2.obbs.end(); j++) {
+        bool intersection = m_pairIntersections.empty()
+            ? intersects(e1, e2)
+            : m_pairIntersections[&pair - &m_isect2d.pairs[0]];
 
-                if (intersect(m_obbs[i], m_obbs[j])) {
-                    intersection = true;
-
-                    // break out of outer loop
-                    i = e1.obbs.end();
-                    break;
-                }
-            }
-        }
         if (!intersection) { continue; }
 
         if (l1->options().priority != l2->options().priority) {
@@ -301,6 +313,139 @@ void LabelCollider::process(TileID _tileID, float _tileInverseScale, float _tile
 
     m_labels.clear();
     m_aabbs.clear();
+    m_pairIntersections.clear();
+}
+
+void LabelCollider::parallelFor(size_t _count, const std::function<void(size_t, size_t)>& _job) {
+
+    auto& pool = ColliderPool::instance();
+
+    std::unique_lock<std::mutex> busy(pool.busy, std::try_to_lock);
+    if (!busy.owns_lock()) {
+        _job(0, _count);
+        return;
+    }
+
+    size_t chunk = (_count + m_numPartitions - 1) / m_numPartitions;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t pending = 0;
+
+    size_t worker = 0;
+    for (size_t begin = chunk; begin < _count; begin += chunk) {
+        size_t end = std::min(begin + chunk, _count);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending++;
+        }
+        pool.workers[worker++ % pool.workers.size()]->enqueue([&, begin, end]() {
+            _job(begin, end);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) { done.notify_one(); }
+        });
+    }
+    _job(0, std::min(chunk, _count));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return pending == 0; });
+}
+
+bool LabelCollider::intersects(const LabelEntry& _e1, const LabelEntry& _e2) const {
+
+    for (int i = _e1.obbs.start; i < _e1.obbs.end(); i++) {
+        for (int j = _e2.obbs.start; j < _e2.obbs.end(); j++) {
+            if (intersect(m_obbs[i], m_obbs[j])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LabelCollider::updatePartition(Partition& _partition, const glm::mat4& _mvp,
+                                    const ViewState& _viewState) {
+
+    _partition.transforms.clear();
+    _partition.obbs.clear();
+    _partition.aabbs.clear();
+    _partition.valid.clear();
+
+    for (size_t i = _partition.begin; i < _partition.end; i++) {
+        auto& entry = m_labels[i];
+        auto* label = entry.label;
+
+        entry.transform = {};
+        entry.obbs = {};
+
+        ScreenTransform transform { _partition.transforms, entry.transform };
+        if (!label->updateScreenTransform(_mvp, _viewState, nullptr, transform)) {
+            _partition.valid.push_back(false);
+            continue;
+        }
+
+        OBBBuffer obbs { _partition.obbs, entry.obbs };
+
+        label->obbs(transform, obbs);
+
+        auto aabb = _partition.obbs[entry.obbs.start].getExtent();
+        for (int j = entry.obbs.start+1; j < entry.obbs.end(); j++) {
+            aabb = unionAABB(aabb, _partition.obbs[j].getExtent());
+        }
+
+        _partition.aabbs.push_back(aabb);
+        _partition.valid.push_back(true);
+    }
+}
+
+void LabelCollider::updateScreenTransforms(const glm::mat4& _mvp, const ViewState& _viewState) {
+
+    // Labels are independent at this stage: split dense tiles into
+    // partitions which are transformed in parallel.
+    m_numPartitions = 1;
+    if (m_parallel && m_labels.size() >= parallel_min_labels) {
+        m_numPartitions = std::max(std::min(std::thread::hardware_concurrency(),
+                                            max_partitions), 1u);
+    }
+
+    // Partitions keep their buffers for the next tile
+    if (m_partitions.size() < m_numPartitions) { m_partitions.resize(m_numPartitions); }
+
+    size_t chunk = (m_labels.size() + m_numPartitions - 1) / m_numPartitions;
+
+    for (size_t i = 0; i < m_numPartitions; i++) {
+        m_partitions[i].begin = std::min(i * chunk, m_labels.size());
+        m_partitions[i].end = std::min((i + 1) * chunk, m_labels.size());
+    }
+
+    parallelFor(m_numPartitions, [&](size_t _begin, size_t _end) {
+        for (size_t i = _begin; i < _end; i++) {
+            updatePartition(m_partitions[i], _mvp, _viewState);
+        }
+    });
+
+    // Merge partitions in label order, dropping labels without transform
+    m_obbs.clear();
+
+    size_t numLabels = 0;
+    for (size_t p = 0; p < m_numPartitions; p++) {
+        auto& partition = m_partitions[p];
+        int obbsOffset = m_obbs.size();
+        m_obbs.insert(m_obbs.end(), partition.obbs.begin(), partition.obbs.end());
+
+        size_t aabb = 0;
+        for (size_t i = partition.begin; i < partition.end; i++) {
+            if (!partition.valid[i - partition.begin]) { continue; }
+
+            auto entry = m_labels[i];
+            entry.obbs.start += obbsOffset;
+            m_labels[numLabels++] = entry;
+
+            m_aabbs.push_back(partition.aabbs[aabb++]);
+        }
+    }
+    m_labels.erase(m_labels.begin() + numLabels, m_labels.end());
 }
 
 }
@@ -7,6 +7,7 @@
 
 #include "isect2d.h"
 #include "glm_vec.h" // for isect2d.h
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -19,6 +20,9 @@ class LabelCollider {
 
 public:
 
+    // Allow splitting dense tiles into partitions that are processed on
+    // shared helper threads. Results are the same either way.
+    void setParallel(bool _parallel) { m_parallel = _parallel; }
 
     void addLabels(std::vector<std::unique_ptr<Label>>& _labels);
 
@@ -46,6 +50,27 @@ private:
         Range transform;
     };
 
+    // Scratch buffers for screen transforms of a range of labels. Dense
+    // tiles are split into partitions that are processed in parallel.
+    struct Partition {
+        size_t begin = 0;
+        size_t end = 0;
+        ScreenTransform::Buffer transforms;
+        std::vector<OBB> obbs;
+        std::vector<AABB> aabbs;
+        std::vector<bool> valid;
+    };
+
+    void updateScreenTransforms(const glm::mat4& _mvp, const ViewState& _viewState);
+
+    void updatePartition(Partition& _partition, const glm::mat4& _mvp, const ViewState& _viewState);
+
+    bool intersects(const LabelEntry& _e1, const LabelEntry& _e2) const;
+
+    // Run _job on m_numPartitions ranges of [0, _count), or on the whole
+    // range when the helper threads are in use by another collider
+    void parallelFor(size_t _count, const std::function<void(size_t, size_t)>& _job);
+
     // Parallel vectors
 
     std::vector<LabelEntry> m_labels;
@@ -54,7 +79,12 @@ private:
 
     isect2d::ISect2D<glm::vec2> m_isect2d;
 
-    ScreenTransform::Buffer m_transforms;
+    std::vector<Partition> m_partitions;
+    size_t m_numPartitions = 1;
+    bool m_parallel = true;
+
+    // OBB intersection of each collision pair, when tested in parallel
+    std::vector<char> m_pairIntersections;
 };
 
 }
@@ -4,6 +4,7 @@
 #include "gl/primitives.h"
 #include "gl/shaderProgram.h"
 #include "labels/curvedLabel.h"
+#include "labels/labelPlacement.h"
 #include "labels/labelSet.h"
 #include "labels/obbBuffer.h"
 #include "labels/textLabel.h"
@@ -24,6 +25,7 @@
 #include "glm/gtx/rotate_vector.hpp"
 #include "glm/gtx/norm.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 namespace Tangram {
@@ -48,7 +50,10 @@ void LabelManager::processLabelUpdate(const ViewState& _viewState, const LabelSe
                       _viewState.viewportSize.x,
                       _viewState.viewportSize.y);
 
+    uint32_t index = 0;
     for (auto& label : _labelSet->getLabels()) {
+        uint32_t labelIndex = index++;
+
         if (!_drawAll && (label->state() == Label::State::dead) ) {
             continue;
         }
@@ -74,13 +79,14 @@ void LabelManager::processLabelUpdate(const ViewState& _viewState, const LabelSe
                 label->addVerticesToMesh(transform, _viewState.viewportSize);
             }
         } else if (label->canOcclude()) {
-            m_labels.emplace_back(label.get(), _style, _tile, _marker, _isProxy, transformRange);
+            m_labels.emplace_back(label.get(), _style, _tile, _marker, _isProxy, transformRange, labelIndex);
         } else {
             m_needUpdate |= label->evalState(_dt);
             label->addVerticesToMesh(transform, _viewState.viewportSize);
         }
         if (label->selectionColor()) {
-            m_selectionLabels.emplace_back(label.get(), _style, _tile, _marker, _isProxy, transformRange);
+            m_selectionLabels.emplace_back(label.get(), _style, _tile, _marker, _isProxy, transformRange,
+                                           labelIndex);
         }
     }
 }
@@ -323,124 +329,392 @@ void LabelManager::handleOcclusions(const ViewState& _viewState) {
     m_isect2d.clear();
     m_repeatGroups.clear();
 
-    using iterator = decltype(m_labels)::const_iterator;
+    for (auto it = m_labels.begin(); it != m_labels.end(); ++it) {
+        placeLabel(it);
+    }
+}
+
+void LabelManager::placeLabel(LabelIterator _entry) {
 
-    // Find the label to which the obb belongs
-    auto findLabel = [](iterator begin, iterator end, int obb) {
-        for (auto it = begin; it != end; it++) {
-            if (obb >= it->obbsRange.start && obb < it->obbsRange.end()) {
-                return it->label;
+    auto& entry = *_entry;
+    auto* l = entry.label;
+
+    // Find the label to which the obb belongs. Labels which have not
+    // been placed yet have an empty obbsRange.
+    auto findLabel = [this](int obb) {
+        for (auto& it : m_labels) {
+            if (obb >= it.obbsRange.start && obb < it.obbsRange.end()) {
+                return it.label;
             }
         }
         assert(false);
         return static_cast<Label*>(nullptr);
     };
 
-    for (auto it = m_labels.begin(); it != m_labels.end(); ++it) {
-        auto& entry = *it;
-        auto* l = entry.label;
+    ScreenTransform transform { m_transforms, entry.transformRange };
+    OBBBuffer obbs { m_obbs, entry.obbsRange };
 
-        ScreenTransform transform { m_transforms, entry.transformRange };
-        OBBBuffer obbs { m_obbs, entry.obbsRange };
+    l->obbs(transform, obbs);
 
-        l->obbs(transform, obbs);
+    // Parent must have been processed earlier so at this point its
+    // occlusion and anchor position is determined for the current frame.
+    if (l->isChild()) {
+        if (l->relative()->isOccluded()) {
+            l->occlude();
+            return;
+        }
+    }
 
-        // Parent must have been processed earlier so at this point its
-        // occlusion and anchor position is determined for the current frame.
-        if (l->isChild()) {
-            if (l->relative()->isOccluded()) {
-                l->occlude();
-                continue;
+    // Skip label if another label of this repeatGroup is
+    // within repeatDistance.
+    if (l->options().repeatDistance > 0.f) {
+        if (withinRepeatDistance(l)) {
+            l->occlude();
+            // If this label is not marked optional, then mark the relative label as occluded
+            if (l->relative() && !l->options().optional) {
+                l->relative()->occlude();
             }
+            return;
         }
+    }
 
-        // Skip label if another label of this repeatGroup is
-        // within repeatDistance.
-        if (l->options().repeatDistance > 0.f) {
-            if (withinRepeatDistance(l)) {
-                l->occlude();
-                // If this label is not marked optional, then mark the relative label as occluded
-                if (l->relative() && !l->options().optional) {
-                    l->relative()->occlude();
-                }
-                continue;
+    int anchorIndex = l->anchorIndex();
+
+    // For each anchor
+    do {
+        if (l->isOccluded()) {
+            // Update OBB for anchor fallback
+            obbs.clear();
+
+            l->obbs(transform, obbs);
+
+            if (anchorIndex == l->anchorIndex()) {
+                // Reached first anchor again
+                break;
             }
         }
 
-        int anchorIndex = l->anchorIndex();
+        l->occlude(false);
 
-        // For each anchor
-        do {
-            if (l->isOccluded()) {
-                // Update OBB for anchor fallback
-                obbs.clear();
+        // Occlude label when its obbs intersect with a previous label.
+        for (auto& obb : obbs) {
+            m_isect2d.intersect(obb.getExtent(), [&](auto& a, auto& b) {
+                    size_t other = reinterpret_cast<size_t>(b.m_userData);
 
-                l->obbs(transform, obbs);
+                    m_stats.collisionTests++;
 
-                if (anchorIndex == l->anchorIndex()) {
-                    // Reached first anchor again
-                    break;
-                }
-            }
+                    if (!intersect(obb, m_obbs[other])) {
+                        return true;
+                    }
+                    // Ignore intersection with relative label
+                    if (l->relative() && l->relative() == findLabel(other)) {
+                        return true;
+                    }
+                    l->occlude();
+                    return false;
 
-            l->occlude(false);
+                }, false);
 
-            // Occlude label when its obbs intersect with a previous label.
-            for (auto& obb : obbs) {
-                m_isect2d.intersect(obb.getExtent(), [&](auto& a, auto& b) {
-                        size_t other = reinterpret_cast<size_t>(b.m_userData);
+            if (l->isOccluded()) { break; }
+        }
+    } while (l->isOccluded() && l->nextAnchor());
 
-                        if (!intersect(obb, m_obbs[other])) {
-                            return true;
-                        }
-                        // Ignore intersection with relative label
-                        if (l->relative() && l->relative() == findLabel(std::begin(m_labels), it, other)) {
-                            return true;
-                        }
-                        l->occlude();
-                        return false;
+    // At this point, the label has a relative that is visible,
+    // if it is not an optional label, turn the relative to occluded
+    if (l->isOccluded()) {
+        if (l->relative() && !l->options().optional) {
+            l->relative()->occlude();
+        }
+    } else {
+        insertLabel(entry);
+    }
+}
 
-                    }, false);
+void LabelManager::insertLabel(LabelEntry& _entry) {
 
-                if (l->isOccluded()) { break; }
-            }
-        } while (l->isOccluded() && l->nextAnchor());
+    auto* l = _entry.label;
 
-        // At this point, the label has a relative that is visible,
-        // if it is not an optional label, turn the relative to occluded
-        if (l->isOccluded()) {
-            if (l->relative() && !l->options().optional) {
-                l->relative()->occlude();
+    // Insert into ISect2D grid
+    int obbPos = _entry.obbsRange.start;
+    for (auto& obb : OBBBuffer{ m_obbs, _entry.obbsRange }) {
+        auto aabb = obb.getExtent();
+        aabb.m_userData = reinterpret_cast<void*>(obbPos++);
+        m_isect2d.insert(aabb);
+    }
+
+    float repeatDistance = l->options().repeatDistance;
+    if (repeatDistance > 0.f) {
+        auto it = m_repeatGroups.emplace(l->options().repeatGroup, RepeatGroup(repeatDistance)).first;
+        it->second.insert(l->screenCenter());
+    }
+}
+
+LabelManager::PlacementKey::PlacementKey(const LabelEntry& _entry) : index(_entry.index) {
+    if (_entry.tile) {
+        tileId = _entry.tile->getID();
+        sourceId = _entry.tile->sourceID();
+    }
+    if (_entry.marker) { markerId = _entry.marker->id(); }
+    if (_entry.style) { styleId = _entry.style->getID(); }
+}
+
+size_t LabelManager::PlacementKeyHash::operator()(const PlacementKey& _key) const {
+    size_t seed = 0;
+    hash_combine(seed, _key.tileId.x);
+    hash_combine(seed, _key.tileId.y);
+    hash_combine(seed, int32_t(_key.tileId.z));
+    hash_combine(seed, int32_t(_key.tileId.s));
+    hash_combine(seed, _key.sourceId);
+    hash_combine(seed, _key.markerId);
+    hash_combine(seed, _key.styleId);
+    hash_combine(seed, _key.index);
+    return seed;
+}
+
+bool LabelManager::handleOcclusionsIncremental(const ViewState& _viewState) {
+
+    if (m_placements.empty() ||
+        _viewState.zoom != m_placementZoom ||
+        _viewState.viewportSize != m_placementViewport) {
+        return false;
+    }
+
+    // Squared distance in pixels a label may move relative to the view
+    // and still keep its placement
+    const float reuseThreshold2 = 1.f;
+
+    // A label keeps its placement when it moved by the same screen offset
+    // as the other labels, i.e. when the view was only panned. The pan
+    // offset is the median of the offsets of all labels, so that labels
+    // moving on their own (e.g. animated markers) do not affect it. Labels
+    // of new tiles have no placement yet.
+    std::vector<float> dx, dy;
+    for (auto& entry : m_labels) {
+        auto it = m_placements.find(PlacementKey(entry));
+        if (it == m_placements.end()) { continue; }
+
+        glm::vec2 delta = entry.label->screenCenter() - it->second.screenCenter;
+        dx.push_back(delta.x);
+        dy.push_back(delta.y);
+    }
+    if (dx.empty()) { return false; }
+
+    std::nth_element(dx.begin(), dx.begin() + dx.size() / 2, dx.end());
+    std::nth_element(dy.begin(), dy.begin() + dy.size() / 2, dy.end());
+    glm::vec2 offset(dx[dx.size() / 2], dy[dy.size() / 2]);
+
+    size_t numReused = 0;
+
+    for (auto& entry : m_labels) {
+        entry.reuse = Reuse::none;
+
+        auto it = m_placements.find(PlacementKey(entry));
+        if (it == m_placements.end()) { continue; }
+
+        glm::vec2 delta = entry.label->screenCenter() - it->second.screenCenter;
+        if (glm::length2(delta - offset) > reuseThreshold2) { continue; }
+
+        it->second.reused = true;
+        entry.reuse = it->second.occluded ? Reuse::occluded : Reuse::visible;
+        numReused++;
+    }
+
+    // Too many labels changed: resolve all occlusions again.
+    if (numReused < m_labels.size() - m_labels.size() / 4) {
+        return false;
+    }
+
+    // Children can only keep their placement together with their parent:
+    // visible children need a visible parent and occluded children are
+    // tested again when their parent is placed again. Repeat until stable,
+    // since a parent may itself be a child.
+    std::unordered_map<const Label*, Reuse> reuse;
+    for (auto& entry : m_labels) { reuse[entry.label] = entry.reuse; }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto& entry : m_labels) {
+            if (entry.reuse == Reuse::none || !entry.label->relative()) { continue; }
+
+            auto it = reuse.find(entry.label->relative());
+            Reuse parent = it == reuse.end() ? Reuse::none : it->second;
+
+            if (parent == Reuse::none ||
+                (entry.reuse == Reuse::visible && parent != Reuse::visible)) {
+                entry.reuse = Reuse::none;
+                reuse[entry.label] = Reuse::none;
+                changed = true;
             }
+        }
+    }
+
+    size_t numVisible = 0;
+    for (auto& entry : m_labels) {
+        if (entry.reuse == Reuse::visible) { numVisible++; }
+    }
+
+    // When labels that were visible are gone, the labels they occluded
+    // may fit now.
+    bool freedSpace = numVisible < m_numPlacedVisible;
+
+    m_isect2d.clear();
+    m_repeatGroups.clear();
+
+    // Insert labels that keep their placement first, so that labels
+    // entering the view do not displace them.
+    for (auto& entry : m_labels) {
+        if (entry.reuse == Reuse::occluded && freedSpace) {
+            entry.reuse = Reuse::none;
+        }
+        if (entry.reuse == Reuse::none) { continue; }
+
+        ScreenTransform transform { m_transforms, entry.transformRange };
+        OBBBuffer obbs { m_obbs, entry.obbsRange };
+
+        entry.label->obbs(transform, obbs);
+
+        if (entry.reuse == Reuse::occluded) {
+            entry.label->occlude();
         } else {
-            // Insert into ISect2D grid
-            int obbPos = entry.obbsRange.start;
-            for (auto& obb : obbs) {
-                auto aabb = obb.getExtent();
-                aabb.m_userData = reinterpret_cast<void*>(obbPos++);
-                m_isect2d.insert(aabb);
-            }
+            entry.label->occlude(false);
+            insertLabel(entry);
+        }
+    }
 
-            if (l->options().repeatDistance > 0.f) {
-                m_repeatGroups[l->options().repeatGroup].push_back(l);
-            }
+    for (auto it = m_labels.begin(); it != m_labels.end(); ++it) {
+        if (it->reuse == Reuse::none) {
+            placeLabel(it);
         }
     }
+
+    return true;
+}
+
+void LabelManager::storePlacements(const ViewState& _viewState) {
+
+    m_placements.clear();
+    m_numPlacedVisible = 0;
+
+    for (auto& entry : m_labels) {
+        bool occluded = entry.label->isOccluded();
+        m_placements[PlacementKey(entry)] = { entry.label->screenCenter(), occluded, false };
+        if (!occluded) { m_numPlacedVisible++; }
+    }
+
+    m_placementZoom = _viewState.zoom;
+    m_placementViewport = _viewState.viewportSize;
+}
+
+void LabelManager::setIncrementalPlacement(bool _enable) {
+    m_incrementalPlacement = _enable;
+    m_placements.clear();
 }
 
 bool LabelManager::withinRepeatDistance(Label *_label) {
-    float threshold2 = pow(_label->options().repeatDistance, 2);
 
     auto it = m_repeatGroups.find(_label->options().repeatGroup);
     if (it != m_repeatGroups.end()) {
-        for (auto* ll : it->second) {
-            float d2 = glm::distance2(_label->screenCenter(), ll->screenCenter());
-            if (d2 < threshold2) {
-                return true;
+        return it->second.within(_label->screenCenter(), _label->options().repeatDistance);
+    }
+    return false;
+}
+
+void LabelManager::setAsyncPlacement(bool _enable) {
+    if (_enable == bool(m_asyncPlacement)) { return; }
+
+    if (_enable) {
+        m_asyncPlacement = std::make_unique<LabelPlacement>();
+    } else {
+        m_asyncPlacement.reset();
+    }
+    m_placementDirty = true;
+}
+
+bool LabelManager::placementPending() const {
+    return m_asyncPlacement && (m_placementDirty || m_asyncPlacement->isRunning());
+}
+
+void LabelManager::applyAsyncPlacement() {
+
+    m_asyncPlacement->update();
+
+    for (auto& entry : m_labels) {
+        auto* l = entry.label;
+
+        // Labels that were not part of the last placement stay hidden until
+        // a placement including them completes.
+        auto* result = m_asyncPlacement->result(l);
+        if (!result) {
+            l->occlude();
+        } else {
+            if (result->anchorIndex != l->anchorIndex()) {
+                l->setAnchorIndex(result->anchorIndex);
             }
+            l->occlude(result->occluded);
         }
+
+        ScreenTransform transform { m_transforms, entry.transformRange };
+        OBBBuffer obbs { m_obbs, entry.obbsRange };
+
+        l->obbs(transform, obbs);
     }
-    return false;
+}
+
+void LabelManager::submitAsyncPlacement(const ViewState& _viewState,
+                                        const std::vector<std::shared_ptr<Tile>>& _tiles,
+                                        const std::vector<std::unique_ptr<Marker>>& _markers) {
+
+    auto* snapshot = m_asyncPlacement->beginSnapshot();
+    if (!snapshot) { return; }
+
+    m_candidateIndex.clear();
+    for (size_t i = 0; i < m_labels.size(); i++) {
+        m_candidateIndex[m_labels[i].label] = i;
+    }
+
+    for (auto& entry : m_labels) {
+        auto* l = entry.label;
+        auto& options = l->options();
+
+        int relative = -1;
+        if (l->relative()) {
+            auto it = m_candidateIndex.find(l->relative());
+            if (it != m_candidateIndex.end()) { relative = it->second; }
+        }
+
+        // Collect the OBBs of all anchors, the worker can not modify the label
+        int anchorIndex = l->anchorIndex();
+        int numAnchors = std::max(int(options.anchors.count), 1);
+        Range anchors(snapshot->anchors.size(), numAnchors);
+
+        for (int a = 0; a < numAnchors; a++) {
+            if (numAnchors > 1) { l->setAnchorIndex(a); }
+
+            Range range;
+            ScreenTransform transform { m_transforms, entry.transformRange };
+            OBBBuffer obbs { snapshot->obbs, range };
+            l->obbs(transform, obbs);
+
+            snapshot->anchors.push_back(range);
+        }
+        if (numAnchors > 1) { l->setAnchorIndex(anchorIndex); }
+
+        snapshot->candidates.push_back({ l, relative, anchors, anchorIndex,
+                    options.repeatGroup, options.repeatDistance,
+                    l->screenCenter(), options.optional });
+    }
+
+    snapshot->viewportSize = _viewState.viewportSize;
+    snapshot->tiles = _tiles;
+    for (auto& marker : _markers) {
+        if (marker->sharedMesh()) {
+            snapshot->markerMeshes.push_back(marker->sharedMesh());
+        }
+    }
+
+    m_asyncPlacement->submit();
+    m_placementDirty = false;
 }
 
 void LabelManager::updateLabelSet(const ViewState& _viewState, float _dt, const Scene& _scene,
@@ -448,6 +722,24 @@ void LabelManager::updateLabelSet(const ViewState& _viewState, float _dt, const
                             const std::vector<std::unique_ptr<Marker>>& _markers,
                             TileManager& _tileManager) {
 
+    m_placementDirty = true;
+
+    placeLabels(_viewState, _dt, _scene, _tiles, _markers, _tileManager);
+}
+
+void LabelManager::applyPendingPlacement(const ViewState& _viewState, float _dt, const Scene& _scene,
+                                         const std::vector<std::shared_ptr<Tile>>& _tiles,
+                                         const std::vector<std::unique_ptr<Marker>>& _markers,
+                                         TileManager& _tileManager) {
+
+    placeLabels(_viewState, _dt, _scene, _tiles, _markers, _tileManager);
+}
+
+void LabelManager::placeLabels(const ViewState& _viewState, float _dt, const Scene& _scene,
+                               const std::vector<std::shared_ptr<Tile>>& _tiles,
+                               const std::vector<std::unique_ptr<Marker>>& _markers,
+                               TileManager& _tileManager) {
+
     m_transforms.clear();
     m_obbs.clear();
 
@@ -456,6 +748,9 @@ void LabelManager::updateLabelSet(const ViewState& _viewState, float _dt, const
 
     std::sort(m_labels.begin(), m_labels.end(), LabelManager::priorityComparator);
 
+    m_stats.labels = m_labels.size();
+    m_stats.collisionTests = 0;
+
     /// Mark labels to skip transitions
 
     if (int(m_lastZoom) != int(_viewState.zoom)) {
@@ -466,7 +761,20 @@ void LabelManager::updateLabelSet(const ViewState& _viewState, float _dt, const
     m_isect2d.resize({_viewState.viewportSize.x / 256, _viewState.viewportSize.y / 256},
                      {_viewState.viewportSize.x, _viewState.viewportSize.y});
 
-    handleOcclusions(_viewState);
+    if (m_asyncPlacement) {
+        applyAsyncPlacement();
+
+        if (m_placementDirty) {
+            submitAsyncPlacement(_viewState, _tiles, _markers);
+        }
+    } else if (!m_incrementalPlacement) {
+        handleOcclusions(_viewState);
+    } else {
+        if (!handleOcclusionsIncremental(_viewState)) {
+            handleOcclusions(_viewState);
+        }
+        storePlacements(_viewState);
+    }
 
     // Update label state
     for (auto& entry : m_labels) {
@@ -492,6 +800,9 @@ void LabelManager::updateLabelSet(const ViewState& _viewState, float _dt, const
             }
         }
     }
+
+    // Keep updating until the running placement is applied
+    m_needUpdate |= placementPending();
 }
 
 void LabelManager::drawDebug(RenderState& rs, const View& _view) {
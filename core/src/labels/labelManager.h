@@ -2,6 +2,7 @@
 
 #include "data/properties.h"
 #include "labels/label.h"
+#include "labels/repeatGroup.h"
 #include "labels/screenTransform.h"
 #include "labels/spriteLabel.h"
 #include "tile/tileID.h"
@@ -19,6 +20,7 @@
 namespace Tangram {
 
 class FontContext;
+class LabelPlacement;
 class LabelSet;
 class Marker;
 class Tile;
@@ -51,6 +53,34 @@ public:
 
     bool needUpdate() const { return m_needUpdate; }
 
+    struct Stats {
+        // Label candidates of the last placement
+        size_t labels = 0;
+        // OBB intersection tests of the last placement
+        size_t collisionTests = 0;
+    };
+
+    const Stats& stats() const { return m_stats; }
+
+    /* incrementalPlacement: keep the placement of labels that moved along with the view
+     * (e.g. while panning) and only resolve occlusions for labels that appeared or changed.
+     */
+    void setIncrementalPlacement(bool _enable);
+
+    /* asyncPlacement: resolve label occlusions on a helper thread. Labels are placed
+     * according to the last completed placement until the next one is available.
+     */
+    void setAsyncPlacement(bool _enable);
+
+    // Whether updateLabelSet() needs to be called to apply or start a placement
+    // even when the view and tiles have not changed
+    bool placementPending() const;
+
+    void applyPendingPlacement(const ViewState& _viewState, float _dt, const Scene& _scene,
+                               const std::vector<std::shared_ptr<Tile>>& _tiles,
+                               const std::vector<std::unique_ptr<Marker>>& _markers,
+                               TileManager& _tileManager);
+
     std::pair<Label*, const Tile*> getLabel(uint32_t _selectionColor) const;
 
 protected:
@@ -67,6 +97,23 @@ protected:
 
     void handleOcclusions(const ViewState& _viewState);
 
+    // Returns false when the last placement can not be reused for the current frame
+    bool handleOcclusionsIncremental(const ViewState& _viewState);
+
+    void storePlacements(const ViewState& _viewState);
+
+    // Apply the last completed async placement to the current labels
+    void applyAsyncPlacement();
+
+    void submitAsyncPlacement(const ViewState& _viewState,
+                              const std::vector<std::shared_ptr<Tile>>& _tiles,
+                              const std::vector<std::unique_ptr<Marker>>& _markers);
+
+    void placeLabels(const ViewState& _viewState, float _dt, const Scene& _scene,
+                     const std::vector<std::shared_ptr<Tile>>& _tiles,
+                     const std::vector<std::unique_ptr<Marker>>& _markers,
+                     TileManager& _tileManager);
+
     bool withinRepeatDistance(Label *_label);
 
     void processLabelUpdate(const ViewState& _viewState, const LabelSet* _labelSet, Style* _style,
@@ -75,18 +122,27 @@ protected:
 
     bool m_needUpdate;
 
+    Stats m_stats;
+
     isect2d::ISect2D<glm::vec2> m_isect2d;
 
+    enum class Reuse : uint8_t {
+        none,     // Resolve occlusion
+        visible,  // Keep visible placement of the last frame
+        occluded, // Keep occluded
+    };
+
     struct LabelEntry {
 
         LabelEntry(Label* _label, Style* _style, const Tile* _tile, const Marker* _marker,
-                   bool _proxy, Range _screenTransform)
+                   bool _proxy, Range _screenTransform, uint32_t _index = 0)
             : label(_label),
               style(_style),
               tile(_tile),
               marker(_marker),
               priority(_label->options().priority),
               proxy(_proxy),
+              index(_index),
               transformRange(_screenTransform) {}
 
         Label* label;
@@ -95,11 +151,21 @@ protected:
         const Marker* marker;
         float priority;
         bool proxy;
+        // Index of the label in the LabelSet of its tile or marker
+        uint32_t index;
 
         Range transformRange;
         Range obbsRange;
+
+        Reuse reuse = Reuse::none;
     };
 
+    using LabelIterator = std::vector<LabelEntry>::iterator;
+
+    void placeLabel(LabelIterator _entry);
+
+    void insertLabel(LabelEntry& _entry);
+
     static bool priorityComparator(const LabelEntry& _a, const LabelEntry& _b);
 
     static bool zOrderComparator(const LabelEntry& _a, const LabelEntry& _b);
@@ -110,9 +176,50 @@ protected:
     std::vector<LabelEntry> m_labels;
     std::vector<LabelEntry> m_selectionLabels;
 
-    std::unordered_map<size_t, std::vector<Label*>> m_repeatGroups;
+    std::unordered_map<size_t, RepeatGroup> m_repeatGroups;
 
     float m_lastZoom;
+
+    struct Placement {
+        glm::vec2 screenCenter;
+        bool occluded;
+        bool reused;
+    };
+
+    // Identifies a label across frames by its owner rather than by its
+    // address, which may be taken by a new label once the tile is gone
+    struct PlacementKey {
+        TileID tileId = { 0, 0, 0 };
+        int32_t sourceId = 0;
+        MarkerID markerId = 0;
+        uint32_t styleId = 0;
+        uint32_t index = 0;
+
+        PlacementKey(const LabelEntry& _entry);
+
+        bool operator==(const PlacementKey& _other) const {
+            return tileId == _other.tileId && sourceId == _other.sourceId &&
+                markerId == _other.markerId && styleId == _other.styleId &&
+                index == _other.index;
+        }
+    };
+
+    struct PlacementKeyHash {
+        size_t operator()(const PlacementKey& _key) const;
+    };
+
+    // Label placements of the last frame, used for incremental placement
+    std::unordered_map<PlacementKey, Placement, PlacementKeyHash> m_placements;
+    size_t m_numPlacedVisible = 0;
+    float m_placementZoom = 0.f;
+    glm::vec2 m_placementViewport;
+
+    bool m_incrementalPlacement = false;
+
+    std::unique_ptr<LabelPlacement> m_asyncPlacement;
+    std::unordered_map<const Label*, int> m_candidateIndex;
+    // Labels changed since the last submitted async placement
+    bool m_placementDirty = false;
 };
 
 }
@@ -0,0 +1,180 @@
+#include "labels/labelPlacement.h"
+
+#include "style/style.h"
+#include "tile/tile.h"
+#include "util/asyncWorker.h"
+
+namespace Tangram {
+
+void LabelPlacement::Snapshot::clear() {
+    candidates.clear();
+    anchors.clear();
+    obbs.clear();
+    tiles.clear();
+    markerMeshes.clear();
+}
+
+LabelPlacement::LabelPlacement()
+    : m_worker(std::make_unique<AsyncWorker>()) {}
+
+LabelPlacement::~LabelPlacement() {
+    // Join the worker before the buffers it uses are released
+    m_worker.reset();
+}
+
+LabelPlacement::Snapshot* LabelPlacement::beginSnapshot() {
+    if (m_running) { return nullptr; }
+
+    m_snapshot.clear();
+    return &m_snapshot;
+}
+
+void LabelPlacement::submit() {
+    m_running = true;
+
+    m_worker->enqueue([this]() {
+        process();
+        m_completed = true;
+    });
+}
+
+bool LabelPlacement::update() {
+    if (!m_completed) { return false; }
+
+    m_placement.clear();
+    for (size_t i = 0; i < m_results.size(); i++) {
+        m_placement[m_snapshot.candidates[i].label] = m_results[i];
+    }
+    // The previous owners are released only now, their labels are no
+    // longer referenced by m_placement
+    m_placementTiles.swap(m_snapshot.tiles);
+    m_placementMeshes.swap(m_snapshot.markerMeshes);
+    m_snapshot.clear();
+
+    m_completed = false;
+    m_running = false;
+
+    return true;
+}
+
+const LabelPlacement::Result* LabelPlacement::result(const Label* _label) const {
+    auto it = m_placement.find(_label);
+    if (it == m_placement.end()) { return nullptr; }
+
+    return &it->second;
+}
+
+bool LabelPlacement::withinRepeatDistance(const Candidate& _candidate) const {
+
+    auto it = m_repeatGroups.find(_candidate.repeatGroup);
+    if (it != m_repeatGroups.end()) {
+        return it->second.within(_candidate.screenCenter, _candidate.repeatDistance);
+    }
+    return false;
+}
+
+void LabelPlacement::process() {
+
+    // This follows LabelManager::handleOcclusions(), operating on the
+    // snapshot instead of the labels.
+
+    auto& candidates = m_snapshot.candidates;
+    auto& obbs = m_snapshot.obbs;
+    auto& viewportSize = m_snapshot.viewportSize;
+
+    m_results.clear();
+    m_repeatGroups.clear();
+
+    m_obbOwner.assign(obbs.size(), -1);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        auto& anchors = candidates[i].anchors;
+        for (int a = anchors.start; a < anchors.end(); a++) {
+            auto& range = m_snapshot.anchors[a];
+            for (int o = range.start; o < range.end(); o++) {
+                m_obbOwner[o] = i;
+            }
+        }
+    }
+
+    m_isect2d.resize({viewportSize.x / 256, viewportSize.y / 256},
+                     {viewportSize.x, viewportSize.y});
+    m_isect2d.clear();
+
+    for (auto& candidate : candidates) {
+        m_results.push_back({ false, candidate.anchorIndex });
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        auto& candidate = candidates[i];
+        auto& result = m_results[i];
+
+        if (candidate.relative >= 0 && m_results[candidate.relative].occluded) {
+            result.occluded = true;
+            continue;
+        }
+
+        if (candidate.repeatDistance > 0.f && withinRepeatDistance(candidate)) {
+            result.occluded = true;
+            if (candidate.relative >= 0 && !candidate.optional) {
+                m_results[candidate.relative].occluded = true;
+            }
+            continue;
+        }
+
+        int numAnchors = candidate.anchors.length;
+        bool occluded = true;
+
+        // Try each anchor, starting with the current one
+        for (int k = 0; k < numAnchors && occluded; k++) {
+            int anchor = (candidate.anchorIndex + k) % numAnchors;
+            auto& range = m_snapshot.anchors[candidate.anchors.start + anchor];
+
+            occluded = false;
+
+            for (int o = range.start; o < range.end() && !occluded; o++) {
+                auto& obb = obbs[o];
+
+                m_isect2d.intersect(obb.getExtent(), [&](auto& a, auto& b) {
+                        size_t other = reinterpret_cast<size_t>(b.m_userData);
+
+                        if (!intersect(obb, obbs[other])) {
+                            return true;
+                        }
+                        // Ignore intersection with relative label
+                        if (candidate.relative >= 0 && candidate.relative == m_obbOwner[other]) {
+                            return true;
+                        }
+                        occluded = true;
+                        return false;
+
+                    }, false);
+            }
+
+            if (!occluded) { result.anchorIndex = anchor; }
+        }
+
+        result.occluded = occluded;
+
+        if (occluded) {
+            if (candidate.relative >= 0 && !candidate.optional) {
+                m_results[candidate.relative].occluded = true;
+            }
+            continue;
+        }
+
+        auto& range = m_snapshot.anchors[candidate.anchors.start + result.anchorIndex];
+        for (int o = range.start; o < range.end(); o++) {
+            auto aabb = obbs[o].getExtent();
+            aabb.m_userData = reinterpret_cast<void*>(o);
+            m_isect2d.insert(aabb);
+        }
+
+        if (candidate.repeatDistance > 0.f) {
+            auto it = m_repeatGroups.emplace(candidate.repeatGroup,
+                                             RepeatGroup(candidate.repeatDistance)).first;
+            it->second.insert(candidate.screenCenter);
+        }
+    }
+}
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "labels/repeatGroup.h"
+#include "util/types.h"
+
+#include "glm_vec.h" // for isect2d.h
+#include "isect2d.h"
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Tangram {
+
+class AsyncWorker;
+class Label;
+class Tile;
+struct StyledMesh;
+
+// LabelPlacement resolves label occlusions on a helper thread.
+//
+// The render thread fills a Snapshot with the label candidates in priority
+// order and the OBBs of all their anchors, then submits it. While the
+// placement runs, the render thread keeps applying the result of the last
+// completed placement; labels that are not part of it stay hidden until a
+// later placement includes them.
+class LabelPlacement {
+
+public:
+
+    using OBB = isect2d::OBB<glm::vec2>;
+
+    struct Candidate {
+        // Only used as key for the result, never dereferenced by the worker
+        const Label* label;
+        // Index of the relative candidate or -1
+        int relative;
+        // Range in Snapshot::anchors
+        Range anchors;
+        // Anchor index when the snapshot was taken
+        int anchorIndex;
+        size_t repeatGroup;
+        float repeatDistance;
+        glm::vec2 screenCenter;
+        bool optional;
+    };
+
+    struct Snapshot {
+        std::vector<Candidate> candidates;
+        // Range in obbs for each anchor of a candidate
+        std::vector<Range> anchors;
+        std::vector<OBB> obbs;
+        glm::vec2 viewportSize;
+        // Owners of the candidate labels. They are kept alive while the
+        // placement is running and while its result is in use, so that the
+        // addresses of their labels can not be taken by new labels.
+        std::vector<std::shared_ptr<Tile>> tiles;
+        std::vector<std::shared_ptr<StyledMesh>> markerMeshes;
+
+        void clear();
+    };
+
+    struct Result {
+        bool occluded;
+        int anchorIndex;
+    };
+
+    LabelPlacement();
+
+    ~LabelPlacement();
+
+    // Returns the snapshot to fill for the next placement or nullptr while
+    // a placement is running.
+    Snapshot* beginSnapshot();
+
+    // Start placement of the snapshot returned by beginSnapshot()
+    void submit();
+
+    // Swap in the result of a completed placement. Returns true when the
+    // result changed.
+    bool update();
+
+    // Result of the last completed placement for _label or nullptr
+    const Result* result(const Label* _label) const;
+
+    bool isRunning() const { return m_running; }
+
+private:
+
+    void process();
+
+    bool withinRepeatDistance(const Candidate& _candidate) const;
+
+    // Written by the render thread while no placement is running
+    Snapshot m_snapshot;
+
+    // Back buffer, written by the worker
+    std::vector<Result> m_results;
+    std::vector<int> m_obbOwner;
+    std::unordered_map<size_t, RepeatGroup> m_repeatGroups;
+    isect2d::ISect2D<glm::vec2> m_isect2d;
+
+    // Front buffer, read by the render thread
+    std::unordered_map<const Label*, Result> m_placement;
+    // Owners of the labels in m_placement
+    std::vector<std::shared_ptr<Tile>> m_placementTiles;
+    std::vector<std::shared_ptr<StyledMesh>> m_placementMeshes;
+
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_completed{false};
+
+    std::unique_ptr<AsyncWorker> m_worker;
+};
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "glm/vec2.hpp"
+#include "glm/gtx/norm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Tangram {
+
+// Spatial hash of the screen positions of placed labels of one repeat group.
+// The cell size is the repeat distance of the group, so a lookup only visits
+// the neighbouring cells instead of all labels of the group.
+class RepeatGroup {
+
+public:
+
+    explicit RepeatGroup(float _cellSize) : m_cellSize(_cellSize) {}
+
+    void insert(glm::vec2 _position) {
+        m_cells[key(cell(_position.x), cell(_position.y))].push_back(_position);
+    }
+
+    // Returns true when a position within _distance of _position was inserted
+    bool within(glm::vec2 _position, float _distance) const {
+        float threshold2 = _distance * _distance;
+
+        // Labels of a group normally share the repeat distance, but
+        // handle larger distances by visiting more cells.
+        int32_t radius = std::max(int32_t(std::ceil(_distance / m_cellSize)), 1);
+
+        int32_t cx = cell(_position.x);
+        int32_t cy = cell(_position.y);
+
+        for (int32_t y = cy - radius; y <= cy + radius; y++) {
+            for (int32_t x = cx - radius; x <= cx + radius; x++) {
+                auto it = m_cells.find(key(x, y));
+                if (it == m_cells.end()) { continue; }
+
+                for (auto& p : it->second) {
+                    if (glm::distance2(_position, p) < threshold2) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    bool empty() const { return m_cells.empty(); }
+
+private:
+
+    int32_t cell(float _v) const { return int32_t(std::floor(_v / m_cellSize)); }
+
+    static uint64_t key(int32_t _x, int32_t _y) {
+        return (uint64_t(uint32_t(_x)) << 32) | uint32_t(_y);
+    }
+
+    float m_cellSize;
+    std::unordered_map<uint64_t, std::vector<glm::vec2>> m_cells;
+};
+
+}
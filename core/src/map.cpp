@@ -328,8 +328,15 @@ void Map::render() {
     }
 
     // Render scene
+    renderState.beginFrame();
+
     bool drawnAnimatedStyle = scene.render(renderState, view);
 
+    if (renderState.endFrame()) {
+        // Continue uploads and update proxies of uploaded tiles
+        platform->requestRender();
+    }
+
     if (scene.animated() != Scene::animate::no &&
         drawnAnimatedStyle != platform->isContinuousRendering()) {
         platform->setContinuousRendering(drawnAnimatedStyle);
@@ -860,6 +867,10 @@ void Map::setPickRadius(float _radius) {
     impl->pickRadius = _radius;
 }
 
+void Map::setMeshUploadTime(float _milliseconds) {
+    impl->renderState.setUploadTargetDuration(_milliseconds / 1000.f);
+}
+
 void Map::pickFeatureAt(float _x, float _y, int _identifier, FeaturePickCallback _onFeaturePickCallback) {
     impl->selectionQueries.push_back({{_x, _y}, impl->pickRadius, _identifier, _onFeaturePickCallback});
     platform->requestRender();
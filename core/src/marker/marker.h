@@ -100,6 +100,10 @@ public:
 
     StyledMesh* mesh() const;
 
+    // Shared with the async label placement, which keeps the labels of the
+    // mesh alive while its result refers to them
+    const std::shared_ptr<StyledMesh>& sharedMesh() const { return m_mesh; }
+
     DrawRule* drawRule() const;
 
     Feature* feature() const;
@@ -134,7 +138,7 @@ public:
     }
 
     std::unique_ptr<Feature> m_feature;
-    std::unique_ptr<StyledMesh> m_mesh;
+    std::shared_ptr<StyledMesh> m_mesh;
     std::unique_ptr<Texture> m_texture;
     std::unique_ptr<DrawRuleMergeSet> m_drawRuleSet;
     std::unique_ptr<DrawRuleData> m_drawRuleData;
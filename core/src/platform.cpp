@@ -1,6 +1,7 @@
 #include "platform.h"
 #include "log.h"
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <cassert>
@@ -68,16 +69,21 @@ void Platform::shutdown() {
                 response.error = shutdown_message;
                 request.callback(std::move(response));
             }
+        }
+        m_urlCallbacks.clear();
 
-            if (request.cancelable) {
-                cancelUrlRequestImpl(request.id);
+        for (auto& entry : m_urlTransfers) {
+            auto& transfer = entry.second;
+            if (transfer.cancelable) {
+                cancelUrlRequestImpl(transfer.id);
             }
         }
-        m_urlCallbacks.clear();
+        m_urlTransfers.clear();
+        m_urlTransferByUrl.clear();
     }
 }
 
-UrlRequestHandle Platform::startUrlRequest(Url _url, UrlCallback&& _callback) {
+UrlRequestHandle Platform::startUrlRequest(Url _url, UrlCallback&& _callback, double _priority) {
 
     assert(_callback);
 
@@ -88,19 +94,63 @@ UrlRequestHandle Platform::startUrlRequest(Url _url, UrlCallback&& _callback) {
         return 0;
     }
 
-    UrlRequestHandle handle= ++m_urlRequestCount;
+    UrlRequestHandle handle = ++m_urlRequestCount;
+    UrlRequestHandle transferHandle = 0;
+    bool startTransfer = false;
+    bool raised = false;
+    UrlRequestId raisedId = 0;
 
-    // Need to do this in advance in case startUrlRequest calls back synchronously.
-    UrlRequestEntry* entry = nullptr;
     {
         std::lock_guard<std::mutex> lock(m_callbackMutex);
-        auto it = m_urlCallbacks.emplace(handle, UrlRequestEntry{std::move(_callback), 0, false});
-        entry = &it.first->second;
+
+        auto it = m_urlTransferByUrl.find(_url.string());
+        if (it != m_urlTransferByUrl.end()) {
+            // Share the transfer that is already in flight for this URL
+            transferHandle = it->second;
+            auto& transfer = m_urlTransfers[transferHandle];
+            transfer.requests.push_back(handle);
+
+            if (_priority < transfer.priority) {
+                transfer.priority = _priority;
+                raised = transfer.cancelable;
+                raisedId = transfer.id;
+            }
+        } else {
+            // Need to do this in advance in case startUrlRequestImpl calls back synchronously.
+            transferHandle = ++m_urlRequestCount;
+            m_urlTransfers.emplace(transferHandle, UrlTransfer{_url.string(), 0, false, _priority, {handle}});
+            m_urlTransferByUrl.emplace(_url.string(), transferHandle);
+            startTransfer = true;
+        }
+        m_urlCallbacks.emplace(handle, UrlRequestEntry{std::move(_callback), transferHandle, _priority, false});
+    }
+
+    if (!startTransfer) {
+        if (raised) { setUrlRequestPriorityImpl(raisedId, _priority); }
+        return handle;
     }
 
     // Start Platform specific url request
-    if (startUrlRequestImpl(_url, handle, entry->id)) {
-        entry->cancelable = true;
+    UrlRequestId id = 0;
+    bool cancelable = startUrlRequestImpl(_url, transferHandle, id);
+
+    if (cancelable) {
+        bool canceled = false;
+        {
+            std::lock_guard<std::mutex> lock(m_callbackMutex);
+            auto it = m_urlTransfers.find(transferHandle);
+            if (it != m_urlTransfers.end()) {
+                it->second.id = id;
+                it->second.cancelable = true;
+
+                // All requests were canceled while the transfer was starting
+                if (!hasPendingRequests(it->second)) {
+                    m_urlTransferByUrl.erase(it->second.url);
+                    canceled = true;
+                }
+            }
+        }
+        if (canceled) { cancelUrlRequestImpl(id); }
     }
 
     return handle;
@@ -109,35 +159,99 @@ UrlRequestHandle Platform::startUrlRequest(Url _url, UrlCallback&& _callback) {
 void Platform::cancelUrlRequest(const UrlRequestHandle _request) {
     if (_request == 0) { return; }
 
-    UrlRequestId id = 0;
     UrlCallback callback;
-    bool cancelable = false;
+    UrlRequestId id = 0;
+    bool cancelTransfer = false;
 
     {
         std::lock_guard<std::mutex> lock(m_callbackMutex);
         auto it = m_urlCallbacks.find(_request);
-        if (it != m_urlCallbacks.end()) {
-            id = it->second.id;
-            cancelable = it->second.cancelable;
+        if (it == m_urlCallbacks.end() || it->second.canceled) { return; }
 
-            if (!cancelable) {
-                callback = std::move(it->second.callback);
-                m_urlCallbacks.erase(it);
-            }
+        auto transferIt = m_urlTransfers.find(it->second.transfer);
+        if (transferIt == m_urlTransfers.end()) { return; }
+        auto& transfer = transferIt->second;
+
+        // The callback runs with an error when the transfer completes.
+        it->second.canceled = true;
+
+        // Abort the transfer only when no other request is interested in it
+        if (hasPendingRequests(transfer)) { return; }
+
+        if (transfer.cancelable) {
+            id = transfer.id;
+            cancelTransfer = true;
+            // New requests for this URL must not join the aborted transfer
+            m_urlTransferByUrl.erase(transfer.url);
+
+        } else {
+            // Run callback directly when platform implementation cannot cancel it.
+            callback = std::move(it->second.callback);
+            auto& requests = transfer.requests;
+            requests.erase(std::remove(requests.begin(), requests.end(), _request), requests.end());
+            m_urlCallbacks.erase(it);
         }
     }
 
-    if (cancelable) {
+    if (cancelTransfer) {
         cancelUrlRequestImpl(id);
 
-    } else {
-        // Run callback directly when platform implementation cannot cancel it.
-        if (callback) {
-            UrlResponse response;
-            response.error = cancel_message;
-            callback(std::move(response));
+    } else if (callback) {
+        UrlResponse response;
+        response.error = cancel_message;
+        callback(std::move(response));
+    }
+}
+
+bool Platform::hasPendingRequests(const UrlTransfer& _transfer) const {
+    return std::any_of(_transfer.requests.begin(), _transfer.requests.end(),
+                       [&](UrlRequestHandle _request) {
+                           auto it = m_urlCallbacks.find(_request);
+                           return it != m_urlCallbacks.end() && !it->second.canceled;
+                       });
+}
+
+void Platform::setUrlRequestPriority(const UrlRequestHandle _request, double _priority) {
+    if (_request == 0) { return; }
+
+    UrlRequestId id = 0;
+    double priority = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_callbackMutex);
+        auto it = m_urlCallbacks.find(_request);
+        if (it == m_urlCallbacks.end()) { return; }
+
+        it->second.priority = _priority;
+
+        auto transferIt = m_urlTransfers.find(it->second.transfer);
+        if (transferIt == m_urlTransfers.end()) { return; }
+
+        // A shared transfer is as urgent as its most urgent request
+        auto& transfer = transferIt->second;
+        priority = _priority;
+        for (auto request : transfer.requests) {
+            auto requestIt = m_urlCallbacks.find(request);
+            if (requestIt != m_urlCallbacks.end() && !requestIt->second.canceled) {
+                priority = std::min(priority, requestIt->second.priority);
+            }
         }
+        if (priority == transfer.priority) { return; }
+
+        transfer.priority = priority;
+        id = transfer.id;
+
+        // Only requests with an id can be found by the implementation
+        if (!transfer.cancelable) { return; }
     }
+
+    setUrlRequestPriorityImpl(id, priority);
+}
+
+double Platform::urlRequestPriority(const UrlRequestHandle _request) {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    auto it = m_urlTransfers.find(_request);
+    return it != m_urlTransfers.end() ? it->second.priority : 0;
 }
 
 void Platform::onUrlResponse(const UrlRequestHandle _request, UrlResponse&& _response) {
@@ -145,17 +259,47 @@ void Platform::onUrlResponse(const UrlRequestHandle _request, UrlResponse&& _res
         LOGW("onUrlResponse after shutdown");
         return;
     }
-    // Find the callback associated with the request.
-    UrlCallback callback;
+    // Find the callbacks of all requests sharing this transfer.
+    std::vector<std::pair<UrlCallback, bool>> callbacks;
     {
         std::lock_guard<std::mutex> lock(m_callbackMutex);
-        auto it = m_urlCallbacks.find(_request);
-        if (it != m_urlCallbacks.end()) {
-            callback = std::move(it->second.callback);
-            m_urlCallbacks.erase(it);
+        auto it = m_urlTransfers.find(_request);
+        if (it == m_urlTransfers.end()) { return; }
+
+        auto& transfer = it->second;
+        for (auto request : transfer.requests) {
+            auto requestIt = m_urlCallbacks.find(request);
+            if (requestIt != m_urlCallbacks.end()) {
+                callbacks.emplace_back(std::move(requestIt->second.callback), requestIt->second.canceled);
+                m_urlCallbacks.erase(requestIt);
+            }
+        }
+
+        auto urlIt = m_urlTransferByUrl.find(transfer.url);
+        if (urlIt != m_urlTransferByUrl.end() && urlIt->second == _request) {
+            m_urlTransferByUrl.erase(urlIt);
+        }
+        m_urlTransfers.erase(it);
+    }
+
+    // Each request gets its own copy of the content, the last one takes it over.
+    for (size_t i = 0; i < callbacks.size(); i++) {
+        auto& callback = callbacks[i].first;
+        if (!callback) { continue; }
+
+        UrlResponse response;
+        if (callbacks[i].second) {
+            response.error = cancel_message;
+        } else if (i + 1 == callbacks.size()) {
+            response = std::move(_response);
+        } else {
+            response.content = _response.content;
+            response.error = _response.error;
+            response.status = _response.status;
+            response.timedOut = _response.timedOut;
         }
+        callback(std::move(response));
     }
-    if (callback) { callback(std::move(_response)); }
 }
 
 } // namespace Tangram
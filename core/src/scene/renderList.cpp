@@ -0,0 +1,98 @@
+#include "scene/renderList.h"
+
+#include "gl/texture.h"
+#include "marker/marker.h"
+#include "style/style.h"
+#include "tile/tile.h"
+#include "util/hash.h"
+
+#include <algorithm>
+
+namespace Tangram {
+
+void RenderList::clear() {
+    m_commands.clear();
+    m_batches.clear();
+}
+
+static const uint64_t markerBit = uint64_t(1) << 63;
+static const uint64_t proxyBit = uint64_t(1) << 62;
+
+uint64_t RenderList::key(const Style& _style, const Tile& _tile) {
+    uint64_t key = 0;
+
+    // Tiles are drawn before their proxies, which are drawn behind them
+    if (_tile.isProxy()) { key |= proxyBit; }
+
+    // The raster textures bound for the tile, in texture unit order
+    if (_style.hasRasters() && !_tile.rasters().empty()) {
+        size_t textures = 0;
+        for (auto& raster : _tile.rasters()) {
+            hash_combine(textures, raster.texture.get());
+        }
+        key |= uint64_t(textures) & (proxyBit - 1);
+    }
+    return key;
+}
+
+void RenderList::record(Style& _style, const std::vector<std::shared_ptr<Tile>>& _tiles,
+                        const std::vector<std::unique_ptr<Marker>>& _markers) {
+
+    size_t begin = m_commands.size();
+
+    for (const auto& tile : _tiles) {
+        // Tiles are drawn once all their meshes are uploaded
+        if (!tile->isUploaded() || !tile->getMesh(_style)) { continue; }
+
+        Command command;
+        command.tile = tile.get();
+        command.key = key(_style, *tile);
+        m_commands.push_back(command);
+    }
+
+    for (const auto& marker : _markers) {
+        if (marker->styleId() != _style.getID() || !marker->mesh()) { continue; }
+
+        // Markers are drawn after tiles
+        Command command;
+        command.marker = marker.get();
+        command.key = markerBit;
+        m_commands.push_back(command);
+    }
+
+    // Skip when no mesh is to be rendered.
+    if (m_commands.size() == begin) { return; }
+
+    m_batches.push_back({ &_style, begin, m_commands.size() });
+}
+
+void RenderList::sort() {
+
+    // Opaque styles are sorted before all others, see Style::compare
+    auto opaqueEnd = std::find_if(m_batches.begin(), m_batches.end(), [](const Batch& _batch) {
+            return _batch.style->blendMode() != Blending::opaque;
+        });
+
+    // The styles stay in order: Coplanar meshes of different styles pass the
+    // depth test only for the style drawn first.
+    for (auto it = m_batches.begin(); it != opaqueEnd; ++it) {
+        std::stable_sort(m_commands.begin() + it->begin, m_commands.begin() + it->end,
+                         [](const Command& a, const Command& b) { return a.key < b.key; });
+    }
+}
+
+bool RenderList::submit(RenderState& _rs, const View& _view) {
+
+    bool drawnAnimatedStyle = false;
+
+    for (auto& batch : m_batches) {
+        bool styleDrawn = batch.style->draw(_rs, _view,
+                                            m_commands.data() + batch.begin,
+                                            m_commands.data() + batch.end);
+
+        drawnAnimatedStyle |= (styleDrawn && batch.style->isAnimated());
+    }
+    return drawnAnimatedStyle;
+}
+
+}
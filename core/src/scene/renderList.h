@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Tangram {
+
+class Marker;
+class RenderState;
+class Style;
+class Tile;
+class View;
+
+/* Draw commands of one frame
+ *
+ * Styles record one command per tile or marker mesh, in style order. Before
+ * the commands are submitted, the commands of each opaque style are sorted by
+ * the state they need (proxy depth, raster texture set), so that consecutive
+ * draws change less GL state. Proxy tiles are drawn with a depth offset, so
+ * the order of the tiles of a style does not change the result. Styles are
+ * drawn in recorded order, as the first of two coplanar opaque styles wins
+ * the depth test. Program and blend state belong to a style, so they only
+ * change between batches and are not part of the command key.
+ */
+class RenderList {
+
+public:
+
+    struct Command {
+        const Tile* tile = nullptr;
+        const Marker* marker = nullptr;
+        uint64_t key = 0;
+    };
+
+    // Commands of one style
+    struct Batch {
+        Style* style;
+        size_t begin;
+        size_t end;
+    };
+
+    void clear();
+
+    // Records the meshes of _style in _tiles and _markers. Nothing is recorded
+    // for styles without meshes or for tiles that are not uploaded yet.
+    void record(Style& _style, const std::vector<std::shared_ptr<Tile>>& _tiles,
+                const std::vector<std::unique_ptr<Marker>>& _markers);
+
+    void sort();
+
+    // Draws all recorded commands. Returns true when an animated style was drawn.
+    bool submit(RenderState& _rs, const View& _view);
+
+    const std::vector<Batch>& batches() const { return m_batches; }
+    const std::vector<Command>& commands() const { return m_commands; }
+
+    // Sort key of a tile command of _style: markers and then proxy tiles last,
+    // tiles with the same raster textures next to each other
+    static uint64_t key(const Style& _style, const Tile& _tile);
+
+private:
+
+    std::vector<Command> m_commands;
+    std::vector<Batch> m_batches;
+
+};
+
+}
@@ -197,6 +197,8 @@ bool Scene::load() {
 
     m_featureSelection = std::make_unique<FeatureSelection>();
     m_labelManager = std::make_unique<LabelManager>();
+    m_labelManager->setIncrementalPlacement(m_options.incrementalLabelPlacement);
+    m_labelManager->setAsyncPlacement(m_options.asyncLabelPlacement);
 
     m_state = State::pending_resources;
 
@@ -523,6 +525,9 @@ Scene::UpdateState Scene::update(const View& _view, float _dt) {
         }
         m_labelManager->updateLabelSet(_view.state(), _dt, *this, tiles, markers,
                                        *m_tileManager);
+    } else if (m_labelManager->placementPending()) {
+        m_labelManager->applyPendingPlacement(_view.state(), _dt, *this, tiles, markers,
+                                              *m_tileManager);
     } else {
         m_labelManager->updateLabels(_view.state(), _dt, m_styles, tiles, markers);
     }
@@ -540,16 +545,21 @@ void Scene::renderBeginFrame(RenderState& _rs) {
 
 bool Scene::render(RenderState& _rs, View& _view) {
 
-    bool drawnAnimatedStyle = false;
-    for (const auto& style : m_styles) {
+    // Upload meshes of new tiles within the budget of this frame
+    for (const auto& tile : m_tileManager->getVisibleTiles()) {
+        tile->upload(_rs);
+    }
 
-        bool styleDrawn = style->draw(_rs, _view,
-                                      m_tileManager->getVisibleTiles(),
-                                      m_markerManager->markers());
+    m_renderList.clear();
 
-        drawnAnimatedStyle |= (styleDrawn && style->isAnimated());
+    for (const auto& style : m_styles) {
+        m_renderList.record(*style, m_tileManager->getVisibleTiles(),
+                            m_markerManager->markers());
     }
-    return drawnAnimatedStyle;
+
+    m_renderList.sort();
+
+    return m_renderList.submit(_rs, _view);
 }
 
 void Scene::renderSelection(RenderState& _rs, View& _view, FrameBuffer& _selectionBuffer,
@@ -4,6 +4,7 @@
 #include "platform.h"
 #include "stops.h"
 #include "sceneOptions.h"
+#include "scene/renderList.h"
 #include "text/fontContext.h" // For FontDescription
 #include "tile/tileManager.h"
 #include "util/color.h"
@@ -251,6 +252,9 @@ protected:
     std::unique_ptr<MarkerManager> m_markerManager;
     std::unique_ptr<LabelManager> m_labelManager;
 
+    /// Draw commands of the current frame, kept to reuse their storage
+    RenderList m_renderList;
+
     std::mutex m_sceneLoadMutex;
     std::mutex m_taskMutex;
     std::atomic_uint m_tasksActive{0};
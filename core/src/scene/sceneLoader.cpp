@@ -4,6 +4,7 @@
 #include "data/memoryCacheDataSource.h"
 #include "data/mbtilesDataSource.h"
 #include "data/networkDataSource.h"
+#include "data/pmtilesDataSource.h"
 #include "data/rasterSource.h"
 #include "data/tileSource.h"
 #include "gl/shaderSource.h"
@@ -796,6 +797,14 @@ std::shared_ptr<TileSource> SceneLoader::loadSource(const Node& _source, const s
         isMBTilesFile = urlLength > extLength && (url.compare(urlLength - extLength, extLength, extStr) == 0);
     }
 
+    bool isPMTilesFile = false;
+    {
+        const char* extStr = ".pmtiles";
+        const size_t extLength = strlen(extStr);
+        const size_t urlLength = url.length();
+        isPMTilesFile = urlLength > extLength && (url.compare(urlLength - extLength, extLength, extStr) == 0);
+    }
+
     if (const Node& tmsNode = _source["tms"]) {
         YamlUtil::getBool(tmsNode, urlOptions.isTms);
     }
@@ -812,6 +821,10 @@ std::shared_ptr<TileSource> SceneLoader::loadSource(const Node& _source, const s
         LOGE("MBTiles support is disabled. This source will be ignored: %s", _name.c_str());
         return nullptr;
 #endif
+    } else if (isPMTilesFile) {
+        // A PMTiles archive is always tiled.
+        isTiled = true;
+        rawSources = std::make_unique<PMTilesDataSource>(_name, url);
     } else if (isTiled) {
         auto cacheSize = _options.memoryTileCacheSize;
         if (cacheSize > 0) {
@@ -350,7 +350,7 @@ void Style::drawSelectionFrame(Tangram::RenderState& rs, const Tangram::Tile &_t
 
     auto& styleMesh = _tile.getMesh(*this);
 
-    if (!styleMesh) { return; }
+    if (!styleMesh || !_tile.isUploaded()) { return; }
 
     TileID tileID = _tile.getID();
 
@@ -369,34 +369,24 @@ void Style::drawSelectionFrame(Tangram::RenderState& rs, const Tangram::Tile &_t
 }
 
 bool Style::draw(RenderState& rs, const View& _view,
-                 const std::vector<std::shared_ptr<Tile>>& _tiles,
-                 const std::vector<std::unique_ptr<Marker>>& _markers) {
+                 const RenderList::Command* _begin, const RenderList::Command* _end) {
 
-    auto tileIt = std::find_if(std::begin(_tiles), std::end(_tiles),
-                               [this](const auto& t){ return bool(t->getMesh(*this)); });
+    if (_begin == _end) { return false; }
 
-    auto markerIt = std::find_if(std::begin(_markers), std::end(_markers),
-                               [this](const auto& m){ return m->styleId() == this->m_id && m->mesh(); });
+    auto drawCommand = [&](const RenderList::Command& _command) {
+        return _command.tile ? draw(rs, *_command.tile) : draw(rs, *_command.marker);
+    };
 
     bool meshDrawn = false;
 
-    // Skip when no mesh is to be rendered.
-    // This also compiles shaders when they are first used.
-    if (tileIt == std::end(_tiles) && markerIt == std::end(_markers)) {
-        return false;
-    }
-
     onBeginDrawFrame(rs, _view);
 
     if (m_blend == Blending::translucent) {
         rs.colorMask(false, false, false, false);
     }
 
-    for (const auto& tile : _tiles) {
-        meshDrawn |= draw(rs, *tile);
-    }
-    for (const auto& marker : _markers) {
-        meshDrawn |= draw(rs, *marker);
+    for (auto command = _begin; command != _end; ++command) {
+        meshDrawn |= drawCommand(*command);
     }
 
     if (meshDrawn) {
@@ -409,8 +399,9 @@ bool Style::draw(RenderState& rs, const View& _view,
             GL::stencilFunc(GL_EQUAL, GL_ZERO, 0xFF);
             GL::stencilOp(GL_KEEP, GL_KEEP, GL_INCR);
 
-            for (const auto &tile : _tiles) { draw(rs, *tile); }
-            for (const auto &marker : _markers) { draw(rs, *marker); }
+            for (auto command = _begin; command != _end; ++command) {
+                drawCommand(*command);
+            }
 
             GL::disable(GL_STENCIL_TEST);
             GL::depthFunc(GL_LESS);
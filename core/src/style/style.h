@@ -4,6 +4,7 @@
 #include "gl.h"
 #include "gl/uniform.h"
 #include "scene/drawRule.h"
+#include "scene/renderList.h"
 #include "util/fastmap.h"
 
 #include <memory>
@@ -66,6 +67,8 @@ enum class RasterType : uint8_t {
 struct StyledMesh {
     virtual bool draw(RenderState& rs, ShaderProgram& _shader, bool _useVao = true) = 0;
     virtual size_t bufferSize() const = 0;
+    // Uploads geometry within the upload budget of rs, returns true when done
+    virtual bool upload(RenderState& rs) { return true; }
 
     virtual ~StyledMesh() {}
 };
@@ -278,9 +281,9 @@ public:
 
     virtual bool draw(RenderState& rs, const Marker& _marker);
 
+    /* Draws the recorded commands of this style, see <RenderList> */
     virtual bool draw(RenderState& rs, const View& _view,
-                      const std::vector<std::shared_ptr<Tile>>& _tiles,
-                      const std::vector<std::unique_ptr<Marker>>& _markers);
+                      const RenderList::Command* _begin, const RenderList::Command* _end);
 
     void drawSelectionFrame(RenderState& rs, const View& _view,
                             const std::vector<std::shared_ptr<Tile>>& _tiles,
@@ -311,6 +314,8 @@ public:
     const std::string& getName() const { return m_name; }
     const uint32_t& getID() const { return m_id; }
 
+    const ShaderProgram* shaderProgram() const { return m_shaderProgram.get(); }
+
     virtual size_t dynamicMeshSize() const { return 0; }
 
     virtual bool hasRasters() const { return m_rasterType != RasterType::none; }
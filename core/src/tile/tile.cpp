@@ -63,6 +63,8 @@ void Tile::setMesh(const Style& _style, std::unique_ptr<StyledMesh> _mesh) {
     if (id >= m_geometry.size()) {
         m_geometry.resize(id+1);
     }
+    if (_mesh) { m_uploaded = false; }
+
     m_geometry[_style.getID()] = std::move(_mesh);
 }
 
@@ -85,6 +87,20 @@ std::shared_ptr<Properties> Tile::getSelectionFeature(uint32_t _id) const {
     return nullptr;
 }
 
+bool Tile::upload(RenderState& _rs) {
+    if (m_uploaded) { return true; }
+
+    bool uploaded = true;
+    for (auto& entry : m_geometry) {
+        if (entry && !entry->upload(_rs)) {
+            uploaded = false;
+        }
+    }
+    m_uploaded = uploaded;
+
+    return m_uploaded;
+}
+
 size_t Tile::getMemoryUsage() const {
     if (m_memoryUsage == 0) {
         for (auto& entry : m_geometry) {
@@ -16,6 +16,7 @@ namespace Tangram {
 
 class MapProjection;
 struct Properties;
+class RenderState;
 class Style;
 class View;
 struct StyledMesh;
@@ -92,6 +93,16 @@ public:
 
     void setProxyState(bool isProxy) { m_proxyState = isProxy; }
 
+    /* Upload the meshes of this tile within the upload budget of the RenderState;
+     * Returns true when all meshes are uploaded
+     */
+    bool upload(RenderState& _rs);
+
+    /* Whether all meshes are uploaded. Tiles are drawn only once they are, until
+     * then their proxies are kept
+     */
+    bool isUploaded() const { return m_uploaded; }
+
 private:
 
     const TileID m_id;
@@ -106,6 +117,9 @@ private:
 
     bool m_proxyState = false;
 
+    // Cleared when meshes are added, until they are uploaded
+    bool m_uploaded = true;
+
     glm::dvec2 m_tileOrigin; // South-West corner of the tile in 2D projection space in meters (e.g. mercator meters)
 
     glm::mat4 m_modelMatrix; // Matrix relating tile-local coordinates to global projection space coordinates;
@@ -52,6 +52,10 @@ struct TileManager::TileEntry {
         return bool(task) && task->isCanceled();
     }
 
+    bool hasProxies() const {
+        return m_proxies != 0;
+    }
+
     bool needsLoading() {
         if (bool(tile)) { return false; }
         if (!task) { return true; }
@@ -345,13 +349,17 @@ void TileManager::updateTileSet(TileSet& _tileSet, const ViewState& _view) {
     std::vector<TileID> removeTiles;
     auto& tiles = _tileSet.tiles;
 
-    // Check for ready tasks, move Tile to active TileSet and unset Proxies.
+    // Check for ready tasks, move Tile to active TileSet and unset Proxies
+    // once the Tile is uploaded and can be drawn.
     for (auto& it : tiles) {
         auto& entry = it.second;
         if (entry.completeTileTask()) {
+            newTiles = true;
+            m_tileSetChanged = true;
+        }
+        if (entry.tile && entry.hasProxies() && entry.tile->isUploaded()) {
             clearProxyTiles(_tileSet, it.first, entry, removeTiles);
 
-            newTiles = true;
             m_tileSetChanged = true;
         }
     }
@@ -362,8 +370,6 @@ void TileManager::updateTileSet(TileSet& _tileSet, const ViewState& _view) {
     auto curTilesIt = tiles.begin();
     auto visTilesIt = visibleTiles.begin();
 
-    auto generation = _tileSet.source->generation();
-
     while (visTilesIt != visibleTiles.end() || curTilesIt != tiles.end()) {
 
         auto& visTileId = visTilesIt == visibleTiles.end()
@@ -392,6 +398,7 @@ void TileManager::updateTileSet(TileSet& _tileSet, const ViewState& _view) {
 
             // NB: Special handling to update tiles from ClientDataSource.
             // Can be removed once ClientDataSource is immutable
+            auto generation = _tileSet.source->generation(visTileId);
             if (entry.tile) {
                 auto sourceGeneration = entry.tile->sourceGeneration();
                 if ((sourceGeneration < generation) && !entry.isInProgress()) {
@@ -504,6 +511,8 @@ void TileManager::updateTileSet(TileSet& _tileSet, const ViewState& _view) {
             if (scaleDiv < 1) { scaleDiv = 0.1/scaleDiv; } // prefer parent tiles
             task->setPriority(glm::length2(tileCenter - _view.center) * scaleDiv);
             task->setProxyState(entry.getProxyCounter() > 0);
+
+            _tileSet.source->updateTilePriority(*task);
         }
 
         if (entry.tile) {
@@ -557,7 +566,7 @@ bool TileManager::addTile(TileSet& _tileSet, const TileID& _tileID) {
     auto tile = m_tileCache->get(_tileSet.source->id(), _tileID);
 
     if (tile) {
-        if (tile->sourceGeneration() == _tileSet.source->generation()) {
+        if (tile->sourceGeneration() >= _tileSet.source->generation(_tileID)) {
             m_tiles.push_back(tile);
 
             // Reset tile on potential internal dynamic data set
@@ -1,5 +1,18 @@
 #include "util/rasterize.h"
 
+#include "earcut.hpp"
+
+namespace mapbox { namespace util {
+template <>
+struct nth<0, glm::dvec2> {
+    inline static double get(const glm::dvec2 &t) { return t.x; };
+};
+template <>
+struct nth<1, glm::dvec2> {
+    inline static double get(const glm::dvec2 &t) { return t.y; };
+};
+}}
+
 namespace Tangram {
 namespace Rasterize {
 
@@ -63,5 +76,24 @@ void scanTriangle(glm::dvec2& _a, glm::dvec2& _b, glm::dvec2& _c, int _min, int
 
 }
 
+void scanPolygon(const std::vector<std::vector<glm::dvec2>>& _polygon, int _min, int _max, const ScanCallback& _s) {
+
+    if (_polygon.empty()) { return; }
+
+    mapbox::detail::Earcut<uint32_t> earcut;
+    earcut(_polygon);
+
+    // Indices refer to the points of all rings in order
+    std::vector<glm::dvec2> points;
+    for (auto& ring : _polygon) {
+        points.insert(points.end(), ring.begin(), ring.end());
+    }
+
+    auto& indices = earcut.indices;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        scanTriangle(points[indices[i]], points[indices[i+1]], points[indices[i+2]], _min, _max, _s);
+    }
+}
+
 }
 }
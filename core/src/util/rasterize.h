@@ -3,6 +3,7 @@
 #include "glm/vec2.hpp"
 #include <cmath>
 #include <functional>
+#include <vector>
 
 namespace Tangram {
 namespace Rasterize {
@@ -22,5 +23,9 @@ void scanSpan(Edge _e0, Edge _e1, int _min, int _max, const ScanCallback& _s);
 
 void scanTriangle(glm::dvec2& _a, glm::dvec2& _b, glm::dvec2& _c, int _min, int _max, const ScanCallback& _s);
 
+// Scan the cells covered by a polygon, given as outer ring followed by holes.
+// Cells shared by several triangles of the polygon are reported repeatedly.
+void scanPolygon(const std::vector<std::vector<glm::dvec2>>& _polygon, int _min, int _max, const ScanCallback& _s);
+
 }
 }
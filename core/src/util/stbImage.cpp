@@ -4,5 +4,11 @@
 #define STBI_NO_PIC
 #define STBI_NO_PNM
 
+// Decode into pooled pixel buffers, Texture releases them after upload
+#include "gl/texturePool.h"
+#define STBI_MALLOC(sz) Tangram::PixelBuffer::decoderAllocate(sz)
+#define STBI_REALLOC(p, newsz) Tangram::PixelBuffer::decoderReallocate(p, newsz)
+#define STBI_FREE(p) Tangram::PixelBuffer::release(p)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
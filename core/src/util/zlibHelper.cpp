@@ -2,55 +2,200 @@
 
 #include <zlib.h>
 
+// Only the tinfl API, the zlib names are taken by zlib.h
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#include "miniz.h"
+
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
 
+// Output size to start with when the gzip trailer is unusable
 #define CHUNK 16384
 
+// Largest output to allocate up front from a gzip trailer
+#define MAX_SIZE_HINT (256 * 1024 * 1024)
+
 namespace Tangram {
 namespace zlib {
 
-int inflate(const char* _data, size_t _size, std::vector<char>& dst) {
+static std::atomic<Backend> s_backend{Backend::miniz};
+
+void setBackend(Backend _backend) { s_backend = _backend; }
+
+Backend backend() { return s_backend; }
+
+// Uncompressed size from the gzip trailer (modulo 2^32), or 0 when it is not
+// plausible for _size bytes of deflate data
+static size_t gzipSizeHint(const unsigned char* _data, size_t _size) {
+    if (_size < 18) { return 0; }
 
-    int ret;
-    unsigned char out[CHUNK];
+    const unsigned char* trailer = _data + _size - 4;
+    size_t size = size_t(trailer[0]) | size_t(trailer[1]) << 8 |
+        size_t(trailer[2]) << 16 | size_t(trailer[3]) << 24;
 
+    // Deflate compresses at most about 1032:1
+    if (size > MAX_SIZE_HINT || size / 1032 > _size) { return 0; }
+
+    return size;
+}
+
+// Per-thread inflate state, initialized once and reset for each buffer
+struct ZlibContext {
     z_stream strm;
-    memset(&strm, 0, sizeof(z_stream));
+    bool initialized = false;
+
+    ZlibContext() { memset(&strm, 0, sizeof(z_stream)); }
+    ~ZlibContext() { if (initialized) { inflateEnd(&strm); } }
+
+    int reset() {
+        if (initialized) { return inflateReset(&strm); }
 
-    ret = inflateInit2(&strm, 16+MAX_WBITS);
+        int ret = inflateInit2(&strm, 16+MAX_WBITS);
+        initialized = (ret == Z_OK);
+        return ret;
+    }
+};
+
+static int inflateZlib(const char* _data, size_t _size, std::vector<char>& dst) {
+
+    static thread_local ZlibContext context;
+
+    int ret = context.reset();
     if (ret != Z_OK) { return ret; }
 
+    z_stream& strm = context.strm;
     strm.avail_in = _size;
     strm.next_in = (Bytef*)_data;
 
+    // Inflate directly into dst, sized by the gzip trailer when possible
+    size_t start = dst.size();
+    size_t hint = gzipSizeHint(reinterpret_cast<const unsigned char*>(_data), _size);
+    dst.resize(start + (hint > 0 ? hint : CHUNK));
+
+    size_t written = 0;
     do {
-        strm.avail_out = CHUNK;
-        strm.next_out = out;
+        if (start + written == dst.size()) {
+            dst.resize(dst.size() + std::max<size_t>(CHUNK, dst.size() - start));
+        }
+        size_t available = dst.size() - start - written;
+        strm.avail_out = available;
+        strm.next_out = reinterpret_cast<Bytef*>(dst.data() + start + written);
 
         ret = inflate(&strm, Z_NO_FLUSH);
 
          /* state not clobbered */
         assert(ret != Z_STREAM_ERROR);
 
+        written += available - strm.avail_out;
+
         switch (ret) {
         case Z_NEED_DICT:
             ret = Z_DATA_ERROR;
             /* fall through */
         case Z_DATA_ERROR:
         case Z_MEM_ERROR:
-            inflateEnd(&strm);
+            dst.resize(start);
             return ret;
+        case Z_BUF_ERROR:
+            // No progress possible: truncated input
+            if (strm.avail_out > 0) {
+                dst.resize(start);
+                return Z_DATA_ERROR;
+            }
+            ret = Z_OK;
+            break;
         }
 
-        size_t have = CHUNK - strm.avail_out;
-        dst.insert(dst.end(), out, out+have);
-
     } while (ret == Z_OK);
 
-    inflateEnd(&strm);
+    dst.resize(start + written);
 
     return ret == Z_STREAM_END ? Z_OK : Z_DATA_ERROR;
 }
 
+// Length of the gzip header at _data, or 0 when it is invalid
+static size_t gzipHeaderLength(const unsigned char* _data, size_t _size) {
+    enum { FHCRC = 2, FEXTRA = 4, FNAME = 8, FCOMMENT = 16 };
+
+    if (_size < 18 || _data[0] != 0x1f || _data[1] != 0x8b || _data[2] != 8) { return 0; }
+
+    int flags = _data[3];
+    size_t pos = 10;
+
+    if (flags & FEXTRA) {
+        if (pos + 2 > _size) { return 0; }
+        pos += 2 + (size_t(_data[pos]) | size_t(_data[pos + 1]) << 8);
+    }
+    for (int field : { FNAME, FCOMMENT }) {
+        if (!(flags & field)) { continue; }
+        while (pos < _size && _data[pos] != 0) { pos++; }
+        pos++;
+    }
+    if (flags & FHCRC) { pos += 2; }
+
+    // Leave room for the trailer
+    return pos + 8 <= _size ? pos : 0;
+}
+
+static int inflateMiniz(const char* _data, size_t _size, std::vector<char>& dst) {
+
+    auto data = reinterpret_cast<const unsigned char*>(_data);
+
+    size_t header = gzipHeaderLength(data, _size);
+    if (header == 0) { return Z_DATA_ERROR; }
+
+    size_t outSize = gzipSizeHint(data, _size);
+    if (outSize == 0) {
+        // Empty output or unknown size
+        return inflateZlib(_data, _size, dst);
+    }
+
+    static thread_local tinfl_decompressor decompressor;
+    tinfl_init(&decompressor);
+
+    size_t start = dst.size();
+    dst.resize(start + outSize);
+
+    auto out = reinterpret_cast<mz_uint8*>(dst.data() + start);
+    size_t inSize = _size - header - 8;
+    size_t written = outSize;
+
+    tinfl_status status = tinfl_decompress(&decompressor, data + header, &inSize,
+                                           out, out, &written,
+                                           TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+
+    if (status == TINFL_STATUS_HAS_MORE_OUTPUT) {
+        // The trailer size was off by a multiple of 4GB
+        dst.resize(start);
+        return inflateZlib(_data, _size, dst);
+    }
+
+    const unsigned char* trailer = data + _size - 8;
+    uLong expectedCrc = uLong(trailer[0]) | uLong(trailer[1]) << 8 |
+        uLong(trailer[2]) << 16 | uLong(trailer[3]) << 24;
+
+    if (status != TINFL_STATUS_DONE || written != outSize ||
+        crc32(0, out, uInt(written)) != expectedCrc) {
+        dst.resize(start);
+        return Z_DATA_ERROR;
+    }
+    return Z_OK;
+}
+
+int inflate(Backend _backend, const char* _data, size_t _size, std::vector<char>& dst) {
+    switch (_backend) {
+    case Backend::miniz:
+        return inflateMiniz(_data, _size, dst);
+    case Backend::zlib:
+        break;
+    }
+    return inflateZlib(_data, _size, dst);
+}
+
+int inflate(const char* _data, size_t _size, std::vector<char>& dst) {
+    return inflate(s_backend, _data, _size, dst);
+}
+
 }
 }
@@ -6,7 +6,25 @@
 namespace Tangram {
 namespace zlib {
 
+// Decoders for gzip data
+enum class Backend {
+    // Streaming zlib inflate
+    zlib,
+    // Whole-buffer inflate with miniz into an output buffer of the size
+    // recorded in the gzip trailer. Falls back to zlib when the recorded
+    // size does not match.
+    miniz,
+};
+
+// Selects the decoder used by inflate(), e.g. to compare them in benchmarks
+void setBackend(Backend _backend);
+
+Backend backend();
+
+// Decompresses gzip data and appends it to dst. Returns 0 on success.
 int inflate(const char* _data, size_t _size, std::vector<char>& dst);
 
+int inflate(Backend _backend, const char* _data, size_t _size, std::vector<char>& dst);
+
 }
 }
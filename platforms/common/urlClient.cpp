@@ -2,11 +2,19 @@
 #include "log.h"
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <curl/curl.h>
+#include <fstream>
+#include <unordered_map>
+#include <sys/stat.h>
 #ifndef _MSC_VER
+#include <dirent.h>
 #include <unistd.h>
 #endif
+#if defined(_WIN32)
+#include <direct.h>
+#endif
 #include <time.h>
 
 constexpr char const* requestCancelledError = "Request cancelled";
@@ -110,6 +118,310 @@ UrlClient::SelfPipe::Socket UrlClient::SelfPipe::getReadFd() {
     return pipeFds[0];
 }
 
+// HTTP caching headers of a response
+struct CacheHeaders {
+    std::string etag;
+    std::string lastModified;
+    std::string cacheControl;
+    std::string expires;
+
+    void clear() { *this = CacheHeaders(); }
+
+    // Read header _line of a response, false when it starts a new response
+    bool parse(const char* _line, size_t _length) {
+        if (_length >= 5 && strncmp(_line, "HTTP/", 5) == 0) {
+            // Drop headers of redirects
+            clear();
+            return false;
+        }
+        const char* colon = static_cast<const char*>(memchr(_line, ':', _length));
+        if (!colon) { return true; }
+
+        std::string name(_line, colon - _line);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        const char* value = colon + 1;
+        const char* end = _line + _length;
+        while (value < end && (*value == ' ' || *value == '\t')) { value++; }
+        while (end > value && (end[-1] == '\r' || end[-1] == '\n' || end[-1] == ' ')) { end--; }
+
+        if (name == "etag") { etag.assign(value, end); }
+        else if (name == "last-modified") { lastModified.assign(value, end); }
+        else if (name == "cache-control") { cacheControl.assign(value, end); }
+        else if (name == "expires") { expires.assign(value, end); }
+        return true;
+    }
+
+    bool hasDirective(const char* _directive) const {
+        return cacheControl.find(_directive) != std::string::npos;
+    }
+
+    bool storable() const {
+        return !hasDirective("no-store") && (freshUntil(0) > 0 || !etag.empty() || !lastModified.empty());
+    }
+
+    // Time until a response received at _now can be used without revalidation
+    int64_t freshUntil(int64_t _now) const {
+        if (hasDirective("no-cache")) { return 0; }
+
+        auto maxAge = cacheControl.find("max-age=");
+        if (maxAge != std::string::npos) {
+            return _now + atoll(cacheControl.c_str() + maxAge + 8);
+        }
+        if (!expires.empty()) {
+            auto time = curl_getdate(expires.c_str(), nullptr);
+            return time > 0 ? int64_t(time) : 0;
+        }
+        if (!lastModified.empty()) {
+            // Heuristic freshness of 10% of the age, up to one day
+            auto time = curl_getdate(lastModified.c_str(), nullptr);
+            if (time > 0 && time < _now) {
+                return _now + std::min<int64_t>((_now - time) / 10, 24 * 60 * 60);
+            }
+        }
+        return 0;
+    }
+};
+
+// Responses stored on disk, one file per URL. Each file starts with the
+// URL and the caching headers, followed by the content.
+class UrlClient::DiskCache {
+public:
+
+    struct Entry {
+        std::string etag;
+        std::string lastModified;
+        int64_t expires = 0;
+        uint64_t size = 0;
+        int64_t lastUse = 0;
+    };
+
+    DiskCache(std::string _path, uint64_t _maxSize)
+        : m_path(std::move(_path)), m_maxSize(_maxSize) {
+        if (!m_path.empty() && m_path.back() != '/') { m_path += '/'; }
+    }
+
+    // Read the index of cached responses. Until it is read, no response is
+    // found in the cache.
+    void open() {
+#if defined(_WIN32)
+        _mkdir(m_path.c_str());
+#else
+        mkdir(m_path.c_str(), 0755);
+#endif
+        std::vector<std::string> files;
+#if defined(_WIN32)
+        WIN32_FIND_DATAA data;
+        HANDLE find = FindFirstFileA((m_path + "*").c_str(), &data);
+        if (find != INVALID_HANDLE_VALUE) {
+            do { files.push_back(data.cFileName); } while (FindNextFileA(find, &data));
+            FindClose(find);
+        }
+#else
+        if (DIR* dir = opendir(m_path.c_str())) {
+            while (struct dirent* file = readdir(dir)) { files.push_back(file->d_name); }
+            closedir(dir);
+        }
+#endif
+        // Parse the headers without holding m_mutex, so that find() does
+        // not wait for them
+        std::unordered_map<uint64_t, Entry> entries;
+        uint64_t size = 0;
+
+        for (auto& name : files) {
+            if (name.size() != 16 || name.find_first_not_of("0123456789abcdef") != std::string::npos) {
+                // Remove unfinished writes
+                if (name.size() > 4 && name.compare(name.size() - 4, 4, ".tmp") == 0) {
+                    std::remove((m_path + name).c_str());
+                }
+                continue;
+            }
+            std::string url;
+            Entry entry;
+            std::ifstream file(m_path + name, std::ios::binary);
+            if (!readHeader(file, url, entry)) {
+                file.close();
+                std::remove((m_path + name).c_str());
+                continue;
+            }
+            struct stat st;
+            if (stat((m_path + name).c_str(), &st) == 0) {
+                entry.size = st.st_size;
+                entry.lastUse = st.st_mtime;
+            }
+            size += entry.size;
+            entries.emplace(strtoull(name.c_str(), nullptr, 16), std::move(entry));
+        }
+
+        LOG("HTTP cache opened: %s, %d entries, %dkB", m_path.c_str(),
+            int(entries.size()), int(size / 1024));
+
+        std::vector<uint64_t> evicted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries = std::move(entries);
+            m_size = size;
+            m_open = true;
+            evicted = evict();
+        }
+        removeFiles(evicted);
+    }
+
+    bool find(const std::string& _url, Entry& _entry) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_open) { return false; }
+
+        auto it = m_entries.find(key(_url));
+        if (it == m_entries.end()) { return false; }
+        _entry = it->second;
+        return true;
+    }
+
+    bool load(const std::string& _url, std::vector<char>& _content) {
+        std::ifstream file(fileName(key(_url)), std::ios::binary | std::ios::ate);
+        if (!file.is_open()) { return false; }
+
+        auto fileSize = file.tellg();
+        file.seekg(0);
+
+        std::string url;
+        Entry entry;
+        // Check for hash collisions
+        if (!readHeader(file, url, entry) || url != _url) { return false; }
+
+        auto offset = file.tellg();
+        _content.resize(size_t(fileSize - offset));
+        file.read(_content.data(), _content.size());
+        if (!file) { return false; }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key(_url));
+        if (it != m_entries.end()) { it->second.lastUse = time(nullptr); }
+        return true;
+    }
+
+    void store(const std::string& _url, Entry _entry, const std::vector<char>& _content) {
+        auto k = key(_url);
+        auto name = fileName(k);
+        {
+            // Write to a temporary file first, a cache entry is either complete or missing
+            std::ofstream file(name + ".tmp", std::ios::binary);
+            file << "TGCACHE1\n" << _url << '\n' << _entry.etag << '\n'
+                 << _entry.lastModified << '\n' << _entry.expires << '\n';
+            file.write(_content.data(), _content.size());
+            _entry.size = file.tellp();
+            if (!file) {
+                file.close();
+                std::remove((name + ".tmp").c_str());
+                return;
+            }
+        }
+#if defined(_WIN32)
+        std::remove(name.c_str());
+#endif
+        if (std::rename((name + ".tmp").c_str(), name.c_str()) != 0) {
+            std::remove((name + ".tmp").c_str());
+            return;
+        }
+
+        std::vector<uint64_t> evicted;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            _entry.lastUse = time(nullptr);
+
+            auto it = m_entries.find(k);
+            if (it != m_entries.end()) {
+                m_size -= it->second.size;
+                it->second = std::move(_entry);
+            } else {
+                it = m_entries.emplace(k, std::move(_entry)).first;
+            }
+            m_size += it->second.size;
+
+            evicted = evict();
+        }
+        removeFiles(evicted);
+    }
+
+    void remove(const std::string& _url) {
+        auto k = key(_url);
+        std::remove(fileName(k).c_str());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(k);
+        if (it != m_entries.end()) {
+            m_size -= it->second.size;
+            m_entries.erase(it);
+        }
+    }
+
+private:
+
+    static uint64_t key(const std::string& _url) {
+        // FNV-1a, file names must be stable across runs
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : _url) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string fileName(uint64_t _key) const {
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx", (unsigned long long)_key);
+        return m_path + name;
+    }
+
+    static bool readHeader(std::istream& _file, std::string& _url, Entry& _entry) {
+        std::string magic, expires;
+        return std::getline(_file, magic) && magic == "TGCACHE1" &&
+            std::getline(_file, _url) &&
+            std::getline(_file, _entry.etag) &&
+            std::getline(_file, _entry.lastModified) &&
+            std::getline(_file, expires) &&
+            (_entry.expires = atoll(expires.c_str()), true);
+    }
+
+    // Remove least recently used entries beyond the size limit, requires
+    // m_mutex. Returns the keys of the removed entries, whose files are to
+    // be deleted with removeFiles() after releasing m_mutex.
+    std::vector<uint64_t> evict() {
+        std::vector<uint64_t> evicted;
+        if (m_size <= m_maxSize) { return evicted; }
+
+        std::vector<std::pair<int64_t, uint64_t>> entries;
+        entries.reserve(m_entries.size());
+        for (auto& entry : m_entries) {
+            entries.emplace_back(entry.second.lastUse, entry.first);
+        }
+        std::sort(entries.begin(), entries.end());
+
+        // Leave some room to not evict on each store
+        uint64_t targetSize = m_maxSize - m_maxSize / 10;
+        for (auto& entry : entries) {
+            if (m_size <= targetSize) { break; }
+            auto it = m_entries.find(entry.second);
+            m_size -= it->second.size;
+            m_entries.erase(it);
+            evicted.push_back(entry.second);
+        }
+        return evicted;
+    }
+
+    void removeFiles(const std::vector<uint64_t>& _keys) {
+        for (auto k : _keys) { std::remove(fileName(k).c_str()); }
+    }
+
+    std::string m_path;
+    uint64_t m_maxSize;
+    uint64_t m_size = 0;
+    bool m_open = false;
+
+    std::unordered_map<uint64_t, Entry> m_entries;
+    std::mutex m_mutex;
+};
+
 struct UrlClient::Task {
     // Reduce Task content capacity when it's more than 128kb and last
     // content size was less then half limit_capacity.
@@ -122,6 +434,11 @@ struct UrlClient::Task {
     bool active = false;
     bool canceled = false;
 
+    // Response headers and conditional request headers for the HTTP cache
+    CacheHeaders headers;
+    struct curl_slist* requestHeaders = nullptr;
+    bool revalidating = false;
+
     static size_t curlWriteCallback(char* ptr, size_t size, size_t n, void* user) {
         // Writes data received by libCURL.
         auto* task = reinterpret_cast<Task*>(user);
@@ -135,7 +452,13 @@ struct UrlClient::Task {
         return addedSize;
     }
 
-    Task(const Options& _options) {
+    static size_t curlHeaderCallback(char* ptr, size_t size, size_t n, void* user) {
+        auto* task = reinterpret_cast<Task*>(user);
+        task->headers.parse(ptr, size * n);
+        return size * n;
+    }
+
+    Task(const Options& _options, CURLSH* _share) {
         // Set up an easy handle for reuse.
         handle = curl_easy_init();
         curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, &curlWriteCallback);
@@ -151,7 +474,35 @@ struct UrlClient::Task {
         curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
         curl_easy_setopt(handle, CURLOPT_MAXREDIRS, 20);
         curl_easy_setopt(handle, CURLOPT_TCP_NODELAY, 1);
+        curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+        curl_easy_setopt(handle, CURLOPT_DNS_CACHE_TIMEOUT, long(_options.dnsCacheTimeoutSec));
+        if (_options.http2) {
+            curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            // Wait for a connection that can be multiplexed instead of opening another
+            curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+        }
+        if (_options.keepAliveIdleSec > 0) {
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, long(_options.keepAliveIdleSec));
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, long(_options.keepAliveIdleSec));
+        }
         curl_easy_setopt(handle, CURLOPT_USERAGENT, _options.userAgentString);
+        if (_options.cachePath) {
+            curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, &curlHeaderCallback);
+            curl_easy_setopt(handle, CURLOPT_HEADERDATA, this);
+        }
+    }
+
+    // Only fetch the content when it changed since it was cached
+    void setRevalidate(const DiskCache::Entry& _entry) {
+        if (!_entry.etag.empty()) {
+            requestHeaders = curl_slist_append(requestHeaders, ("If-None-Match: " + _entry.etag).c_str());
+        }
+        if (!_entry.lastModified.empty()) {
+            requestHeaders = curl_slist_append(requestHeaders, ("If-Modified-Since: " + _entry.lastModified).c_str());
+        }
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, requestHeaders);
+        revalidating = true;
     }
 
     void setup() {
@@ -170,10 +521,19 @@ struct UrlClient::Task {
         }
         content.clear();
 
+        headers.clear();
+        if (requestHeaders) {
+            curl_easy_setopt(handle, CURLOPT_HTTPHEADER, nullptr);
+            curl_slist_free_all(requestHeaders);
+            requestHeaders = nullptr;
+        }
+        revalidating = false;
+
         active = false;
     }
 
     ~Task() {
+        curl_slist_free_all(requestHeaders);
         curl_easy_cleanup(handle);
     }
 
@@ -190,30 +550,43 @@ UrlClient::UrlClient(Options options) : m_options(options) {
         LOGE("Could not initialize select breaker!");
     }
 
+    // Finish the queued work when the client is destroyed, so that every
+    // callback runs
+    m_dispatcher = std::make_unique<AsyncWorker>();
+    m_dispatcher->waitForCompletion();
+
+    if (m_options.cachePath) {
+        m_cache = std::make_unique<DiskCache>(m_options.cachePath, m_options.cacheMaxSize);
+        // Read the cache index off the curl thread, requests are fetched
+        // from the network until it is read
+        m_dispatcher->enqueue([this]() { m_cache->open(); });
+    }
+
+    // Share resolved hosts and TLS sessions between easy handles. They are
+    // only used on the curl thread, so the share needs no locking.
+    m_curlShare = curl_share_init();
+    curl_share_setopt(m_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(m_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
     // Start the curl thread
     m_curlHandle = curl_multi_init();
+    curl_multi_setopt(m_curlHandle, CURLMOPT_PIPELINING,
+                      m_options.http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    curl_multi_setopt(m_curlHandle, CURLMOPT_MAX_HOST_CONNECTIONS, long(m_options.maxHostConnections));
+    curl_multi_setopt(m_curlHandle, CURLMOPT_MAX_TOTAL_CONNECTIONS, long(m_options.maxTotalConnections));
     m_curlRunning = true;
     m_curlWorker = std::make_unique<std::thread>(&UrlClient::curlLoop, this);
 
     // Init at least one task to avoid checking whether m_tasks is empty in
     // startPendingRequests()
-    m_tasks.emplace_back(m_options);
+    m_tasks.emplace_back(m_options, m_curlShare);
 }
 
 UrlClient::~UrlClient() {
     // Cancel all tasks
     {
         std::lock_guard<std::mutex> lock(m_requestMutex);
-        // For all requests that have not started, finish them now with a
-        // canceled response.
-        for (auto& request : m_requests) {
-            if (request.callback) {
-                UrlResponse response;
-                response.error = requestCancelledError;
-                request.callback(std::move(response));
-            }
-        }
-        m_requests.clear();
+        cancelPendingRequests();
         for (auto& task : m_tasks) {
             task.canceled = true;
         }
@@ -225,6 +598,14 @@ UrlClient::~UrlClient() {
 
     m_curlWorker->join();
 
+    // Run the remaining callbacks and cache reads. Requests that are queued
+    // again since their cached response is gone are canceled.
+    m_dispatcher.reset();
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        cancelPendingRequests();
+    }
+
     // 1 - curl_multi_remove_handle before any easy handles are cleaned up
     // 2 - curl_easy_cleanup can now be called independently since the easy handle
     //     is no longer connected to the multi handle
@@ -237,6 +618,10 @@ UrlClient::~UrlClient() {
         }
     }
     curl_multi_cleanup(m_curlHandle);
+
+    // The share can only be cleaned up when no easy handle uses it
+    m_tasks.clear();
+    curl_share_cleanup(m_curlShare);
 }
 
 void UrlClient::curlWakeUp() {
@@ -251,17 +636,18 @@ void UrlClient::curlWakeUp() {
     }
 }
 
-UrlClient::RequestId UrlClient::addRequest(const std::string& _url, UrlCallback _onComplete) {
+UrlClient::RequestId UrlClient::addRequest(const std::string& _url, UrlCallback _onComplete,
+                                           double _priority) {
 
     auto id = ++m_requestCount;
-    Request request = {_url, _onComplete, id};
+    Request request = {_url, _onComplete, id, _priority};
 
     // Add the request to our list.
     {
         // Lock the mutex to prevent concurrent modification of the
         // list by the curl thread.
         std::lock_guard<std::mutex> lock(m_requestMutex);
-        m_requests.push_back(request);
+        queueRequest(std::move(request));
     }
     curlWakeUp();
 
@@ -304,15 +690,132 @@ void UrlClient::cancelRequest(UrlClient::RequestId _id) {
     }
 }
 
+void UrlClient::setRequestPriority(UrlClient::RequestId _id, double _priority) {
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+
+        auto it = std::find_if(m_requests.begin(), m_requests.end(),
+                               [&](auto& r) { return r.id == _id; });
+
+        if (it != m_requests.end()) {
+            if (it->priority == _priority) { return; }
+
+            // Move the request to its new place in the queue
+            Request request = std::move(*it);
+            m_requests.erase(it);
+            request.priority = _priority;
+            queueRequest(std::move(request));
+
+        } else {
+            // Active tasks keep the priority to decide on preemption
+            auto task = std::find_if(m_tasks.begin(), m_tasks.end(),
+                                     [&](auto& t) { return t.active && t.request.id == _id; });
+            if (task != m_tasks.end()) {
+                task->request.priority = _priority;
+            }
+            return;
+        }
+    }
+    curlWakeUp();
+}
+
+void UrlClient::queueRequest(Request&& _request) {
+    auto it = std::upper_bound(m_requests.begin(), m_requests.end(), _request.priority,
+                               [](double _priority, auto& _other) {
+                                   return _priority < _other.priority;
+                               });
+    m_requests.insert(it, std::move(_request));
+}
+
+bool UrlClient::preemptTask(double _priority) {
+
+    if (_priority >= m_options.preemptablePriority) { return false; }
+
+    // Find the least urgent active task that may be interrupted
+    Task* preempted = nullptr;
+    for (auto& task : m_tasks) {
+        if (!task.active || task.canceled) { continue; }
+        if (task.request.priority < m_options.preemptablePriority) { continue; }
+        if (!preempted || task.request.priority > preempted->request.priority) {
+            preempted = &task;
+        }
+    }
+    if (!preempted) { return false; }
+
+    LOGD("Preempting request for url: %s", preempted->request.url.c_str());
+
+    // The transfer starts over when the request comes up again
+    curl_multi_remove_handle(m_curlHandle, preempted->handle);
+    queueRequest(std::move(preempted->request));
+    preempted->clear();
+
+    auto it = std::find_if(m_tasks.begin(), m_tasks.end(),
+                           [&](auto& t) { return &t == preempted; });
+    m_tasks.splice(m_tasks.begin(), m_tasks, it);
+
+    m_activeTasks--;
+    return true;
+}
+
+void UrlClient::cancelPendingRequests() {
+    // For all requests that have not started, finish them now with a
+    // canceled response.
+    for (auto& request : m_requests) {
+        if (request.callback) {
+            UrlResponse response;
+            response.error = requestCancelledError;
+            request.callback(std::move(response));
+        }
+    }
+    m_requests.clear();
+}
+
+void UrlClient::requeueRequest(Request&& _request) {
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        queueRequest(std::move(_request));
+    }
+    curlWakeUp();
+}
+
+void UrlClient::respondFromCache(Request& _request) {
+    UrlResponse response;
+    if (!m_cache->load(_request.url, response.content)) {
+        LOGD("Cached response missing for url: %s", _request.url.c_str());
+        _request.bypassCache = true;
+        requeueRequest(std::move(_request));
+        return;
+    }
+    LOGD("Cached response for url: %s", _request.url.c_str());
+    if (_request.callback) { _request.callback(std::move(response)); }
+}
+
 void UrlClient::startPendingRequests() {
     std::unique_lock<std::mutex> lock(m_requestMutex);
 
-    while (m_activeTasks < m_options.maxActiveTasks) {
+    int64_t now = time(nullptr);
+
+    while (!m_requests.empty()) {
 
-        if (m_requests.empty()) { break; }
+        DiskCache::Entry cached;
+        bool isCached = m_cache && !m_requests.front().bypassCache &&
+            m_cache->find(m_requests.front().url, cached);
+
+        // Fresh responses are served without a request
+        if (isCached && cached.expires > now) {
+            auto request = std::make_shared<Request>(std::move(m_requests.front()));
+            m_requests.erase(m_requests.begin());
+            m_dispatcher->enqueue([this, request]() { respondFromCache(*request); });
+            continue;
+        }
+
+        if (m_activeTasks >= m_options.maxActiveTasks &&
+            !preemptTask(m_requests.front().priority)) {
+            break;
+        }
 
         if (m_tasks.front().active) {
-            m_tasks.emplace_front(m_options);
+            m_tasks.emplace_front(m_options, m_curlShare);
         }
 
         m_activeTasks++;
@@ -331,6 +834,8 @@ void UrlClient::startPendingRequests() {
         const char* url = task.request.url.c_str();
         curl_easy_setopt(task.handle, CURLOPT_URL, url);
 
+        if (isCached) { task.setRevalidate(cached); }
+
         LOGD("Tasks %d - starting request for url: %s", int(m_activeTasks), url);
 
         curl_multi_add_handle(m_curlHandle, task.handle);
@@ -434,6 +939,11 @@ void UrlClient::curlLoop() {
 
             UrlCallback callback;
             UrlResponse response;
+            // Request to answer with cached content after revalidation
+            std::shared_ptr<Request> revalidated;
+            bool store = false;
+            DiskCache::Entry entry;
+            std::string storeUrl;
             {
                 std::lock_guard<std::mutex> lock(m_requestMutex);
                 // Find Task for this message
@@ -451,11 +961,36 @@ void UrlClient::curlLoop() {
                 callback = std::move(task.request.callback);
                 response.content = task.content;
 
+                long status = 0;
+                curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+                response.status = int(status);
+
                 const char* url = task.request.url.c_str();
                 if (resultCode == CURLE_OK) {
                     LOGD("Succeeded for url: %s", url);
                     response.error = nullptr;
 
+                    if (m_cache && (status == 200 || (status == 304 && task.revalidating))) {
+                        auto& headers = task.headers;
+                        entry.etag = headers.etag;
+                        entry.lastModified = headers.lastModified;
+                        entry.expires = headers.freshUntil(time(nullptr));
+                        store = headers.storable();
+                        storeUrl = task.request.url;
+
+                        if (status == 304) {
+                            // Not modified: Keep the validators that were not sent again
+                            DiskCache::Entry cached;
+                            if (m_cache->find(task.request.url, cached)) {
+                                if (entry.etag.empty()) { entry.etag = cached.etag; }
+                                if (entry.lastModified.empty()) { entry.lastModified = cached.lastModified; }
+                            }
+                            store = !headers.hasDirective("no-store");
+                            revalidated = std::make_shared<Request>(std::move(task.request));
+                            revalidated->callback = std::move(callback);
+                        }
+                    }
+
                 } else if (task.canceled) {
                     LOGD("Aborted request for url: %s", url);
                     response.error = requestCancelledError;
@@ -463,15 +998,37 @@ void UrlClient::curlLoop() {
                 } else {
                     LOGW("Failed with error for url: %s", task.curlErrorString, url);
                     response.error = task.curlErrorString;
+                    response.timedOut = (resultCode == CURLE_OPERATION_TIMEDOUT);
                 }
 
                 // Unset task state, clear content
                 task.clear();
             }
 
+            if (revalidated) {
+                m_dispatcher->enqueue([this, revalidated, store, entry]() {
+                    auto& url = revalidated->url;
+                    if (!store) {
+                        respondFromCache(*revalidated);
+                        m_cache->remove(url);
+                        return;
+                    }
+                    std::vector<char> content;
+                    if (m_cache->load(url, content)) {
+                        // Store with the new expiry
+                        m_cache->store(url, entry, content);
+                    }
+                    respondFromCache(*revalidated);
+                });
+            } else if (store) {
+                m_dispatcher->enqueue([this, url = std::move(storeUrl), entry, content = response.content]() {
+                    m_cache->store(url, entry, content);
+                });
+            }
+
             // Always run callback regardless of request result.
             if (callback) {
-                m_dispatcher.enqueue([callback = std::move(callback),
+                m_dispatcher->enqueue([callback = std::move(callback),
                                       response = std::move(response)]() mutable {
                                          callback(std::move(response));
                                      });
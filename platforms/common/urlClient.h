@@ -28,6 +28,26 @@ public:
         uint32_t connectionTimeoutMs = 3000;
         uint32_t requestTimeoutMs = 30000;
         const char* userAgentString = "tangram";
+        // Active requests with at least this priority are interrupted and
+        // queued again when a request with a lower priority is waiting.
+        double preemptablePriority = url_priority_background;
+        // Directory of the HTTP disk cache, no responses are cached when unset
+        const char* cachePath = nullptr;
+        // Least recently used responses are removed beyond this size
+        uint64_t cacheMaxSize = 100 * 1024 * 1024;
+        // Multiplex requests to a host over one HTTP/2 connection when the
+        // server supports it (negotiated with TLS ALPN)
+        bool http2 = true;
+        // Connection limits, 0 for no limit. Requests beyond the limits wait
+        // for a free connection. Without a host limit, up to maxActiveTasks
+        // requests may open connections to the same host; set it to e.g. 6
+        // to share fewer connections with HTTP/1.1 servers.
+        uint32_t maxHostConnections = 0;
+        uint32_t maxTotalConnections = 0;
+        // Idle time in seconds before TCP keep-alive probes are sent, 0 to disable
+        uint32_t keepAliveIdleSec = 60;
+        // How long resolved host names are reused, in seconds
+        uint32_t dnsCacheTimeoutSec = 300;
     };
 
     UrlClient(Options options);
@@ -35,16 +55,22 @@ public:
 
     using RequestId = uint64_t;
 
-    RequestId addRequest(const std::string& url, UrlCallback cb);
+    // Pending requests are started in order of priority, lower values first
+    RequestId addRequest(const std::string& url, UrlCallback cb, double priority = 0);
 
     void cancelRequest(RequestId request);
 
+    void setRequestPriority(RequestId request, double priority);
+
 private:
 
     struct Request {
         std::string url;
         UrlCallback callback;
         RequestId id;
+        double priority;
+        // Fetch from the network even when the response is cached
+        bool bypassCache = false;
     };
 
     class SelfPipe {
@@ -66,26 +92,55 @@ private:
     };
 
     struct Task;
+    class DiskCache;
 
     void curlLoop();
     void curlWakeUp();
 
     void startPendingRequests();
 
+    // Insert _request into m_requests, after requests of the same priority
+    void queueRequest(Request&& _request);
+
+    // Stop an active task for a more urgent request. Returns false when no
+    // task can be preempted for _priority.
+    bool preemptTask(double _priority);
+
+    // Respond to _request with cached content, or fetch it again when the
+    // content is no longer available. Runs on m_dispatcher.
+    void respondFromCache(Request& _request);
+
+    // Queue _request to be fetched from the network
+    void requeueRequest(Request&& _request);
+
+    // Finish the requests in m_requests with a canceled response, requires
+    // m_requestMutex
+    void cancelPendingRequests();
+
     Options m_options;
 
     // Curl multi handle
     void *m_curlHandle = nullptr;
 
+    // Curl share handle for DNS and TLS sessions of all easy handles
+    void *m_curlShare = nullptr;
+
     bool m_curlRunning = false;
     bool m_curlNotified = false;
 
     std::unique_ptr<std::thread> m_curlWorker;
-    AsyncWorker m_dispatcher;
+
+    // Used from m_dispatcher, which reads and writes the cache files
+    std::unique_ptr<DiskCache> m_cache;
+
+    // Runs callbacks and cache access. Stopped first in the destructor,
+    // since its tasks use the other members.
+    std::unique_ptr<AsyncWorker> m_dispatcher;
 
     std::list<Task> m_tasks;
     uint32_t m_activeTasks = 0;
 
+    // Pending requests, sorted by priority
     std::deque<Request> m_requests;
 
     // Synchronize m_tasks and m_requests
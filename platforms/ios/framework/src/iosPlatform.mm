@@ -172,11 +172,13 @@ bool iOSPlatform::startUrlRequestImpl(const Url& _url, const UrlRequestHandle _r
         if (error != nil) {
 
             urlResponse.error = [error.localizedDescription UTF8String];
+            urlResponse.timedOut = (error.code == NSURLErrorTimedOut);
 
         } else if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
 
             NSHTTPURLResponse* httpResponse = (NSHTTPURLResponse*)response;
             long statusCode = [httpResponse statusCode];
+            urlResponse.status = int(statusCode);
             if (statusCode < 200 || statusCode >= 300) {
                 urlResponse.error = [[NSHTTPURLResponse localizedStringForStatusCode: statusCode] UTF8String];
             }
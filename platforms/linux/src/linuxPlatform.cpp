@@ -82,7 +82,8 @@ bool LinuxPlatform::startUrlRequestImpl(const Url& _url, const UrlRequestHandle
     _id = m_urlClient->addRequest(_url.string(),
                                   [this, _request](UrlResponse&& response) {
                                       onUrlResponse(_request, std::move(response));
-                                  });
+                                  },
+                                  urlRequestPriority(_request));
     return true;
 }
 
@@ -92,6 +93,12 @@ void LinuxPlatform::cancelUrlRequestImpl(const UrlRequestId _id) {
     }
 }
 
+void LinuxPlatform::setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) {
+    if (m_urlClient) {
+        m_urlClient->setRequestPriority(_id, _priority);
+    }
+}
+
 void setCurrentThreadPriority(int priority) {
     setpriority(PRIO_PROCESS, 0, priority);
 }
@@ -21,6 +21,7 @@ public:
 
     bool startUrlRequestImpl(const Url& _url, const UrlRequestHandle _request, UrlRequestId& _id) override;
     void cancelUrlRequestImpl(const UrlRequestId _id) override;
+    void setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) override;
 
 protected:
     FcConfig* m_fcConfig = nullptr;
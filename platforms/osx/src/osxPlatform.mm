@@ -149,11 +149,13 @@ bool OSXPlatform::startUrlRequestImpl(const Url& _url, const UrlRequestHandle _r
         if (error != nil) {
 
             urlResponse.error = [error.localizedDescription UTF8String];
+            urlResponse.timedOut = (error.code == NSURLErrorTimedOut);
 
         } else if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
 
             NSHTTPURLResponse* httpResponse = (NSHTTPURLResponse*)response;
             int statusCode = [httpResponse statusCode];
+            urlResponse.status = int(statusCode);
             if (statusCode >= 400) {
                 urlResponse.error = [[NSHTTPURLResponse localizedStringForStatusCode: statusCode] UTF8String];
             }
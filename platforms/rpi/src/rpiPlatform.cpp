@@ -68,7 +68,8 @@ bool RpiPlatform::startUrlRequestImpl(const Url& _url, const UrlRequestHandle _r
     _id = m_urlClient.addRequest(_url.string(),
                                  [this, _request](UrlResponse&& response) {
                                      onUrlResponse(_request, std::move(response));
-                                 });
+                                 },
+                                 urlRequestPriority(_request));
     return true;
 }
 
@@ -76,6 +77,10 @@ void RpiPlatform::cancelUrlRequestImpl(const UrlRequestId _id) {
     m_urlClient.cancelRequest(_id);
 }
 
+void RpiPlatform::setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) {
+    m_urlClient.setRequestPriority(_id, _priority);
+}
+
 RpiPlatform::~RpiPlatform() {}
 
 void setCurrentThreadPriority(int priority) {
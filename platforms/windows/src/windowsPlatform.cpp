@@ -58,7 +58,7 @@ bool WindowsPlatform::startUrlRequestImpl(const Url& _url, const UrlRequestHandl
     auto onURLResponse = [this, _request](UrlResponse&& response) {
         onUrlResponse(_request, std::move(response));
     };
-    _id = m_urlClient->addRequest(_url.string(), onURLResponse);
+    _id = m_urlClient->addRequest(_url.string(), onURLResponse, urlRequestPriority(_request));
     return false;
 }
 
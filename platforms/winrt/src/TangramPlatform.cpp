@@ -46,7 +46,7 @@ namespace TangramWinRT {
 		if (_url.hasHttpScheme())
 		{
 			auto onURLResponse = [this, _request](UrlResponse&& response) { onUrlResponse(_request, std::move(response)); };
-			_id = m_urlClient->addRequest(_url.string(), onURLResponse);
+			_id = m_urlClient->addRequest(_url.string(), onURLResponse, urlRequestPriority(_request));
 			return true;
 		}
 
@@ -81,4 +81,8 @@ namespace TangramWinRT {
 	void TangramPlatform::cancelUrlRequestImpl(const UrlRequestId _id) {
 		if (m_urlClient) { m_urlClient->cancelRequest(_id); }
 	}
+
+	void TangramPlatform::setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) {
+		if (m_urlClient) { m_urlClient->setRequestPriority(_id, _priority); }
+	}
 } // namespace Tangram
\ No newline at end of file
@@ -20,6 +20,7 @@ public:
     bool startUrlRequestImpl(const Tangram::Url& _url, const Tangram::UrlRequestHandle _request,
                              UrlRequestId& _id) override;
     void cancelUrlRequestImpl(const UrlRequestId _id) override;
+    void setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) override;
 
 private:
     SwapChainPanel^m_swapChainPanel;
@@ -67,7 +67,7 @@ bool TangramPlatform::startUrlRequestImpl(const Tangram::Url& _url, const Tangra
             onUrlResponse(_request, std::move(response));
             };
 
-        _id = m_urlClient->addRequest(_url.string(), std::move(onURLResponse));
+        _id = m_urlClient->addRequest(_url.string(), std::move(onURLResponse), urlRequestPriority(_request));
         // true means the request can be cancelled
         return true;
     }
@@ -126,4 +126,8 @@ void TangramPlatform::cancelUrlRequestImpl(const UrlRequestId _id) {
     if (m_urlClient) { m_urlClient->cancelRequest(_id); }
 }
 
+void TangramPlatform::setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) {
+    if (m_urlClient) { m_urlClient->setRequestPriority(_id, _priority); }
+}
+
 } // namespace TangramWinUI
\ No newline at end of file
@@ -19,6 +19,7 @@ public:
     std::vector<Tangram::FontSourceHandle> systemFontFallbacksHandle() const override;
     bool startUrlRequestImpl(const Tangram::Url& _url, const Tangram::UrlRequestHandle _request, UrlRequestId& _id) override;
     void cancelUrlRequestImpl(const UrlRequestId _id) override;
+    void setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) override;
 
 private:
     winrt::TangramWinUI::implementation::MapController& m_controller;
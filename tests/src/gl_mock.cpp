@@ -1,7 +1,20 @@
 #include "gl.h"
+#include "gl_mock.h"
+
+#include <functional>
+#include <string>
 
 namespace Tangram {
 
+GLMock::Calls GLMock::calls;
+
+// Object names handed out by the gen* and create* functions
+static GLuint s_lastName = 0;
+
+static void genNames(GLsizei n, GLuint* names) {
+    for (GLsizei i = 0; i < n; i++) { names[i] = ++s_lastName; }
+}
+
 GLenum GL::getError() {
     return 0;
 }
@@ -18,32 +31,43 @@ void GL::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
 }
 
 void GL::enable(GLenum id) {
+    GLMock::calls.state++;
 }
 void GL::disable(GLenum id) {
+    GLMock::calls.state++;
 }
 void GL::depthFunc(GLenum func) {
+    GLMock::calls.state++;
 }
 void GL::depthMask(GLboolean flag) {
+    GLMock::calls.state++;
 }
 void GL::depthRange(GLfloat n, GLfloat f) {
 }
 void GL::clearDepth(GLfloat d) {
 }
 void GL::blendFunc(GLenum sfactor, GLenum dfactor) {
+    GLMock::calls.state++;
 }
 void GL::stencilFunc(GLenum func, GLint ref, GLuint mask) {
+    GLMock::calls.state++;
 }
 void GL::stencilMask(GLuint mask) {
+    GLMock::calls.state++;
 }
 void GL::stencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
+    GLMock::calls.state++;
 }
 void GL::clearStencil(GLint s) {
 }
 void GL::colorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha) {
+    GLMock::calls.state++;
 }
 void GL::cullFace(GLenum mode) {
+    GLMock::calls.state++;
 }
 void GL::frontFace(GLenum mode) {
+    GLMock::calls.state++;
 }
 void GL::clearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) {
 }
@@ -52,16 +76,17 @@ void GL::getIntegerv(GLenum pname, GLint *params ) {
 
 // Program
 void GL::useProgram(GLuint program) {
+    GLMock::calls.program++;
 }
 void GL::deleteProgram(GLuint program) {
 }
 void GL::deleteShader(GLuint shader) {
 }
 GLuint GL::createShader(GLenum type) {
-    return 0;
+    return ++s_lastName;
 }
 GLuint GL::createProgram() {
-    return 0;
+    return ++s_lastName;
 }
 
 void GL::compileShader(GLuint shader) {
@@ -78,14 +103,17 @@ void GL::getShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLcha
 void GL::getProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {
 }
 GLint GL::getUniformLocation(GLuint program, const GLchar *name) {
-    return 0;
+    // Distinct locations, so that uniform values are cached per name
+    return std::hash<std::string>()(name) & 0xffff;
 }
 GLint GL::getAttribLocation(GLuint program, const GLchar *name) {
     return 0;
 }
 void GL::getProgramiv(GLuint program, GLenum pname, GLint *params) {
+    *params = (pname == GL_LINK_STATUS) ? GL_TRUE : 0;
 }
 void GL::getShaderiv(GLuint shader, GLenum pname, GLint *params) {
+    *params = (pname == GL_COMPILE_STATUS) ? GL_TRUE : 0;
 }
 
 // Buffers
@@ -94,10 +122,15 @@ void GL::bindBuffer(GLenum target, GLuint buffer) {
 void GL::deleteBuffers(GLsizei n, const GLuint *buffers) {
 }
 void GL::genBuffers(GLsizei n, GLuint *buffers) {
+    genNames(n, buffers);
 }
 void GL::bufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    GLMock::calls.buffer++;
+    if (data) { GLMock::calls.bufferBytes += size; }
 }
 void GL::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data) {
+    GLMock::calls.buffer++;
+    GLMock::calls.bufferBytes += size;
 }
 void GL::readPixels(GLint x, GLint y, GLsizei width, GLsizei height,
                     GLenum format, GLenum type, GLvoid* pixels) {
@@ -105,10 +138,13 @@ void GL::readPixels(GLint x, GLint y, GLsizei width, GLsizei height,
 
 // Texture
 void GL::bindTexture(GLenum target, GLuint texture ) {
+    GLMock::calls.texture++;
 }
 void GL::activeTexture(GLenum texture) {
+    GLMock::calls.texture++;
 }
 void GL::genTextures(GLsizei n, GLuint *textures ) {
+    genNames(n, textures);
 }
 void GL::deleteTextures(GLsizei n, const GLuint *textures) {
 }
@@ -132,50 +168,71 @@ void GL::vertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean no
 }
 
 void GL::drawArrays(GLenum mode, GLint first, GLsizei count ) {
+    GLMock::calls.draw++;
 }
 void GL::drawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices ) {
+    GLMock::calls.draw++;
 }
 
 void GL::uniform1f(GLint location, GLfloat v0) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform2f(GLint location, GLfloat v0, GLfloat v1) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+    GLMock::calls.uniform++;
 }
 
 void GL::uniform1i(GLint location, GLint v0) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform2i(GLint location, GLint v0, GLint v1) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform3i(GLint location, GLint v0, GLint v1, GLint v2) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform4i(GLint location, GLint v0, GLint v1, GLint v2, GLint v3) {
+    GLMock::calls.uniform++;
 }
 
 void GL::uniform1fv(GLint location, GLsizei count, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform2fv(GLint location, GLsizei count, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform3fv(GLint location, GLsizei count, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform4fv(GLint location, GLsizei count, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform1iv(GLint location, GLsizei count, const GLint *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform2iv(GLint location, GLsizei count, const GLint *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform3iv(GLint location, GLsizei count, const GLint *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniform4iv(GLint location, GLsizei count, const GLint *value) {
+    GLMock::calls.uniform++;
 }
 
 void GL::uniformMatrix2fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 void GL::uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) {
+    GLMock::calls.uniform++;
 }
 
 // mapbuffer
@@ -195,12 +252,14 @@ void GL::bindVertexArray(GLuint array) {
 void GL::deleteVertexArrays(GLsizei n, const GLuint *arrays) {
 }
 void GL::genVertexArrays(GLsizei n, GLuint *arrays) {
+    genNames(n, arrays);
 }
 
 // Framebuffer
 void GL::bindFramebuffer(GLenum target, GLuint framebuffer) {
 }
 void GL::genFramebuffers(GLsizei n, GLuint *framebuffers) {
+    genNames(n, framebuffers);
 }
 void GL::framebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget,
                               GLuint texture, GLint level) {
@@ -212,6 +271,7 @@ void GL::framebufferRenderbuffer(GLenum target, GLenum attachment,
                                  GLenum renderbuffertarget, GLuint renderbuffer) {
 }
 void GL::genRenderbuffers(GLsizei n, GLuint *renderbuffers) {
+    genNames(n, renderbuffers);
 }
 void GL::bindRenderbuffer(GLenum target, GLuint renderbuffer) {
 }
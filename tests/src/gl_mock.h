@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Tangram {
+namespace GLMock {
+
+// Number of calls made to the mocked GL functions, by kind
+struct Calls {
+    // useProgram
+    size_t program = 0;
+    // activeTexture, bindTexture
+    size_t texture = 0;
+    // uniform*
+    size_t uniform = 0;
+    // enable, disable, depth, blend, stencil and color mask functions
+    size_t state = 0;
+    // drawArrays, drawElements
+    size_t draw = 0;
+    // bufferData, bufferSubData
+    size_t buffer = 0;
+
+    // Bytes passed to bufferData and bufferSubData
+    size_t bufferBytes = 0;
+
+    size_t total() const { return program + texture + uniform + state + draw + buffer; }
+};
+
+extern Calls calls;
+
+inline void resetCalls() { calls = Calls(); }
+
+}
+}
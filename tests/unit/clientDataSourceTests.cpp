@@ -0,0 +1,416 @@
+#include "catch.hpp"
+
+#include "data/clientDataSource.h"
+#include "data/featureStore.h"
+#include "data/propertyItem.h"
+#include "data/tileData.h"
+#include "mockPlatform.h"
+#include "tile/tileTask.h"
+#include "util/mapProjection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <thread>
+
+using namespace Tangram;
+
+std::string pointFeature(uint64_t _id, LngLat _coordinates, double _version) {
+    return R"({"type":"Feature","id":)" + std::to_string(_id) +
+        R"(,"geometry":{"type":"Point","coordinates":[)" +
+        std::to_string(_coordinates.longitude) + "," + std::to_string(_coordinates.latitude) +
+        R"(]},"properties":{"version":)" + std::to_string(_version) + "}}";
+}
+
+std::string featureCollection(const std::string& _features) {
+    return R"({"type":"FeatureCollection","features":[)" + _features + "]}";
+}
+
+TileID tileAt(LngLat _coordinates, int _zoom) {
+    auto meters = MapProjection::lngLatToProjectedMeters(_coordinates);
+    double metersPerTile = MapProjection::metersPerTileAtZoom(_zoom);
+    return TileID(int32_t(std::floor((meters.x + MapProjection::EARTH_HALF_CIRCUMFERENCE_METERS) / metersPerTile)),
+                  int32_t(std::floor((MapProjection::EARTH_HALF_CIRCUMFERENCE_METERS - meters.y) / metersPerTile)),
+                  _zoom);
+}
+
+std::vector<double> versions(TileSource& _source, TileID _tileId) {
+    auto task = _source.createTask(_tileId);
+    auto data = _source.parse(*task);
+
+    std::vector<double> result;
+    if (data) {
+        for (auto& feature : data->layers[0].features) {
+            result.push_back(feature.props.getNumber("version"));
+        }
+    }
+    return result;
+}
+
+const LngLat pointA{10.0, 50.0};
+const LngLat pointB{11.0, 50.0};
+const LngLat pointC{12.0, 50.0};
+
+TEST_CASE("ClientDataSource updates and removes features by id", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+    source->setCanUpdateFeatures(true);
+
+    REQUIRE(source->addData(featureCollection(pointFeature(1, pointA, 0) + "," +
+                                              pointFeature(2, pointB, 0) + "," +
+                                              pointFeature(3, pointC, 0))) == 3);
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointA, 12)) == std::vector<double>{0});
+
+    // Update the first feature, so that it is not affected by moving the last
+    REQUIRE(source->appendOrUpdateFeatures(featureCollection(pointFeature(1, pointA, 1))) == 1);
+
+    size_t ids[] = { 2, 42 };
+    REQUIRE(source->removeFeatures(ids, 2) == 1);
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointA, 12)) == std::vector<double>{1});
+    CHECK(versions(*source, tileAt(pointB, 12)).empty());
+    CHECK(versions(*source, tileAt(pointC, 12)) == std::vector<double>{0});
+
+    // Removed ids can be added again
+    REQUIRE(source->appendOrUpdateFeatures(featureCollection(pointFeature(2, pointB, 2))) == 1);
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointB, 12)) == std::vector<double>{2});
+}
+
+TEST_CASE("ClientDataSource keeps the order of features when removing", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+    source->setCanUpdateFeatures(true);
+
+    // Enough features that removing most of them reclaims their slots
+    const size_t count = 3000;
+    std::string features;
+    for (size_t i = 1; i <= count; i++) {
+        if (i > 1) { features += ","; }
+        features += pointFeature(i, pointA, i);
+    }
+    REQUIRE(source->addData(featureCollection(features)) == count);
+    source->generateTiles();
+
+    size_t ids[] = { 2, 4 };
+    REQUIRE(source->removeFeatures(ids, 2) == 2);
+    source->generateTiles();
+
+    auto remaining = versions(*source, tileAt(pointA, 12));
+    REQUIRE(remaining.size() == count - 2);
+    CHECK(remaining[0] == 1);
+    CHECK(remaining[1] == 3);
+    CHECK(remaining[2] == 5);
+    CHECK(std::is_sorted(remaining.begin(), remaining.end()));
+
+    std::vector<size_t> even;
+    for (size_t i = 6; i <= count; i += 2) { even.push_back(i); }
+    std::vector<size_t> first;
+    for (size_t i = 1; i <= count / 2; i += 2) { first.push_back(i); }
+
+    REQUIRE(source->removeFeatures(even.data(), even.size()) == even.size());
+    REQUIRE(source->removeFeatures(first.data(), first.size()) == first.size());
+    source->generateTiles();
+
+    remaining = versions(*source, tileAt(pointA, 12));
+    REQUIRE(remaining.size() == count / 4);
+    CHECK(remaining.front() == count / 2 + 1);
+    CHECK(std::is_sorted(remaining.begin(), remaining.end()));
+
+    // Updated features keep their place
+    REQUIRE(source->appendOrUpdateFeatures(featureCollection(pointFeature(count / 2 + 1, pointA, count + 1))) == 1);
+    source->generateTiles();
+
+    remaining = versions(*source, tileAt(pointA, 12));
+    REQUIRE(remaining.size() == count / 4);
+    CHECK(remaining.front() == count + 1);
+    CHECK(std::is_sorted(remaining.begin() + 1, remaining.end()));
+}
+
+TEST_CASE("ClientDataSource invalidates only tiles of changed features", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+    source->setCanUpdateFeatures(true);
+
+    source->addData(featureCollection(pointFeature(1, pointA, 0) + "," +
+                                      pointFeature(2, pointB, 0)));
+    source->generateTiles();
+
+    auto generation = source->generation();
+    CHECK(source->generation(tileAt(pointA, 14)) <= generation);
+    CHECK(source->generation(tileAt(pointB, 14)) <= generation);
+
+    // Moving a feature invalidates the tiles at its old and new position
+    LngLat moved{pointB.longitude, pointB.latitude + 1.0};
+    source->appendOrUpdateFeatures(featureCollection(pointFeature(2, moved, 1)));
+    source->generateTiles();
+
+    CHECK(source->generation() > generation);
+    CHECK(source->generation(tileAt(pointA, 14)) <= generation);
+    CHECK(source->generation(tileAt(pointB, 14)) > generation);
+    CHECK(source->generation(tileAt(moved, 14)) > generation);
+
+    // Tiles below the partition zoom contain all features
+    CHECK(source->generation(tileAt(pointA, 4)) > generation);
+
+    CHECK(versions(*source, tileAt(pointB, 14)).empty());
+    CHECK(versions(*source, tileAt(moved, 14)) == std::vector<double>{1});
+
+    // Without changes the generation stays the same
+    generation = source->generation();
+    source->generateTiles();
+    CHECK(source->generation() == generation);
+}
+
+TEST_CASE("ClientDataSource cuts partitions from their own features", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+    source->setCanUpdateFeatures(true);
+
+    // A polygon overlapping many partitions between two points
+    std::string polygon = R"({"type":"Feature","id":2,"geometry":{"type":"Polygon","coordinates":)"
+        R"([[[0,40],[20,40],[20,60],[0,60],[0,40]]]},"properties":{"version":2}})";
+
+    const size_t count = 3000;
+    std::string features = pointFeature(1, pointA, 1) + "," + polygon + "," + pointFeature(3, pointA, 3);
+    for (size_t i = 4; i <= count; i++) {
+        features += "," + pointFeature(i, pointB, i);
+    }
+    features += "," + pointFeature(count + 1, pointC, count + 1);
+    REQUIRE(source->addData(featureCollection(features)) == count + 1);
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointA, 12)) == std::vector<double>{1, 2, 3});
+    CHECK(versions(*source, tileAt(pointC, 12)) == std::vector<double>{2, double(count + 1)});
+
+    // Reclaiming the removed slots moves the remaining features. Tiles cut
+    // before generateTiles() must not refer to the old slots.
+    std::vector<size_t> ids;
+    for (size_t i = 4; i <= count; i++) { ids.push_back(i); }
+    REQUIRE(source->removeFeatures(ids.data(), ids.size()) == ids.size());
+
+    CHECK(versions(*source, tileAt(pointC, 12)) == std::vector<double>{2, double(count + 1)});
+    CHECK(versions(*source, tileAt(pointB, 12)) == std::vector<double>{2});
+
+    // Moving the polygon away
+    std::string moved = R"({"type":"Feature","id":2,"geometry":{"type":"Polygon","coordinates":)"
+        R"([[[-20,-60],[-10,-60],[-10,-50],[-20,-50],[-20,-60]]]},"properties":{"version":4}})";
+    REQUIRE(source->appendOrUpdateFeatures(featureCollection(moved)) == 1);
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointA, 12)) == std::vector<double>{1, 3});
+    CHECK(versions(*source, tileAt({-15, -55}, 12)) == std::vector<double>{4});
+}
+
+TEST_CASE("ClientDataSource adds features from columns", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+
+    ClientDataSource::FeatureColumns points;
+    points.coordinates = { pointA.longitude, pointA.latitude,
+                           pointB.longitude, pointB.latitude };
+    points.addColumn("version", std::vector<double>{ 1, NAN });
+    points.addColumn("name", std::vector<std::string>{ "a", "b" });
+
+    REQUIRE(source->addFeatures(std::move(points)) == 2);
+
+    // One polygon with a hole around pointC
+    ClientDataSource::FeatureColumns polygons;
+    polygons.type = ClientDataSource::FeatureColumns::Type::polygons;
+    polygons.coordinates = { 11.9, 49.9, 12.1, 49.9, 12.1, 50.1, 11.9, 50.1, 11.9, 49.9,
+                             11.99, 49.99, 11.99, 50.01, 12.01, 50.01, 11.99, 49.99 };
+    polygons.ringOffsets = { 0, 5, 9 };
+    polygons.polygonOffsets = { 0, 2 };
+    polygons.addColumn("version", std::vector<double>{ 2 });
+
+    REQUIRE(source->addFeatures(std::move(polygons)) == 1);
+
+    // Offsets beyond the coordinates are rejected
+    ClientDataSource::FeatureColumns invalid;
+    invalid.type = ClientDataSource::FeatureColumns::Type::lines;
+    invalid.coordinates = { 0, 0, 1, 1 };
+    invalid.ringOffsets = { 0, 3 };
+    CHECK(source->addFeatures(std::move(invalid)) == 0);
+
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointA, 12)) == std::vector<double>{1});
+    CHECK(versions(*source, tileAt({12.05, 50.05}, 12)) == std::vector<double>{2});
+
+    auto task = source->createTask(tileAt(pointB, 12));
+    auto data = static_cast<TileSource&>(*source).parse(*task);
+    REQUIRE(data);
+    REQUIRE(data->layers[0].features.size() == 1);
+    auto& props = data->layers[0].features[0].props;
+    CHECK(props.getString("name") == "b");
+    CHECK(!props.contains("version"));
+}
+
+TEST_CASE("ClientDataSource adds GeoJSON data in chunks", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+
+    std::string data = featureCollection(pointFeature(1, pointA, 1) + "," +
+                                         R"({"type":"Feature","geometry":{"type":"Point","coordinates":[)" +
+                                         std::to_string(pointB.longitude) + "," + std::to_string(pointB.latitude) +
+                                         R"(]},"properties":{"name":"a \"quoted\" ]} name"}})" + "," +
+                                         pointFeature(3, pointC, 3));
+
+    // Split the data at odd positions, also within strings and numbers
+    size_t added = 0;
+    source->beginData();
+    for (size_t pos = 0; pos < data.size(); pos += 7) {
+        size_t length = std::min<size_t>(7, data.size() - pos);
+        added += source->addDataChunk(data.data() + pos, length);
+    }
+    added += source->endData();
+    REQUIRE(added == 3);
+
+    source->generateTiles();
+
+    CHECK(versions(*source, tileAt(pointA, 12)) == std::vector<double>{1});
+    CHECK(versions(*source, tileAt(pointC, 12)) == std::vector<double>{3});
+
+    auto task = source->createTask(tileAt(pointB, 12));
+    auto tile = static_cast<TileSource&>(*source).parse(*task);
+    REQUIRE(tile);
+    REQUIRE(tile->layers[0].features.size() == 1);
+    CHECK(tile->layers[0].features[0].props.getString("name") == "a \"quoted\" ]} name");
+
+    // A single feature is added as a whole once it is complete
+    std::string feature = pointFeature(4, pointA, 4);
+    source->beginData();
+    CHECK(source->addDataChunk(feature.data(), 10) == 0);
+    CHECK(source->addDataChunk(feature.data() + 10, feature.size() - 10) == 1);
+    CHECK(source->endData() == 0);
+
+    // So is a geometry
+    std::string geometry = R"( {"type":"Point","coordinates":[)" +
+        std::to_string(pointC.longitude) + "," + std::to_string(pointC.latitude) + "]}";
+    source->beginData();
+    CHECK(source->addDataChunk(geometry.data(), 20) == 0);
+    CHECK(source->addDataChunk(geometry.data() + 20, geometry.size() - 20) == 1);
+    CHECK(source->endData() == 0);
+
+    // Other documents are rejected
+    std::string array = "[" + feature + "]";
+    source->beginData();
+    CHECK(source->addDataChunk(array.data(), array.size()) == 0);
+    CHECK(source->endData() == 0);
+
+    // Incomplete documents add nothing
+    source->beginData();
+    CHECK(source->addDataChunk(feature.data(), feature.size() - 1) == 0);
+    CHECK(source->endData() == 0);
+}
+
+TEST_CASE("ClientDataSource parses tiles from several threads", "[ClientDataSource]") {
+    MockPlatform platform;
+    auto source = std::make_shared<ClientDataSource>(platform, "test", "");
+
+    // One point in each quadrant of the world
+    const LngLat points[] = { {-90, 45}, {90, 45}, {-90, -45}, {90, -45} };
+
+    ClientDataSource::FeatureColumns columns;
+    std::vector<double> index;
+    for (auto& p : points) {
+        columns.coordinates.push_back(p.longitude);
+        columns.coordinates.push_back(p.latitude);
+        index.push_back(index.size());
+    }
+    columns.addColumn("version", std::move(index));
+    source->addFeatures(std::move(columns));
+    source->generateTiles();
+
+    std::vector<std::thread> workers;
+    std::vector<std::vector<double>> results(8);
+    for (size_t i = 0; i < results.size(); i++) {
+        workers.emplace_back([&, i]() {
+            // Cut tiles from the quadrant indices and the partitions
+            int zoom = i < 4 ? 3 : 12;
+            results[i] = versions(*source, tileAt(points[i % 4], zoom));
+        });
+    }
+    for (auto& worker : workers) { worker.join(); }
+
+    for (size_t i = 0; i < results.size(); i++) {
+        CHECK(results[i] == std::vector<double>{ double(i % 4) });
+    }
+}
+
+TEST_CASE("GeometryStore keeps geometries of replaced and removed slots apart", "[ClientDataSource]") {
+    using namespace mapbox::geometry;
+
+    GeometryStore store;
+
+    polygon<double> square{ { {0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 0} } };
+    multi_polygon<double> squares{ square, square };
+    squares[1][0][2] = { 2, 2 };
+
+    for (size_t i = 0; i < 1000; i++) {
+        store.set(i, point<double>(double(i) / 10, 1.2345678));
+    }
+    store.set(1000, squares);
+
+    // Replace and remove enough geometries to trigger compaction
+    for (int pass = 0; pass < 3; pass++) {
+        for (size_t i = 0; i < 1000; i += 2) {
+            store.set(i, line_string<double>{ {0, 0}, {double(i), 1}, {2, 2} });
+        }
+    }
+    // Removed slots stay empty until they are erased
+    store.remove(1);
+    CHECK(store.get(1).is<mapbox::geometry::empty>());
+
+    std::vector<bool> erase(1001, false);
+    erase[1] = true;
+    for (size_t i = 500; i < 800; i++) { erase[i] = true; }
+    store.eraseSlots(erase);
+    REQUIRE(store.size() == 700);
+
+    // Remaining slots keep their order
+    auto geom = store.get(699);
+    REQUIRE(geom.is<multi_polygon<double>>());
+    auto& decoded = geom.get<multi_polygon<double>>();
+    REQUIRE(decoded.size() == 2);
+    CHECK(decoded[0][0].size() == 5);
+    CHECK(decoded[1][0][2].x == 2);
+
+    auto line = store.get(0);
+    REQUIRE(line.is<line_string<double>>());
+    CHECK(line.get<line_string<double>>().size() == 3);
+
+    auto last = store.get(698);
+    REQUIRE(last.is<point<double>>());
+    CHECK(last.get<point<double>>().x == Approx(99.9));
+    CHECK(last.get<point<double>>().y == Approx(1.2345678).epsilon(1e-7));
+}
+
+TEST_CASE("PropertyStore shares equal properties", "[ClientDataSource]") {
+    PropertyStore store;
+
+    Properties a, b, c;
+    a.set("kind", "bus");
+    a.set("line", 42);
+    b.set("line", 42);
+    b.set("kind", "bus");
+    c.set("kind", "tram");
+
+    auto idA = store.add(std::move(a));
+    auto idB = store.add(std::move(b));
+    auto idC = store.add(std::move(c));
+
+    CHECK(idA == idB);
+    CHECK(idA != idC);
+    CHECK(store.size() == 2);
+
+    store.release(idA);
+    CHECK(store.size() == 2);
+    store.release(idB);
+    CHECK(store.size() == 1);
+    CHECK(store.get(idC).getString("kind") == "tram");
+}
@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include "gl/dynamicQuadMesh.h"
+#include "labels/labelCollider.h"
 #include "labels/labelManager.h"
+#include "labels/labelPlacement.h"
 #include "labels/textLabel.h"
 #include "labels/textLabels.h"
 #include "map.h"
@@ -12,6 +14,7 @@
 #include "view/view.h"
 
 #include <memory>
+#include <thread>
 
 namespace Tangram {
 
@@ -216,4 +219,344 @@ TEST_CASE( "Test anchor fallback behavior", "[Labels][AnchorFallback]" ) {
     }
 
 }
+
+TEST_CASE( "Test incremental placement keeps visible labels", "[Labels][Incremental]" ) {
+
+    View view(256, 256);
+    view.setConstrainToWorldBounds(false);
+    view.setPosition(0, 0);
+    view.setZoom(0);
+    view.update();
+
+    Tile tile({0,0,0});
+    tile.update(0, view);
+
+    class TestLabels : public LabelManager {
+    public:
+        TestLabels(View& _v) {
+            m_isect2d.resize({1, 1}, {_v.getWidth(), _v.getHeight()});
+            setIncrementalPlacement(true);
+        }
+
+        void addLabel(Label* _l, Tile* _t, View& _v, uint32_t _index) {
+            m_labels.push_back({_l, nullptr, _t, nullptr, false, {}, _index});
+            ScreenTransform transform(m_transforms, m_labels.back().transformRange);
+            _l->update(_t->mvp(), _v.state(), nullptr, transform);
+        }
+        void run(View& _v) {
+            if (!handleOcclusionsIncremental(_v.state())) {
+                handleOcclusions(_v.state());
+            }
+            storePlacements(_v.state());
+        }
+        void nextFrame() {
+            m_labels.clear();
+            m_obbs.clear();
+            m_transforms.clear();
+        }
+    };
+
+    TestLabels labels(view);
+
+    auto l1 = makeLabel(glm::vec2{0.2,0.2}, Label::Type::point, "1");
+    auto l2 = makeLabel(glm::vec2{0.8,0.2}, Label::Type::point, "2");
+    auto l3 = makeLabel(glm::vec2{0.2,0.8}, Label::Type::point, "3");
+    auto l4 = makeLabel(glm::vec2{0.8,0.8}, Label::Type::point, "4");
+
+    labels.addLabel(l1.get(), &tile, view, 0);
+    labels.addLabel(l2.get(), &tile, view, 1);
+    labels.addLabel(l3.get(), &tile, view, 2);
+    labels.addLabel(l4.get(), &tile, view, 3);
+    labels.run(view);
+
+    REQUIRE(l1->isOccluded() == false);
+
+    // A label entering the view at the position of l1, which would win
+    // a full placement since it comes first.
+    auto l5 = makeLabel(glm::vec2{0.2,0.2}, Label::Type::point, "5");
+
+    labels.nextFrame();
+    labels.addLabel(l5.get(), &tile, view, 4);
+    labels.addLabel(l1.get(), &tile, view, 0);
+    labels.addLabel(l2.get(), &tile, view, 1);
+    labels.addLabel(l3.get(), &tile, view, 2);
+    labels.addLabel(l4.get(), &tile, view, 3);
+    labels.run(view);
+
+    REQUIRE(l1->isOccluded() == false);
+    REQUIRE(l5->isOccluded() == true);
+    REQUIRE(l2->isOccluded() == false);
+    REQUIRE(l3->isOccluded() == false);
+    REQUIRE(l4->isOccluded() == false);
+}
+
+TEST_CASE( "Test incremental placement keeps labels when panning", "[Labels][Incremental]" ) {
+
+    View view(256, 256);
+    view.setConstrainToWorldBounds(false);
+    view.setPosition(0, 0);
+    view.setZoom(0);
+    view.update();
+
+    Tile tile({0,0,0});
+    tile.update(0, view);
+
+    // Tile of a label moving on its own between the frames
+    Tile other({0,0,1});
+    other.update(0, view);
+
+    class TestLabels : public LabelManager {
+    public:
+        TestLabels(View& _v) {
+            m_isect2d.resize({1, 1}, {_v.getWidth(), _v.getHeight()});
+            setIncrementalPlacement(true);
+        }
+
+        void addLabel(Label* _l, Tile* _t, View& _v, uint32_t _index) {
+            m_labels.push_back({_l, nullptr, _t, nullptr, false, {}, _index});
+            ScreenTransform transform(m_transforms, m_labels.back().transformRange);
+            _l->update(_t->mvp(), _v.state(), nullptr, transform);
+        }
+        void run(View& _v) {
+            if (!handleOcclusionsIncremental(_v.state())) {
+                handleOcclusions(_v.state());
+            }
+            storePlacements(_v.state());
+        }
+        void nextFrame() {
+            m_labels.clear();
+            m_obbs.clear();
+            m_transforms.clear();
+        }
+    };
+
+    TestLabels labels(view);
+
+    auto l1 = makeLabel(glm::vec2{0.2,0.2}, Label::Type::point, "1");
+    auto l2 = makeLabel(glm::vec2{0.8,0.2}, Label::Type::point, "2");
+    auto l3 = makeLabel(glm::vec2{0.2,0.8}, Label::Type::point, "3");
+    auto l4 = makeLabel(glm::vec2{0.8,0.8}, Label::Type::point, "4");
+    auto l7 = makeLabel(glm::vec2{0.5,0.2}, Label::Type::point, "7");
+    auto l8 = makeLabel(glm::vec2{0.2,0.5}, Label::Type::point, "8");
+    auto l9 = makeLabel(glm::vec2{0.8,0.5}, Label::Type::point, "9");
+    auto l10 = makeLabel(glm::vec2{0.5,0.8}, Label::Type::point, "10");
+    auto l6 = makeLabel(glm::vec2{0.5,0.5}, Label::Type::point, "6");
+
+    labels.addLabel(l6.get(), &other, view, 0);
+    uint32_t index = 0;
+    for (auto* l : { l1.get(), l2.get(), l3.get(), l4.get(),
+                l7.get(), l8.get(), l9.get(), l10.get() }) {
+        labels.addLabel(l, &tile, view, index++);
+    }
+    labels.run(view);
+
+    REQUIRE(l1->isOccluded() == false);
+
+    // Pan the view by a few pixels
+    view.translate(MapProjection::EARTH_CIRCUMFERENCE_METERS / 32, 0);
+    view.update();
+    tile.update(0, view);
+
+    // l6 comes first and does not move with the view since its tile is
+    // not updated, l5 enters at the position of l1 and would win a full
+    // placement.
+    auto l5 = makeLabel(glm::vec2{0.2,0.2}, Label::Type::point, "5");
+
+    labels.nextFrame();
+    labels.addLabel(l6.get(), &other, view, 0);
+    labels.addLabel(l5.get(), &tile, view, 8);
+    index = 0;
+    for (auto* l : { l1.get(), l2.get(), l3.get(), l4.get(),
+                l7.get(), l8.get(), l9.get(), l10.get() }) {
+        labels.addLabel(l, &tile, view, index++);
+    }
+    labels.run(view);
+
+    REQUIRE(l1->isOccluded() == false);
+    REQUIRE(l5->isOccluded() == true);
+    REQUIRE(l6->isOccluded() == false);
+    for (auto* l : { l2.get(), l3.get(), l4.get(), l7.get(), l8.get(), l9.get(), l10.get() }) {
+        REQUIRE(l->isOccluded() == false);
+    }
+}
+
+TEST_CASE( "Test parallel label collider matches sequential collider", "[Labels][LabelCollider]" ) {
+
+    // Dense enough to be split into partitions
+    const size_t numLabels = 4096;
+
+    std::vector<std::unique_ptr<Label>> parallelLabels;
+    std::vector<std::unique_ptr<Label>> sequentialLabels;
+
+    uint32_t seed = 1;
+    auto random = [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        return float(seed >> 8) / float(1 << 24);
+    };
+
+    for (size_t i = 0; i < numLabels; i++) {
+        glm::vec2 position{ random(), random() };
+        parallelLabels.push_back(makeLabel(position, Label::Type::point, ""));
+        sequentialLabels.push_back(makeLabel(position, Label::Type::point, ""));
+    }
+
+    LabelCollider parallel;
+    parallel.addLabels(parallelLabels);
+    parallel.process({0, 0, 0}, 1.f, 256.f);
+
+    LabelCollider sequential;
+    sequential.setParallel(false);
+    sequential.addLabels(sequentialLabels);
+    sequential.process({0, 0, 0}, 1.f, 256.f);
+
+    size_t numOccluded = 0;
+    for (size_t i = 0; i < numLabels; i++) {
+        REQUIRE(parallelLabels[i]->isOccluded() == sequentialLabels[i]->isOccluded());
+        if (parallelLabels[i]->isOccluded()) { numOccluded++; }
+    }
+    REQUIRE(numOccluded > 0);
+    REQUIRE(numOccluded < numLabels);
+}
+
+TEST_CASE( "Test async label placement", "[Labels][AsyncPlacement]" ) {
+
+    auto l1 = makeLabel(glm::vec2{0.5,0.5}, Label::Type::point, "1");
+    auto l2 = makeLabel(glm::vec2{0.5,0.5}, Label::Type::point, "2");
+    auto l3 = makeLabel(glm::vec2{0.8,0.8}, Label::Type::point, "3");
+
+    LabelPlacement placement;
+
+    auto* snapshot = placement.beginSnapshot();
+    REQUIRE(snapshot);
+
+    glm::vec2 positions[] = { {128, 128}, {130, 128}, {200, 200} };
+    Label* labels[] = { l1.get(), l2.get(), l3.get() };
+
+    for (int i = 0; i < 3; i++) {
+        snapshot->anchors.push_back(Range(snapshot->obbs.size(), 1));
+        snapshot->obbs.emplace_back(positions[i], glm::vec2{1, 0}, 10.f, 10.f);
+        snapshot->candidates.push_back({ labels[i], -1, Range(i, 1), 0, 0, 0.f,
+                    positions[i], false });
+    }
+    snapshot->viewportSize = {256, 256};
+
+    placement.submit();
+    REQUIRE(placement.beginSnapshot() == nullptr);
+
+    while (!placement.update()) { std::this_thread::yield(); }
+
+    REQUIRE(placement.isRunning() == false);
+    REQUIRE(placement.result(l1.get())->occluded == false);
+    REQUIRE(placement.result(l2.get())->occluded == true);
+    REQUIRE(placement.result(l3.get())->occluded == false);
+
+    auto l4 = makeLabel(glm::vec2{0.5,0.5}, Label::Type::point, "4");
+    REQUIRE(placement.result(l4.get()) == nullptr);
+}
+
+TEST_CASE( "Test async label placement keeps label owners alive", "[Labels][AsyncPlacement]" ) {
+
+    LabelPlacement placement;
+
+    auto tile = std::make_shared<Tile>(TileID(0, 0, 0));
+    std::weak_ptr<Tile> weakTile = tile;
+
+    auto* snapshot = placement.beginSnapshot();
+    snapshot->viewportSize = {256, 256};
+    snapshot->tiles.push_back(tile);
+    tile.reset();
+
+    placement.submit();
+    while (!placement.update()) { std::this_thread::yield(); }
+
+    // The result still refers to the labels of the tile
+    REQUIRE(weakTile.expired() == false);
+
+    snapshot = placement.beginSnapshot();
+    snapshot->viewportSize = {256, 256};
+
+    placement.submit();
+    while (!placement.update()) { std::this_thread::yield(); }
+
+    REQUIRE(weakTile.expired() == true);
+}
+
+TEST_CASE( "Test repeat groups with many labels", "[Labels][RepeatGroup]" ) {
+
+    View view(256, 256);
+    view.setConstrainToWorldBounds(false);
+    view.setPosition(0, 0);
+    view.setZoom(0);
+    view.update();
+
+    Tile tile({0,0,0});
+    tile.update(0, view);
+
+    class TestLabels : public LabelManager {
+    public:
+        TestLabels(View& _v) {
+            m_isect2d.resize({1, 1}, {_v.getWidth(), _v.getHeight()});
+        }
+
+        void addLabel(Label* _l, Tile* _t, View& _v) {
+            m_labels.push_back({_l, nullptr, _t, nullptr, false, {}});
+            ScreenTransform transform(m_transforms, m_labels.back().transformRange);
+            _l->update(_t->mvp(), _v.state(), nullptr, transform);
+        }
+        void run(View& _v) { handleOcclusions(_v.state()); }
+    };
+
+    const float repeatDistance = 20.f;
+
+    Label::Options options;
+    options.anchors.anchor[0] = LabelProperty::Anchor::center;
+    options.anchors.count = 1;
+    options.repeatGroup = 1;
+    options.repeatDistance = repeatDistance;
+
+    // 100x100 labels, one pixel apart and without size, so that only
+    // the repeat distance keeps them apart.
+    std::vector<std::unique_ptr<TextLabel>> labels;
+    for (int y = 0; y < 100; y++) {
+        for (int x = 0; x < 100; x++) {
+            glm::vec2 pos{ (28 + x) / 256., (28 + y) / 256. };
+            labels.emplace_back(new TextLabel({{glm::vec3(pos, 0)}}, Label::Type::point, options,
+                                              {}, {0, 0}, dummy, {},
+                                              TextLabelProperty::Align::none));
+        }
+    }
+    REQUIRE(labels.size() == 10000);
+
+    TestLabels manager(view);
+    for (auto& l : labels) { manager.addLabel(l.get(), &tile, view); }
+    manager.run(view);
+
+    std::vector<glm::vec2> visible;
+    for (auto& l : labels) {
+        if (!l->isOccluded()) { visible.push_back(l->screenCenter()); }
+    }
+
+    // The first label is always placed. Disks of radius repeatDistance/2
+    // around visible labels do not overlap and fit into a 120px square.
+    REQUIRE(!labels[0]->isOccluded());
+    REQUIRE(visible.size() > 1);
+    REQUIRE(visible.size() <= 45);
+
+    for (size_t i = 0; i < visible.size(); i++) {
+        for (size_t j = i + 1; j < visible.size(); j++) {
+            REQUIRE(glm::distance(visible[i], visible[j]) >= repeatDistance);
+        }
+    }
+
+    // Every occluded label must be within repeatDistance of a visible one
+    for (auto& l : labels) {
+        if (!l->isOccluded()) { continue; }
+        bool near = false;
+        for (auto& p : visible) {
+            if (glm::distance(l->screenCenter(), p) < repeatDistance) { near = true; break; }
+        }
+        REQUIRE(near);
+    }
+}
+
 }
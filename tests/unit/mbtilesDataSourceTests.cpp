@@ -0,0 +1,279 @@
+#include "catch.hpp"
+
+#include "data/mbtilesDataSource.h"
+#include "mockPlatform.h"
+#include "tile/tileTask.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+using namespace Tangram;
+
+#define TAGS "[MBTilesDataSource]"
+
+static const char* cachePath = "test.mbtiles";
+
+// Next source of the cache: serves the id of a tile as its data
+struct TileIdDataSource : public TileSource::DataSource {
+    std::atomic<int> loads{0};
+
+    bool loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) override {
+        loads++;
+        auto id = _task->tileId().toString();
+        static_cast<BinaryTileTask&>(*_task).rawTileData = ByteBuffer(std::vector<char>(id.begin(), id.end()));
+        _cb.func(_task);
+        return true;
+    }
+};
+
+// Next source of a reader: completes tasks without data
+struct NoDataSource : public TileSource::DataSource {
+    bool loadTileData(std::shared_ptr<TileTask> _task, TileTaskCb _cb) override {
+        _cb.func(_task);
+        return true;
+    }
+};
+
+static std::string loadMBTile(std::shared_ptr<TileSource> _source, TileID _tileId) {
+    std::mutex mutex;
+    std::condition_variable loaded;
+    bool done = false;
+    std::string result;
+
+    auto task = _source->createTask(_tileId);
+    _source->loadTileData(task, TileTaskCb{[&](std::shared_ptr<TileTask> _task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& data = static_cast<BinaryTileTask&>(*_task).rawTileData;
+        result.assign(data.begin(), data.end());
+        done = true;
+        loaded.notify_one();
+    }});
+
+    std::unique_lock<std::mutex> lock(mutex);
+    loaded.wait(lock, [&]{ return done; });
+    return result;
+}
+
+// Read _tileId with a separate connection until it was written
+static std::string loadWrittenTile(Platform& _platform, TileID _tileId) {
+    auto mbtiles = std::make_unique<MBTilesDataSource>(_platform, "test", cachePath, "");
+    mbtiles->setNext(std::make_unique<NoDataSource>());
+    auto source = std::make_shared<TileSource>("reader", std::move(mbtiles));
+
+    for (int i = 0; i < 500; i++) {
+        auto data = loadMBTile(source, _tileId);
+        if (!data.empty()) { return data; }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return "";
+}
+
+struct MBTilesCache {
+    MBTilesDataSource* cache;
+    TileIdDataSource* next;
+    std::shared_ptr<TileSource> source;
+
+    MBTilesCache(Platform& _platform, uint32_t _flushInterval) {
+        std::remove(cachePath);
+
+        auto mbtiles = std::make_unique<MBTilesDataSource>(_platform, "test", cachePath, "", true);
+        mbtiles->setFlushInterval(_flushInterval);
+        mbtiles->setNext(std::make_unique<TileIdDataSource>());
+
+        cache = mbtiles.get();
+        next = static_cast<TileIdDataSource*>(mbtiles->next.get());
+        source = std::make_shared<TileSource>("cache", std::move(mbtiles));
+    }
+
+    ~MBTilesCache() {
+        source.reset();
+        std::remove(cachePath);
+    }
+};
+
+static const uint32_t oneHour = 60 * 60 * 1000;
+
+TEST_CASE("Read stored MBTiles tiles before they are written", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, oneHour);
+
+    TileID tileId(1, 2, 3);
+
+    CHECK(loadMBTile(cache.source, tileId) == tileId.toString());
+    CHECK(cache.next->loads == 1);
+
+    // The pending tile is read without loading it again
+    CHECK(loadMBTile(cache.source, tileId) == tileId.toString());
+    CHECK(cache.next->loads == 1);
+
+    cache.cache->flush();
+    CHECK(loadWrittenTile(platform, tileId) == tileId.toString());
+
+    // Written tiles are read from the database
+    CHECK(loadMBTile(cache.source, tileId) == tileId.toString());
+    CHECK(cache.next->loads == 1);
+}
+
+TEST_CASE("Write MBTiles tiles after the flush interval", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, 10);
+
+    TileID tileId(0, 0, 1);
+    CHECK(loadMBTile(cache.source, tileId) == tileId.toString());
+
+    CHECK(loadWrittenTile(platform, tileId) == tileId.toString());
+}
+
+TEST_CASE("Write full batches of MBTiles tiles without flush", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, oneHour);
+
+    // MAX_WRITE_BATCH tiles
+    for (int x = 0; x < 256; x++) {
+        loadMBTile(cache.source, TileID(x, 0, 8));
+    }
+    CHECK(cache.next->loads == 256);
+
+    CHECK(loadWrittenTile(platform, TileID(255, 0, 8)) == TileID(255, 0, 8).toString());
+}
+
+TEST_CASE("Read MBTiles tiles from several threads", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, 10);
+
+    for (int x = 0; x < 64; x++) {
+        loadMBTile(cache.source, TileID(x, 1, 6));
+    }
+    cache.cache->flush();
+    REQUIRE(loadWrittenTile(platform, TileID(63, 1, 6)) == TileID(63, 1, 6).toString());
+
+    std::vector<std::thread> workers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&, t]() {
+            for (int x = t; x < 64; x += 8) {
+                if (loadMBTile(cache.source, TileID(x, 1, 6)) != TileID(x, 1, 6).toString()) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) { worker.join(); }
+
+    CHECK(mismatches == 0);
+    CHECK(cache.next->loads == 64);
+}
+
+TEST_CASE("Destroy MBTiles data source while reads are pending", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, 10);
+
+    std::atomic<int> completed{0};
+    std::atomic<int> invalid{0};
+    for (int x = 0; x < 64; x++) {
+        auto task = cache.source->createTask(TileID(x, 2, 6));
+        cache.source->loadTileData(task, TileTaskCb{[&](std::shared_ptr<TileTask> _task) {
+            // Tasks that complete carry the data of their tile
+            if (!_task) {
+                invalid++;
+            } else {
+                auto& data = static_cast<BinaryTileTask&>(*_task).rawTileData;
+                if (std::string(data.begin(), data.end()) != _task->tileId().toString()) { invalid++; }
+            }
+            completed++;
+        }});
+    }
+    // Reads that did not start yet are dropped
+    cache.source.reset();
+
+    // No callback runs once the source is gone
+    int completedAtReset = completed;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    CHECK(completed == completedAtReset);
+    CHECK(invalid == 0);
+}
+
+TEST_CASE("Find the tiles of a region", TAGS) {
+
+    // The whole world
+    auto world = MBTilesDataSource::tilesInRegion({ { {-180, -85}, {180, -85}, {180, 85}, {-180, 85} } }, 0, 2);
+    CHECK(world.size() == 1 + 4 + 16);
+
+    // Around the center of the map
+    auto center = MBTilesDataSource::tilesInRegion({ { {-10, -10}, {10, -10}, {10, 10}, {-10, 10} } }, 1, 3);
+    CHECK(center == std::vector<TileID>{
+            TileID(0, 0, 1), TileID(0, 1, 1), TileID(1, 0, 1), TileID(1, 1, 1),
+            TileID(1, 1, 2), TileID(1, 2, 2), TileID(2, 1, 2), TileID(2, 2, 2),
+            TileID(3, 3, 3), TileID(3, 4, 3), TileID(4, 3, 3), TileID(4, 4, 3) });
+
+    // Within one tile on each zoom level
+    auto small = MBTilesDataSource::tilesInRegion({ { {10.001, 50.001}, {10.002, 50.001},
+                                                      {10.002, 50.002}, {10.001, 50.002} } }, 5, 8);
+    CHECK(small == std::vector<TileID>{
+            TileID(16, 10, 5), TileID(33, 21, 6), TileID(67, 43, 7), TileID(135, 86, 8) });
+}
+
+TEST_CASE("Report the progress of seeding a region", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, 10);
+
+    std::vector<std::vector<LngLat>> region{ { {-10, -10}, {10, -10}, {10, 10}, {-10, 10} } };
+
+    std::mutex mutex;
+    std::condition_variable updated;
+    std::vector<MBTilesDataSource::SeedProgress> reports;
+
+    auto seed = [&]() {
+        reports.clear();
+        REQUIRE(cache.cache->seedRegion(cache.source, region, 1, 2, [&](const MBTilesDataSource::SeedProgress& _progress) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    reports.push_back(_progress);
+                    updated.notify_one();
+                }));
+
+        std::unique_lock<std::mutex> lock(mutex);
+        updated.wait(lock, [&]{ return !reports.empty() && reports.back().done(); });
+        return reports.back();
+    };
+
+    auto progress = seed();
+    CHECK(progress.total == 8);
+    CHECK(progress.stored == 8);
+    CHECK(progress.failed == 0);
+    CHECK(reports.size() == 8);
+    CHECK(cache.next->loads == 8);
+
+    // Stored tiles are skipped when the region is seeded again
+    cache.cache->flush();
+    REQUIRE(loadWrittenTile(platform, TileID(2, 2, 2)) == TileID(2, 2, 2).toString());
+
+    region[0][1].longitude = 100;
+    region[0][2].longitude = 100;
+
+    // Only the two new tiles on zoom 2 are loaded
+    progress = seed();
+    CHECK(progress.total == 2);
+    CHECK(progress.stored == 2);
+    CHECK(cache.next->loads == 10);
+}
+
+TEST_CASE("Destroy MBTiles data source while seeding", TAGS) {
+    MockPlatform platform;
+    MBTilesCache cache(platform, 10);
+
+    std::atomic<size_t> reports{0};
+    REQUIRE(cache.cache->seedRegion(cache.source, { { {-180, -85}, {180, -85}, {180, 85}, {-180, 85} } }, 0, 6,
+                                    [&](const MBTilesDataSource::SeedProgress&) { reports++; }));
+
+    // Seeding stops with the data source
+    cache.source.reset();
+    size_t stopped = reports;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(reports == stopped);
+}
@@ -1,7 +1,11 @@
 #include "catch.hpp"
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 #include "gl/mesh.h"
+#include "gl/renderState.h"
+#include "gl_mock.h"
 
 using namespace Tangram;
 
@@ -27,6 +31,8 @@ struct TestMesh : public Mesh<Vertex> {
 
     int numVertices() const { return m_nVertices; }
     int numIndices() const { return m_nIndices; }
+
+    bool isUploaded() const { return m_isUploaded; }
 };
 
 std::shared_ptr<TestMesh> newMesh(unsigned int size) {
@@ -170,3 +176,104 @@ TEST_CASE( "Check overflow", "[Core][TypedMesh]" ) {
 
     checkBounds(mesh);
 }
+
+std::shared_ptr<TestMesh> newIndexedMesh(unsigned int size) {
+    auto mesh = std::make_shared<TestMesh>(layout, GL_TRIANGLES);
+    std::vector<uint16_t> indices(size * 3, 0);
+    std::vector<Vertex> vertices(size, {0,0,0,0});
+
+    mesh->compile(MeshData<Vertex>(std::move(indices), std::move(vertices)));
+    return mesh;
+}
+
+TEST_CASE( "Upload mesh within the frame budget", "[Core][TypedMesh]" ) {
+    RenderState rs;
+    rs.setUploadBudget(64, 64, 1.f);
+
+    auto mesh = newIndexedMesh(100);
+    size_t size = mesh->bufferSize();
+
+    GLMock::resetCalls();
+
+    int frames = 0;
+    while (!mesh->isUploaded()) {
+        rs.beginFrame();
+        mesh->upload(rs);
+        REQUIRE(rs.endFrame());
+        frames++;
+    }
+
+    // Vertices and indices are uploaded in chunks of the budget
+    REQUIRE(frames == int((size + 63) / 64));
+    REQUIRE(GLMock::calls.bufferBytes == size);
+
+    // Nothing left to upload
+    rs.beginFrame();
+    REQUIRE(mesh->upload(rs));
+    REQUIRE_FALSE(rs.endFrame());
+}
+
+TEST_CASE( "Upload mesh at once outside of frames", "[Core][TypedMesh]" ) {
+    RenderState rs;
+    rs.setUploadBudget(64, 64, 1.f);
+
+    auto mesh = newIndexedMesh(100);
+
+    GLMock::resetCalls();
+
+    REQUIRE(mesh->upload(rs));
+    REQUIRE(mesh->isUploaded());
+
+    // One bufferData each for vertices and indices
+    REQUIRE(GLMock::calls.buffer == 2);
+    REQUIRE(GLMock::calls.bufferBytes == mesh->bufferSize());
+}
+
+TEST_CASE( "Adapt upload budget to upload duration", "[Core][TypedMesh]" ) {
+    using namespace std::chrono;
+
+    RenderState rs;
+    rs.setUploadBudget(1024, 4096, 0.004f);
+    size_t budget = rs.uploadBudget();
+
+    // Uploads slower than the target
+    rs.beginFrame();
+    REQUIRE(rs.reserveUpload(100) == 100);
+    rs.addUploadDuration(milliseconds(10));
+    rs.endFrame();
+    REQUIRE(rs.uploadBudget() == std::max<size_t>(budget / 2, 1024));
+
+    for (int i = 0; i < 10; i++) {
+        rs.beginFrame();
+        rs.reserveUpload(100);
+        rs.addUploadDuration(milliseconds(10));
+        rs.endFrame();
+    }
+    REQUIRE(rs.uploadBudget() == 1024);
+
+    // Uploads faster than the target grow the budget when uploads were
+    // deferred, however long the frame takes
+    rs.beginFrame();
+    std::this_thread::sleep_for(milliseconds(20));
+    REQUIRE(rs.reserveUpload(2048) == 1024);
+    REQUIRE(rs.reserveUpload(100) == 0);
+    rs.addUploadDuration(milliseconds(1));
+    REQUIRE(rs.endFrame());
+    REQUIRE(rs.uploadBudget() == 1280);
+
+    for (int i = 0; i < 10; i++) {
+        rs.beginFrame();
+        rs.reserveUpload(8192);
+        rs.addUploadDuration(milliseconds(1));
+        rs.endFrame();
+    }
+    REQUIRE(rs.uploadBudget() == 4096);
+
+    // The target is configurable
+    rs.setUploadTargetDuration(0.0005f);
+    rs.beginFrame();
+    rs.reserveUpload(100);
+    rs.addUploadDuration(milliseconds(1));
+    rs.endFrame();
+    REQUIRE(rs.uploadBudget() == 2048);
+}
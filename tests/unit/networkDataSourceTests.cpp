@@ -1,6 +1,10 @@
 #include "catch.hpp"
 
 #include "data/networkDataSource.h"
+#include "platform.h"
+
+#include <functional>
+#include <map>
 
 using namespace Tangram;
 
@@ -56,3 +60,133 @@ TEST_CASE("Build URL for tile from template", TAGS) {
         CHECK(NetworkDataSource::buildUrlForTile(TileID(3, 5, 3), url, urlOptions, 0) == "file://tiles/213.blah");
     }
 }
+
+// Platform that keeps requests open until they are completed by the test
+class TilePlatform : public Platform {
+public:
+    void requestRender() const override {}
+
+    bool startUrlRequestImpl(const Url& _url, const UrlRequestHandle _request, UrlRequestId& _id) override {
+        _id = ++m_transferCount;
+        m_transfers[_id] = _request;
+        if (m_onStart) { m_onStart(); }
+        return true;
+    }
+
+    void cancelUrlRequestImpl(const UrlRequestId _id) override {
+        m_canceled.push_back(_id);
+    }
+
+    void complete(int _status, bool _timedOut = false) {
+        auto it = m_transfers.begin();
+        auto request = it->second;
+        m_transfers.erase(it);
+
+        UrlResponse response;
+        response.status = _status;
+        response.timedOut = _timedOut;
+        if (_status == 200) {
+            response.content = { 't', 'i', 'l', 'e' };
+        } else {
+            response.error = "error";
+        }
+        onUrlResponse(request, std::move(response));
+    }
+
+    size_t m_transferCount = 0;
+    std::map<UrlRequestId, UrlRequestHandle> m_transfers;
+    std::vector<UrlRequestId> m_canceled;
+    // Runs while a transfer is starting
+    std::function<void()> m_onStart;
+};
+
+TEST_CASE("Adapt concurrent requests to server load", TAGS) {
+    TilePlatform platform;
+
+    auto network = std::make_unique<NetworkDataSource>(platform, "https://tiles.test/{z}/{x}/{y}.mvt",
+                                                       NetworkDataSource::UrlOptions{});
+    auto& dataSource = *network;
+    dataSource.setConcurrencyLimits(2, 4);
+
+    auto source = std::make_shared<TileSource>("test", std::move(network));
+
+    for (int x = 0; x < 6; x++) {
+        source->loadTileData(source->createTask(TileID(x, 0, 3)), TileTaskCb{[](std::shared_ptr<TileTask>) {}});
+    }
+
+    auto stats = dataSource.getStats();
+    CHECK(stats.limit == 4);
+    CHECK(stats.active == 4);
+    CHECK(stats.pending == 2);
+    CHECK(platform.m_transfers.size() == 4);
+
+    // Overloaded server halves the limit
+    platform.complete(503);
+    stats = dataSource.getStats();
+    CHECK(stats.throttled == 1);
+    CHECK(stats.limit == 2);
+    CHECK(stats.active == 3);
+
+    // Requests in flight before the decrease do not decrease it again
+    platform.complete(429);
+    CHECK(dataSource.getStats().limit == 2);
+
+    // Pending requests start when there is room
+    platform.complete(200);
+    platform.complete(404);
+    stats = dataSource.getStats();
+    CHECK(stats.completed == 1);
+    CHECK(stats.failed == 1);
+    CHECK(stats.active == 2);
+    CHECK(stats.pending == 0);
+}
+
+TEST_CASE("Reduce concurrent requests only for timeouts among errors without status", TAGS) {
+    TilePlatform platform;
+
+    auto network = std::make_unique<NetworkDataSource>(platform, "https://tiles.test/{z}/{x}/{y}.mvt",
+                                                       NetworkDataSource::UrlOptions{});
+    auto& dataSource = *network;
+    dataSource.setConcurrencyLimits(2, 4);
+
+    auto source = std::make_shared<TileSource>("test", std::move(network));
+
+    for (int x = 0; x < 4; x++) {
+        source->loadTileData(source->createTask(TileID(x, 0, 3)), TileTaskCb{[](std::shared_ptr<TileTask>) {}});
+    }
+
+    // E.g. the host could not be resolved
+    platform.complete(0);
+    auto stats = dataSource.getStats();
+    CHECK(stats.failed == 1);
+    CHECK(stats.throttled == 0);
+    CHECK(stats.limit == 4);
+
+    platform.complete(0, true);
+    stats = dataSource.getStats();
+    CHECK(stats.failed == 1);
+    CHECK(stats.throttled == 1);
+    CHECK(stats.limit == 2);
+}
+
+TEST_CASE("Cancel a tile while its request is starting", TAGS) {
+    TilePlatform platform;
+
+    auto network = std::make_unique<NetworkDataSource>(platform, "https://tiles.test/{z}/{x}/{y}.mvt",
+                                                       NetworkDataSource::UrlOptions{});
+    auto source = std::make_shared<TileSource>("test", std::move(network));
+
+    auto task = source->createTask(TileID(0, 0, 3));
+    platform.m_onStart = [&]() { source->cancelLoadingTile(*task); };
+
+    bool loaded = false;
+    source->loadTileData(task, TileTaskCb{[&](std::shared_ptr<TileTask>) { loaded = true; }});
+
+    // The transfer is aborted once its handle is known
+    REQUIRE(platform.m_canceled.size() == 1);
+    CHECK(platform.m_canceled[0] == 1);
+
+    task->cancel();
+    platform.complete(0);
+    CHECK_FALSE(loaded);
+}
@@ -0,0 +1,131 @@
+#include "catch.hpp"
+
+#include "data/pmtilesDataSource.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+using namespace Tangram;
+
+#define TAGS "[PMTilesDataSource]"
+
+struct ArchiveEntry {
+    uint64_t tileId;
+    uint64_t runLength;
+    uint64_t length;
+    uint64_t offset;
+};
+
+static void writeVarint(std::string& _out, uint64_t _value) {
+    while (_value >= 0x80) {
+        _out.push_back(char((_value & 0x7f) | 0x80));
+        _value >>= 7;
+    }
+    _out.push_back(char(_value));
+}
+
+static void writeUint64(std::string& _out, size_t _pos, uint64_t _value) {
+    for (int i = 0; i < 8; i++) {
+        _out[_pos + i] = char((_value >> (8 * i)) & 0xff);
+    }
+}
+
+static std::string directory(const std::vector<ArchiveEntry>& _entries) {
+    std::string out;
+    writeVarint(out, _entries.size());
+    uint64_t last = 0;
+    for (auto& e : _entries) { writeVarint(out, e.tileId - last); last = e.tileId; }
+    for (auto& e : _entries) { writeVarint(out, e.runLength); }
+    for (auto& e : _entries) { writeVarint(out, e.length); }
+    for (auto& e : _entries) { writeVarint(out, e.offset + 1); }
+    return out;
+}
+
+// Uncompressed archive with tiles up to zoom 2, the last in a leaf directory
+static std::string archive() {
+    std::string tileData = "world" "quad" "leaf";
+
+    std::string leaf = directory({ {5, 1, 4, 9} });
+    std::string root = directory({ {0, 1, 5, 0}, {1, 4, 4, 5}, {5, 0, leaf.size(), 0} });
+
+    std::string header(127, '\0');
+    header.replace(0, 7, "PMTiles");
+    header[7] = 3;
+
+    uint64_t rootOffset = header.size();
+    uint64_t leafOffset = rootOffset + root.size();
+    uint64_t dataOffset = leafOffset + leaf.size();
+
+    writeUint64(header, 8, rootOffset);
+    writeUint64(header, 16, root.size());
+    writeUint64(header, 40, leafOffset);
+    writeUint64(header, 48, leaf.size());
+    writeUint64(header, 56, dataOffset);
+    writeUint64(header, 64, tileData.size());
+    header[97] = 1; // no directory compression
+    header[98] = 1; // no tile compression
+    header[100] = 0;
+    header[101] = 2;
+
+    return header + root + leaf + tileData;
+}
+
+static std::string loadTile(std::shared_ptr<TileSource> _source, TileID _tileId) {
+    std::mutex mutex;
+    std::condition_variable loaded;
+    bool done = false;
+    std::string result;
+
+    auto task = _source->createTask(_tileId);
+    _source->loadTileData(task, TileTaskCb{[&](std::shared_ptr<TileTask> _task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& data = static_cast<BinaryTileTask&>(*_task).rawTileData;
+        result.assign(data.begin(), data.end());
+        done = true;
+        loaded.notify_one();
+    }});
+
+    std::unique_lock<std::mutex> lock(mutex);
+    loaded.wait(lock, [&]{ return done; });
+    return result;
+}
+
+TEST_CASE("Compute PMTiles tile ids", TAGS) {
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(0, 0, 0)) == 0);
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(0, 0, 1)) == 1);
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(0, 1, 1)) == 2);
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(1, 1, 1)) == 3);
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(1, 0, 1)) == 4);
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(0, 0, 2)) == 5);
+    CHECK(PMTilesDataSource::hilbertTileId(TileID(3, 0, 2)) == 20);
+}
+
+TEST_CASE("Read tiles from PMTiles archive", TAGS) {
+    const char* path = "test.pmtiles";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << archive();
+    }
+
+    auto pmtiles = std::make_unique<PMTilesDataSource>("test", path);
+    REQUIRE(pmtiles->isOpen());
+
+    auto source = std::make_shared<TileSource>("test", std::move(pmtiles));
+
+    CHECK(loadTile(source, TileID(0, 0, 0)) == "world");
+
+    // Tiles of one run share their data
+    CHECK(loadTile(source, TileID(0, 0, 1)) == "quad");
+    CHECK(loadTile(source, TileID(1, 0, 1)) == "quad");
+
+    CHECK(loadTile(source, TileID(0, 0, 2)) == "leaf");
+
+    // Missing tiles are completed without data
+    CHECK(loadTile(source, TileID(1, 0, 2)).empty());
+    CHECK(loadTile(source, TileID(0, 0, 3)).empty());
+
+    source.reset();
+    std::remove(path);
+}
@@ -0,0 +1,191 @@
+#include "catch.hpp"
+
+#include "data/rasterSource.h"
+#include "gl/hardware.h"
+
+#include <array>
+
+using namespace Tangram;
+
+#define TAGS "[RasterSource]"
+
+using Color = std::array<GLubyte, 4>;
+
+static const Color red = {{ 255, 0, 0, 255 }};
+static const Color green = {{ 0, 255, 0, 255 }};
+static const Color blue = {{ 0, 0, 255, 255 }};
+static const Color white = {{ 255, 255, 255, 255 }};
+
+// Uncompressed TGA image of _size x _size pixels, _pixel(x, y) gives the
+// color of a pixel with y from the top of the image
+template<typename F>
+static ByteBuffer tgaImage(int _size, F _pixel) {
+    std::vector<char> data(18, 0);
+    data[2] = 2;
+    data[12] = char(_size & 0xff);
+    data[13] = char(_size >> 8);
+    data[14] = char(_size & 0xff);
+    data[15] = char(_size >> 8);
+    data[16] = 32;
+    // 8 alpha bits, rows from the top
+    data[17] = 0x28;
+
+    for (int y = 0; y < _size; y++) {
+        for (int x = 0; x < _size; x++) {
+            Color c = _pixel(x, y);
+            data.insert(data.end(), { char(c[2]), char(c[1]), char(c[0]), char(c[3]) });
+        }
+    }
+    return ByteBuffer(std::move(data));
+}
+
+static ByteBuffer solidImage(int _size, Color _color) {
+    return tgaImage(_size, [&](int, int) { return _color; });
+}
+
+struct TestRasterSource : public RasterSource {
+    TestRasterSource() : RasterSource("raster", nullptr, TextureOptions()) {}
+
+    using RasterSource::cacheTexture;
+    using RasterSource::createTexture;
+    using RasterSource::deriveTexture;
+    using RasterSource::findDerivationTiles;
+};
+
+// Color of the pixel at x and y from the top of _texture
+static Color pixelAt(const Texture& _texture, int _x, int _y) {
+    // Rows are stored from the bottom
+    int row = _texture.height() - 1 - _y;
+    const GLubyte* pixel = _texture.bufferData() + (size_t(row) * _texture.width() + _x) * 4;
+    return {{ pixel[0], pixel[1], pixel[2], pixel[3] }};
+}
+
+TEST_CASE("Derive raster texture from child tiles", TAGS) {
+    Hardware::maxTextureSize = 1024;
+    TestRasterSource source;
+
+    // The top-left child is red above and white below
+    auto topLeft = tgaImage(4, [](int, int y) { return y < 2 ? red : white; });
+
+    auto texture = source.deriveTexture(TileID(1, 1, 2), {
+            { TileID(2, 2, 3), topLeft },
+            { TileID(3, 2, 3), solidImage(4, green) },
+            { TileID(2, 3, 3), solidImage(4, blue) },
+            { TileID(3, 3, 3), solidImage(4, white) } });
+
+    REQUIRE(texture);
+    REQUIRE(texture->width() == 4);
+    REQUIRE(texture->height() == 4);
+
+    CHECK(pixelAt(*texture, 0, 0) == red);
+    CHECK(pixelAt(*texture, 1, 1) == white);
+    CHECK(pixelAt(*texture, 2, 0) == green);
+    CHECK(pixelAt(*texture, 3, 1) == green);
+    CHECK(pixelAt(*texture, 0, 2) == blue);
+    CHECK(pixelAt(*texture, 1, 3) == blue);
+    CHECK(pixelAt(*texture, 2, 2) == white);
+    CHECK(pixelAt(*texture, 3, 3) == white);
+}
+
+TEST_CASE("Derive raster texture from the region of a parent tile", TAGS) {
+    Hardware::maxTextureSize = 1024;
+    TestRasterSource source;
+
+    // Quadrants of the parent: red green above, blue white below
+    auto parent = tgaImage(8, [](int x, int y) {
+        return y < 4 ? (x < 4 ? red : green) : (x < 4 ? blue : white);
+    });
+
+    SECTION("One level up") {
+        auto texture = source.deriveTexture(TileID(1, 0, 1), { { TileID(0, 0, 0), parent } });
+        REQUIRE(texture);
+        CHECK(pixelAt(*texture, 4, 4) == green);
+
+        texture = source.deriveTexture(TileID(0, 1, 1), { { TileID(0, 0, 0), parent } });
+        REQUIRE(texture);
+        CHECK(pixelAt(*texture, 4, 4) == blue);
+    }
+
+    SECTION("Two levels up") {
+        auto texture = source.deriveTexture(TileID(3, 0, 2), { { TileID(0, 0, 0), parent } });
+        REQUIRE(texture);
+        CHECK(pixelAt(*texture, 4, 4) == green);
+
+        texture = source.deriveTexture(TileID(1, 3, 2), { { TileID(0, 0, 0), parent } });
+        REQUIRE(texture);
+        CHECK(pixelAt(*texture, 4, 4) == blue);
+    }
+
+    SECTION("Three levels up") {
+        auto texture = source.deriveTexture(TileID(5, 1, 3), { { TileID(0, 0, 0), parent } });
+        REQUIRE(texture);
+        CHECK(pixelAt(*texture, 4, 4) == green);
+
+        texture = source.deriveTexture(TileID(7, 7, 3), { { TileID(0, 0, 0), parent } });
+        REQUIRE(texture);
+        CHECK(pixelAt(*texture, 4, 4) == white);
+    }
+}
+
+TEST_CASE("Load raster tiles that have a derived texture", TAGS) {
+    Hardware::maxTextureSize = 1024;
+    auto source = std::make_shared<TestRasterSource>();
+
+    TileID tileId(0, 0, 1);
+    auto image = solidImage(4, red);
+
+    auto derived = source->cacheTexture(tileId, source->deriveTexture(tileId, { { TileID(0, 0, 0), image } }));
+    REQUIRE(derived);
+
+    // The tile is still loaded
+    auto task = source->createTask(tileId);
+    CHECK(task->needsLoading());
+
+    // And its texture replaces the derived one
+    auto loaded = source->cacheTexture(tileId, source->createTexture(tileId, image), image);
+    CHECK(loaded != derived);
+
+    derived.reset();
+
+    task = source->createTask(tileId);
+    CHECK_FALSE(task->needsLoading());
+}
+
+TEST_CASE("Show a derived raster texture until the tile is loaded", TAGS) {
+    Hardware::maxTextureSize = 1024;
+    auto source = std::make_shared<TestRasterSource>();
+
+    TileID parentId(0, 0, 0);
+    TileID tileId(0, 0, 1);
+    auto image = solidImage(4, red);
+
+    auto parent = source->cacheTexture(parentId, source->createTexture(parentId, image), image);
+    REQUIRE(parent);
+
+    // The task of a missing tile derives its texture without loading
+    auto task = source->createTask(tileId);
+    CHECK_FALSE(task->needsLoading());
+    CHECK(task->hasData());
+
+    auto standIn = source->cacheTexture(tileId, source->deriveTexture(tileId, source->findDerivationTiles(tileId)),
+                                        {}, true);
+    REQUIRE(standIn);
+
+    // The tile is outdated and loaded next
+    CHECK(source->generation(tileId) > source->generation());
+    task = source->createTask(tileId);
+    CHECK(task->needsLoading());
+
+    SECTION("Loaded") {
+        auto loaded = source->cacheTexture(tileId, source->createTexture(tileId, image), image);
+        CHECK(loaded != standIn);
+        CHECK(source->generation(tileId) == source->generation());
+    }
+
+    SECTION("Failed to load") {
+        // The texture derived after the failure is dropped for the stand-in
+        auto derived = source->cacheTexture(tileId, source->deriveTexture(tileId, source->findDerivationTiles(tileId)));
+        CHECK(derived == standIn);
+        CHECK(source->generation(tileId) == source->generation());
+    }
+}
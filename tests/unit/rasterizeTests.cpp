@@ -0,0 +1,42 @@
+#include "catch.hpp"
+#include "util/rasterize.h"
+
+#include <set>
+#include <utility>
+
+using namespace Tangram;
+
+using Cells = std::set<std::pair<int, int>>;
+
+static Cells scanCells(const std::vector<std::vector<glm::dvec2>>& _polygon, int _min, int _max) {
+    Cells cells;
+    Rasterize::scanPolygon(_polygon, _min, _max, [&](int x, int y) { cells.emplace(x, y); });
+    return cells;
+}
+
+TEST_CASE("Scan the cells covered by a polygon", "[Rasterize]") {
+
+    // Square on cell boundaries
+    CHECK(scanCells({ { {1, 1}, {3, 1}, {3, 3}, {1, 3}, {1, 1} } }, 0, 10) ==
+          Cells{ {1, 1}, {2, 1}, {1, 2}, {2, 2} });
+
+    // Square within cells covers all cells it touches
+    CHECK(scanCells({ { {1.5, 1.5}, {3.5, 1.5}, {3.5, 3.5}, {1.5, 3.5} } }, 0, 10).size() == 9);
+
+    // Triangle: cells below the diagonal
+    auto triangle = scanCells({ { {0.5, 0.5}, {4.5, 0.5}, {0.5, 4.5} } }, 0, 10);
+    CHECK(triangle.size() == 15);
+    for (auto& cell : triangle) {
+        CHECK(cell.first + cell.second <= 4);
+    }
+
+    // Rows are limited to [_min, _max)
+    auto clipped = scanCells({ { {0, 0}, {4, 0}, {4, 4}, {0, 4} } }, 1, 3);
+    CHECK(clipped.size() == 8);
+    for (auto& cell : clipped) {
+        CHECK(cell.second >= 1);
+        CHECK(cell.second < 3);
+    }
+
+    CHECK(scanCells({}, 0, 10).empty());
+}
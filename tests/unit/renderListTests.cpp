@@ -0,0 +1,196 @@
+#include "catch.hpp"
+
+#include "gl_mock.h"
+
+#include "gl/hardware.h"
+#include "gl/renderState.h"
+#include "gl/shaderProgram.h"
+#include "gl/texture.h"
+#include "marker/marker.h"
+#include "scene/renderList.h"
+#include "style/style.h"
+#include "tile/tile.h"
+#include "view/view.h"
+
+using namespace Tangram;
+
+struct DrawMesh : public StyledMesh {
+    bool draw(RenderState& rs, ShaderProgram& _shader, bool _useVao) override {
+        if (!_shader.use(rs)) { return false; }
+        GL::drawArrays(GL_TRIANGLES, 0, 3);
+        return true;
+    }
+    size_t bufferSize() const override { return 0; }
+};
+
+struct DrawStyle : public Style {
+    DrawStyle(std::string _name, uint32_t _id, Blending _blend,
+              std::shared_ptr<ShaderProgram> _program)
+        : Style(_name, _blend, GL_TRIANGLES, false) {
+        setID(_id);
+        m_shaderProgram = _program;
+    }
+    void constructVertexLayout() override {}
+    void constructShaderProgram() override {}
+    std::unique_ptr<StyleBuilder> createBuilder() const override { return nullptr; }
+};
+
+static std::shared_ptr<ShaderProgram> testProgram(const std::string& _name) {
+    auto program = std::make_shared<ShaderProgram>();
+    program->setShaderSource("vertex " + _name, "fragment " + _name);
+    return program;
+}
+
+static std::shared_ptr<Texture> testTexture() {
+    auto texture = std::make_shared<Texture>(TextureOptions());
+    GLubyte pixel[4] = { 255, 255, 255, 255 };
+    texture->setPixelData(1, 1, 4, pixel, 4);
+    return texture;
+}
+
+// Tiles of all test styles, proxies and raster textures interleaved as they
+// come out of the TileManager
+struct DrawFrame {
+    RenderState rs;
+    View view;
+
+    std::vector<std::unique_ptr<DrawStyle>> styles;
+    std::vector<std::shared_ptr<Tile>> tiles;
+    std::vector<std::unique_ptr<Marker>> markers;
+
+    DrawFrame() {
+        // Not queried from the mocked driver
+        Hardware::maxTextureSize = 1024;
+
+        auto shared = testProgram("shared");
+
+        styles.emplace_back(new DrawStyle("raster-a", 0, Blending::opaque, shared));
+        styles.emplace_back(new DrawStyle("polygons", 1, Blending::opaque, testProgram("polygons")));
+        styles.emplace_back(new DrawStyle("raster-b", 2, Blending::opaque, shared));
+        styles.emplace_back(new DrawStyle("overlay", 3, Blending::overlay, testProgram("overlay")));
+
+        styles[0]->setRasterType(RasterType::color);
+        styles[2]->setRasterType(RasterType::color);
+
+        std::shared_ptr<Texture> textures[2] = { testTexture(), testTexture() };
+
+        for (int i = 0; i < 16; i++) {
+            auto tile = std::make_shared<Tile>(TileID(i, 0, 4));
+            tile->setProxyState(i % 2 == 1);
+            tile->rasters().emplace_back(TileID(i / 2, 0, 3), textures[(i / 2) % 2]);
+
+            for (auto& style : styles) {
+                tile->setMesh(*style, std::make_unique<DrawMesh>());
+            }
+            tile->upload(rs);
+            tiles.push_back(tile);
+        }
+    }
+
+    void record(RenderList& _list) {
+        _list.clear();
+        for (auto& style : styles) {
+            _list.record(*style, tiles, markers);
+        }
+    }
+
+    GLMock::Calls draw(bool _sorted) {
+        RenderList list;
+        record(list);
+        if (_sorted) { list.sort(); }
+
+        // Build the shader programs outside of the counted frame
+        for (auto& style : styles) {
+            const_cast<ShaderProgram*>(style->shaderProgram())->use(rs);
+        }
+        rs.invalidate();
+
+        GLMock::resetCalls();
+        list.submit(rs, view);
+        return GLMock::calls;
+    }
+};
+
+TEST_CASE("RenderList keeps the order of styles", "[RenderList]") {
+    DrawFrame frame;
+
+    RenderList list;
+    frame.record(list);
+    auto recorded = list.commands();
+    list.sort();
+
+    REQUIRE(list.batches().size() == 4);
+    REQUIRE(list.commands().size() == recorded.size());
+
+    // Opaque styles sharing a program are not moved across other styles,
+    // which would change the style winning the depth test of coplanar meshes
+    REQUIRE(list.batches()[0].style->getName() == "raster-a");
+    REQUIRE(list.batches()[1].style->getName() == "polygons");
+    REQUIRE(list.batches()[2].style->getName() == "raster-b");
+
+    // The overlay style is drawn last, its tiles in recorded order
+    auto& overlay = list.batches()[3];
+    REQUIRE(overlay.style->getName() == "overlay");
+    for (size_t i = overlay.begin; i < overlay.end; i++) {
+        REQUIRE(list.commands()[i].tile == recorded[i].tile);
+    }
+
+    // Opaque tiles are drawn before proxy tiles and grouped by raster textures
+    for (size_t b = 0; b < 3; b++) {
+        auto& batch = list.batches()[b];
+        for (size_t i = batch.begin + 1; i < batch.end; i++) {
+            auto& prev = list.commands()[i - 1];
+            auto& cur = list.commands()[i];
+            REQUIRE(prev.key <= cur.key);
+            REQUIRE((!prev.tile->isProxy() || cur.tile->isProxy()));
+        }
+    }
+}
+
+TEST_CASE("RenderList keys tiles by their raster texture set", "[RenderList]") {
+    Hardware::maxTextureSize = 1024;
+
+    DrawStyle raster("raster", 0, Blending::opaque, testProgram("raster"));
+    raster.setRasterType(RasterType::color);
+    DrawStyle plain("plain", 1, Blending::opaque, testProgram("plain"));
+
+    auto a = testTexture(), b = testTexture();
+
+    Tile ab(TileID(0, 0, 1)), aa(TileID(1, 0, 1)), ab2(TileID(0, 1, 1)), proxy(TileID(1, 1, 1));
+    for (auto* tile : { &ab, &aa, &ab2, &proxy }) { tile->rasters().emplace_back(TileID(0, 0, 0), a); }
+    ab.rasters().emplace_back(TileID(0, 0, 0), b);
+    aa.rasters().emplace_back(TileID(0, 0, 0), a);
+    ab2.rasters().emplace_back(TileID(0, 0, 0), b);
+    proxy.rasters().emplace_back(TileID(0, 0, 0), b);
+    proxy.setProxyState(true);
+
+    // All textures of a tile count, not only the first
+    CHECK(RenderList::key(raster, ab) == RenderList::key(raster, ab2));
+    CHECK(RenderList::key(raster, ab) != RenderList::key(raster, aa));
+    CHECK(RenderList::key(raster, proxy) > RenderList::key(raster, ab));
+    CHECK(RenderList::key(raster, proxy) > RenderList::key(raster, aa));
+
+    // Textures are not bound for styles without rasters
+    CHECK(RenderList::key(plain, ab) == RenderList::key(plain, aa));
+}
+
+TEST_CASE("RenderList sorting reduces GL calls", "[RenderList]") {
+    GLMock::Calls unsorted = DrawFrame().draw(false);
+    GLMock::Calls sorted = DrawFrame().draw(true);
+
+    INFO("GL calls unsorted: " << unsorted.total() << " (program " << unsorted.program
+         << ", texture " << unsorted.texture << ", uniform " << unsorted.uniform
+         << ", state " << unsorted.state << ")");
+    INFO("GL calls sorted: " << sorted.total() << " (program " << sorted.program
+         << ", texture " << sorted.texture << ", uniform " << sorted.uniform
+         << ", state " << sorted.state << ")");
+
+    // Same draws
+    REQUIRE(sorted.draw == unsorted.draw);
+    REQUIRE(sorted.draw == 4 * 16);
+
+    REQUIRE(sorted.program <= unsorted.program);
+    REQUIRE(sorted.texture < unsorted.texture);
+    REQUIRE(sorted.uniform < unsorted.uniform);
+    REQUIRE(sorted.total() < unsorted.total());
+}
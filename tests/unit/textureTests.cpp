@@ -2,6 +2,8 @@
 
 #include "gl/texture.h"
 #include "gl/glyphTexture.h"
+#include "gl/renderState.h"
+#include "gl/texturePool.h"
 
 using namespace Tangram;
 
@@ -113,3 +115,107 @@ TEST_CASE("Merging of dirty Regions - Merge three regions, when 3rd region is ad
     }
 
 }
+
+TEST_CASE("Pixel buffers of the same size are reused", "[Texture]") {
+    // Drop blocks released by other tests
+    PixelBuffer::setCapacity(0);
+    PixelBuffer::setCapacity(1024 * 1024);
+
+    size_t size = 256 * 256 * 4;
+    void* a = PixelBuffer::allocate(size);
+    REQUIRE(a != nullptr);
+
+    PixelBuffer::release(a);
+    REQUIRE(PixelBuffer::pooledSize() == size);
+
+    // Other sizes get a new block
+    void* b = PixelBuffer::allocate(size / 2);
+    REQUIRE(b != a);
+    REQUIRE(PixelBuffer::pooledSize() == size);
+
+    void* c = PixelBuffer::allocate(size);
+    REQUIRE(c == a);
+    REQUIRE(PixelBuffer::pooledSize() == 0);
+
+    // Blocks beyond the capacity are freed
+    PixelBuffer::setCapacity(size);
+    PixelBuffer::release(b);
+    PixelBuffer::release(c);
+    REQUIRE(PixelBuffer::pooledSize() == size / 2);
+
+    PixelBuffer::setCapacity(0);
+    REQUIRE(PixelBuffer::pooledSize() == 0);
+}
+
+TEST_CASE("Scratch memory of the image decoder is not kept", "[Texture]") {
+    PixelBuffer::setCapacity(0);
+    PixelBuffer::setCapacity(1024 * 1024);
+
+    size_t size = 256 * 256 * 4;
+    {
+        PixelBuffer::DecodeScope scope(size);
+
+        void* scratch = PixelBuffer::decoderAllocate(size / 2);
+        scratch = PixelBuffer::decoderReallocate(scratch, size * 2);
+        REQUIRE(scratch != nullptr);
+
+        void* image = PixelBuffer::decoderAllocate(size);
+        REQUIRE(image != nullptr);
+
+        PixelBuffer::release(scratch);
+        REQUIRE(PixelBuffer::pooledSize() == 0);
+
+        // The decoded image is kept for the next image
+        PixelBuffer::release(image);
+        REQUIRE(PixelBuffer::pooledSize() == size);
+        REQUIRE(PixelBuffer::decoderAllocate(size) == image);
+
+        PixelBuffer::release(image);
+    }
+
+    // Outside of decoding all blocks are scratch memory
+    void* block = PixelBuffer::decoderAllocate(size);
+    REQUIRE(PixelBuffer::pooledSize() == size);
+    PixelBuffer::release(block);
+    REQUIRE(PixelBuffer::pooledSize() == size);
+
+    PixelBuffer::setCapacity(0);
+}
+
+TEST_CASE("Released textures are reused for textures of the same size", "[Texture]") {
+    RenderState rs;
+    TexturePool pool(2);
+
+    pool.release(rs, 1, 256, 256);
+    pool.release(rs, 2, 512, 512);
+    REQUIRE(pool.size() == 2);
+
+    // Full pool
+    pool.release(rs, 3, 256, 256);
+    REQUIRE(pool.size() == 2);
+
+    REQUIRE(pool.take(rs, 128, 128) == 0);
+    REQUIRE(pool.take(rs, 256, 256) == 1);
+    REQUIRE(pool.take(rs, 256, 256) == 0);
+
+    // Textures belong to one GL context
+    RenderState other;
+    REQUIRE(pool.take(other, 512, 512) == 0);
+    REQUIRE(pool.take(rs, 512, 512) == 2);
+    REQUIRE(pool.size() == 0);
+}
+
+TEST_CASE("Released textures are dropped on context loss", "[Texture]") {
+    RenderState rs;
+    RenderState other;
+    TexturePool pool;
+
+    pool.release(rs, 1, 256, 256);
+    pool.release(other, 2, 256, 256);
+    REQUIRE(pool.size() == 2);
+
+    rs.invalidate();
+    REQUIRE(pool.size() == 1);
+    REQUIRE(pool.take(rs, 256, 256) == 0);
+    REQUIRE(pool.take(other, 256, 256) == 2);
+}
@@ -0,0 +1,200 @@
+#include "catch.hpp"
+
+#include "urlClient.h"
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace Tangram;
+
+#define TAGS "[UrlClient]"
+
+// Minimal HTTP server on localhost, answering one request per connection
+class TestServer {
+public:
+    TestServer() {
+        m_socket = socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(m_socket, (sockaddr*)&addr, sizeof(addr));
+        listen(m_socket, 16);
+
+        socklen_t len = sizeof(addr);
+        getsockname(m_socket, (sockaddr*)&addr, &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_thread = std::thread([this]() { run(); });
+    }
+
+    ~TestServer() {
+        m_running = false;
+        shutdown(m_socket, SHUT_RDWR);
+        close(m_socket);
+        m_thread.join();
+    }
+
+    std::string url(const std::string& _path) const {
+        return "http://127.0.0.1:" + std::to_string(m_port) + _path;
+    }
+
+    int requests(const std::string& _path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_requests[_path];
+    }
+
+    int notModified() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_notModified;
+    }
+
+private:
+    void run() {
+        while (m_running) {
+            int client = accept(m_socket, nullptr, nullptr);
+            if (client < 0) { continue; }
+
+            std::string request;
+            char buffer[1024];
+            while (request.find("\r\n\r\n") == std::string::npos) {
+                auto n = read(client, buffer, sizeof(buffer));
+                if (n <= 0) { break; }
+                request.append(buffer, n);
+            }
+            auto response = respond(request);
+            write(client, response.data(), response.size());
+            close(client);
+        }
+    }
+
+    std::string respond(const std::string& _request) {
+        auto start = _request.find(' ') + 1;
+        auto path = _request.substr(start, _request.find(' ', start) - start);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests[path]++;
+
+        std::string headers, body = "content of " + path;
+        if (path == "/fresh") {
+            headers = "Cache-Control: max-age=600\r\n";
+        } else if (path == "/etag") {
+            headers = "Cache-Control: no-cache\r\nETag: \"v1\"\r\n";
+            if (_request.find("If-None-Match: \"v1\"") != std::string::npos) {
+                m_notModified++;
+                return "HTTP/1.1 304 Not Modified\r\n" + headers + "Content-Length: 0\r\n\r\n";
+            }
+        } else if (path == "/nostore") {
+            headers = "Cache-Control: no-store\r\n";
+        }
+        return "HTTP/1.1 200 OK\r\n" + headers +
+            "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+    int m_socket = -1;
+    int m_port = 0;
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::map<std::string, int> m_requests;
+    int m_notModified = 0;
+};
+
+static std::string fetch(UrlClient& _client, const std::string& _url) {
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done = false;
+    std::string result;
+
+    _client.addRequest(_url, [&](UrlResponse&& _response) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!_response.error) { result.assign(_response.content.begin(), _response.content.end()); }
+        done = true;
+        condition.notify_one();
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]{ return done; });
+    return result;
+}
+
+static void clearDirectory(const std::string& _path) {
+    if (DIR* dir = opendir(_path.c_str())) {
+        while (struct dirent* file = readdir(dir)) {
+            std::remove((_path + "/" + file->d_name).c_str());
+        }
+        closedir(dir);
+    }
+    rmdir(_path.c_str());
+}
+
+TEST_CASE("Cache HTTP responses on disk", TAGS) {
+    const char* cachePath = "urlClientCache";
+    clearDirectory(cachePath);
+
+    TestServer server;
+
+    UrlClient::Options options;
+    options.cachePath = cachePath;
+
+    {
+        UrlClient client(options);
+
+        CHECK(fetch(client, server.url("/fresh")) == "content of /fresh");
+        CHECK(fetch(client, server.url("/fresh")) == "content of /fresh");
+        CHECK(server.requests("/fresh") == 1);
+
+        // Revalidated responses reuse the cached content
+        CHECK(fetch(client, server.url("/etag")) == "content of /etag");
+        CHECK(fetch(client, server.url("/etag")) == "content of /etag");
+        CHECK(server.requests("/etag") == 2);
+        CHECK(server.notModified() == 1);
+
+        CHECK(fetch(client, server.url("/nostore")) == "content of /nostore");
+        CHECK(fetch(client, server.url("/nostore")) == "content of /nostore");
+        CHECK(server.requests("/nostore") == 2);
+    }
+
+    {
+        // Cached responses are kept across runs, once the index of the
+        // cache was read in the background
+        UrlClient client(options);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        CHECK(fetch(client, server.url("/fresh")) == "content of /fresh");
+        CHECK(server.requests("/fresh") == 1);
+    }
+
+    {
+        // Every request is answered when the client is destroyed, also
+        // the cached ones that were not read yet
+        std::atomic<int> answered{0};
+        {
+            UrlClient client(options);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            for (int i = 0; i < 20; i++) {
+                client.addRequest(server.url(i % 2 ? "/fresh" : "/other"),
+                                  [&](UrlResponse&&) { answered++; });
+            }
+        }
+        CHECK(answered == 20);
+    }
+
+    clearDirectory(cachePath);
+}
@@ -0,0 +1,136 @@
+#include "catch.hpp"
+
+#include "platform.h"
+
+#include <map>
+
+using namespace Tangram;
+
+#define TAGS "[UrlRequest]"
+
+// Platform that keeps requests open until they are completed by the test
+class DeferredPlatform : public Platform {
+public:
+    void requestRender() const override {}
+
+    bool startUrlRequestImpl(const Url& _url, const UrlRequestHandle _request, UrlRequestId& _id) override {
+        _id = ++m_transferCount;
+        m_transfers[_id] = _request;
+        m_priorities[_id] = urlRequestPriority(_request);
+        return true;
+    }
+
+    void cancelUrlRequestImpl(const UrlRequestId _id) override {
+        m_canceled++;
+        complete(_id, "", "canceled");
+    }
+
+    void setUrlRequestPriorityImpl(const UrlRequestId _id, double _priority) override {
+        m_priorities[_id] = _priority;
+    }
+
+    void complete(UrlRequestId _id, std::string _content, const char* _error = nullptr) {
+        auto it = m_transfers.find(_id);
+        if (it == m_transfers.end()) { return; }
+        auto request = it->second;
+        m_transfers.erase(it);
+
+        UrlResponse response;
+        response.content.assign(_content.begin(), _content.end());
+        response.error = _error;
+        onUrlResponse(request, std::move(response));
+    }
+
+    size_t m_transferCount = 0;
+    size_t m_canceled = 0;
+    std::map<UrlRequestId, UrlRequestHandle> m_transfers;
+    std::map<UrlRequestId, double> m_priorities;
+};
+
+struct Result {
+    bool done = false;
+    std::string content;
+    bool error = false;
+
+    UrlCallback callback() {
+        return [this](UrlResponse&& _response) {
+            done = true;
+            content.assign(_response.content.begin(), _response.content.end());
+            error = _response.error != nullptr;
+        };
+    }
+};
+
+TEST_CASE("Requests for the same URL share one transfer", TAGS) {
+    DeferredPlatform platform;
+    Result a, b, c;
+
+    platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), a.callback());
+    platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), b.callback());
+    platform.startUrlRequest(Url("https://tiles.test/1/0/0.mvt"), c.callback());
+
+    REQUIRE(platform.m_transferCount == 2);
+
+    platform.complete(1, "tile");
+
+    CHECK(a.done);
+    CHECK(a.content == "tile");
+    CHECK(b.done);
+    CHECK(b.content == "tile");
+    CHECK_FALSE(c.done);
+
+    // Completed transfers are not shared
+    Result d;
+    platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), d.callback());
+    CHECK(platform.m_transferCount == 3);
+}
+
+TEST_CASE("Shared transfers are aborted when all requests are canceled", TAGS) {
+    DeferredPlatform platform;
+    Result a, b;
+
+    auto handleA = platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), a.callback());
+    auto handleB = platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), b.callback());
+
+    platform.cancelUrlRequest(handleA);
+    CHECK(platform.m_canceled == 0);
+    CHECK_FALSE(a.done);
+
+    SECTION("Remaining request gets the response") {
+        platform.complete(1, "tile");
+
+        CHECK(a.done);
+        CHECK(a.error);
+        CHECK(b.done);
+        CHECK_FALSE(b.error);
+        CHECK(b.content == "tile");
+    }
+
+    SECTION("Last cancel aborts the transfer") {
+        platform.cancelUrlRequest(handleB);
+
+        CHECK(platform.m_canceled == 1);
+        CHECK(a.done);
+        CHECK(a.error);
+        CHECK(b.done);
+        CHECK(b.error);
+    }
+}
+
+TEST_CASE("Shared transfers take the most urgent priority", TAGS) {
+    DeferredPlatform platform;
+    Result a, b;
+
+    auto handleA = platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), a.callback(), 1.5);
+    CHECK(platform.m_priorities[1] == 1.5);
+
+    auto handleB = platform.startUrlRequest(Url("https://tiles.test/0/0/0.mvt"), b.callback(), 0.5);
+    CHECK(platform.m_priorities[1] == 0.5);
+
+    platform.setUrlRequestPriority(handleA, 0.2);
+    CHECK(platform.m_priorities[1] == 0.2);
+
+    platform.cancelUrlRequest(handleA);
+    platform.setUrlRequestPriority(handleB, 0.7);
+    CHECK(platform.m_priorities[1] == 0.7);
+}
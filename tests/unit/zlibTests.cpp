@@ -0,0 +1,180 @@
+#include "catch.hpp"
+
+#include "util/zlibHelper.h"
+
+#include <zlib.h>
+
+#include <string>
+
+using namespace Tangram;
+
+#define TAGS "[zlib]"
+
+enum GzipFlags { FHCRC = 2, FEXTRA = 4, FNAME = 8, FCOMMENT = 16 };
+
+static void appendUint32(std::string& _out, uLong _value) {
+    for (int i = 0; i < 4; i++) { _out.push_back(char((_value >> (8 * i)) & 0xff)); }
+}
+
+// Gzip member of _data with the optional header fields of _flags
+static std::string gzip(const std::string& _data, int _flags = 0) {
+    std::string out = { '\x1f', '\x8b', 8, char(_flags), 0, 0, 0, 0, 0, 3 };
+
+    if (_flags & FEXTRA) {
+        std::string extra = "ab\x04\x00" "data";
+        out.push_back(char(extra.size()));
+        out.push_back(0);
+        out += extra;
+    }
+    if (_flags & FNAME) { out += std::string("tile.mvt") + '\0'; }
+    if (_flags & FCOMMENT) { out += std::string("comment") + '\0'; }
+    if (_flags & FHCRC) {
+        uLong crc = crc32(0, reinterpret_cast<const Bytef*>(out.data()), uInt(out.size()));
+        out.push_back(char(crc & 0xff));
+        out.push_back(char((crc >> 8) & 0xff));
+    }
+
+    // Raw deflate stream
+    z_stream strm = {};
+    REQUIRE(deflateInit2(&strm, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    std::string deflated(deflateBound(&strm, uLong(_data.size())), '\0');
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(_data.data()));
+    strm.avail_in = uInt(_data.size());
+    strm.next_out = reinterpret_cast<Bytef*>(&deflated[0]);
+    strm.avail_out = uInt(deflated.size());
+    REQUIRE(deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    deflated.resize(strm.total_out);
+    deflateEnd(&strm);
+
+    out += deflated;
+    appendUint32(out, crc32(0, reinterpret_cast<const Bytef*>(_data.data()), uInt(_data.size())));
+    appendUint32(out, uLong(_data.size()));
+    return out;
+}
+
+static std::string testData(size_t _size, bool _compressible) {
+    std::string data(_size, '\0');
+    uint32_t seed = 1;
+    for (size_t i = 0; i < _size; i++) {
+        seed = seed * 1103515245 + 12345;
+        // Compressible data is text with a few random bytes
+        data[i] = (_compressible && (seed >> 28) != 0) ? "tile data "[i % 10] : char(seed >> 24);
+    }
+    return data;
+}
+
+static const zlib::Backend backends[] = { zlib::Backend::zlib, zlib::Backend::miniz };
+
+// Inflates _gzip with _backend and appends it to a non-empty buffer. Returns the
+// result and the appended data.
+static std::pair<int, std::string> inflateWith(zlib::Backend _backend, const std::string& _gzip) {
+    std::vector<char> dst = { 'x' };
+    int ret = zlib::inflate(_backend, _gzip.data(), _gzip.size(), dst);
+
+    REQUIRE(!dst.empty());
+    REQUIRE(dst[0] == 'x');
+    return { ret, std::string(dst.begin() + 1, dst.end()) };
+}
+
+TEST_CASE("Inflate gzip data with miniz by default", TAGS) {
+    CHECK(zlib::backend() == zlib::Backend::miniz);
+
+    std::string data = testData(1000, true);
+    std::string compressed = gzip(data);
+
+    std::vector<char> dst;
+    REQUIRE(zlib::inflate(compressed.data(), compressed.size(), dst) == 0);
+    CHECK(std::string(dst.begin(), dst.end()) == data);
+}
+
+TEST_CASE("Inflate gzip data with optional header fields", TAGS) {
+    std::string data = testData(5000, true);
+
+    for (int flags : { 0, int(FEXTRA), int(FNAME), int(FCOMMENT), int(FHCRC),
+                       FEXTRA | FNAME | FCOMMENT | FHCRC }) {
+        for (auto backend : backends) {
+            INFO("flags " << flags << " backend " << int(backend));
+            auto result = inflateWith(backend, gzip(data, flags));
+            CHECK(result.first == 0);
+            CHECK(result.second == data);
+        }
+    }
+}
+
+TEST_CASE("Inflate the same data with both gzip backends", TAGS) {
+    for (size_t size : { 0, 1, 100, 16384, 16385, 300000 }) {
+        for (bool compressible : { true, false }) {
+            std::string data = testData(size, compressible);
+            std::string compressed = gzip(data, FNAME);
+
+            INFO("size " << size << " compressible " << compressible);
+            auto zlibResult = inflateWith(zlib::Backend::zlib, compressed);
+            auto minizResult = inflateWith(zlib::Backend::miniz, compressed);
+
+            CHECK(zlibResult.first == 0);
+            CHECK(zlibResult.second == data);
+            CHECK(minizResult == zlibResult);
+        }
+    }
+}
+
+TEST_CASE("Reject truncated gzip data", TAGS) {
+    std::string compressed = gzip(testData(100000, false));
+
+    // Within the deflate stream, the trailer and the header
+    for (size_t size : { compressed.size() / 2, compressed.size() - 6, size_t(12) }) {
+        for (auto backend : backends) {
+            INFO("size " << size << " backend " << int(backend));
+            auto result = inflateWith(backend, compressed.substr(0, size));
+            CHECK(result.first != 0);
+            CHECK(result.second.empty());
+        }
+    }
+}
+
+TEST_CASE("Reject gzip data with wrong trailer", TAGS) {
+    std::string data = testData(20000, true);
+
+    SECTION("CRC") {
+        std::string compressed = gzip(data);
+        compressed[compressed.size() - 8] ^= 1;
+
+        for (auto backend : backends) {
+            auto result = inflateWith(backend, compressed);
+            CHECK(result.first != 0);
+            CHECK(result.second.empty());
+        }
+    }
+
+    SECTION("Size") {
+        // The miniz backend falls back to zlib when the output is larger than the size
+        for (int delta : { -1, 1 }) {
+            std::string compressed = gzip(data);
+            compressed[compressed.size() - 4] += char(delta);
+
+            for (auto backend : backends) {
+                INFO("delta " << delta << " backend " << int(backend));
+                auto result = inflateWith(backend, compressed);
+                CHECK(result.first != 0);
+                CHECK(result.second.empty());
+            }
+        }
+    }
+}
+
+TEST_CASE("Inflate gzip data without usable size with zlib", TAGS) {
+    // Empty output gives no size hint
+    auto result = inflateWith(zlib::Backend::miniz, gzip(""));
+    CHECK(result.first == 0);
+    CHECK(result.second.empty());
+
+    // Neither does a size beyond the possible compression ratio
+    std::string compressed = gzip(testData(1000, true));
+    compressed[compressed.size() - 1] = char(0x7f);
+
+    for (auto backend : backends) {
+        result = inflateWith(backend, compressed);
+        CHECK(result.first != 0);
+        CHECK(result.second.empty());
+    }
+}